@@ -50,9 +50,20 @@ void cleanUp()
 		if (tissuestack::services::TissueStackTaskQueue::doesInstanceExist())
 			tissuestack::services::TissueStackTaskQueue::instance()->purgeInstance();
 
+		if (tissuestack::services::TissueStackProgressNotifier::doesInstanceExist())
+			tissuestack::services::TissueStackProgressNotifier::instance()->purgeInstance();
+
 		if (tissuestack::imaging::TissueStackSliceCache::doesInstanceExist())
 			tissuestack::imaging::TissueStackSliceCache::instance()->purgeInstance();
 
+		if (tissuestack::imaging::TissueStackLookupTableCache::doesInstanceExist())
+			tissuestack::imaging::TissueStackLookupTableCache::instance()->purgeInstance();
+
+		if (tissuestack::imaging::TissueStackTileCache::doesInstanceExist())
+			tissuestack::imaging::TissueStackTileCache::instance()->purgeInstance();
+		if (tissuestack::imaging::TissueStackPreTiledTileStore::doesInstanceExist())
+			tissuestack::imaging::TissueStackPreTiledTileStore::instance()->purgeInstance();
+
 		if (tissuestack::database::TissueStackPostgresConnector::doesInstanceExist())
 			tissuestack::database::TissueStackPostgresConnector::instance()->purgeInstance();
 
@@ -181,8 +192,7 @@ int main(int argc, char * args[])
 	{
 		// start database connection
 		if (!tissuestack::database::TissueStackPostgresConnector::instance()->isTransConnected()
-				|| !tissuestack::database::TissueStackPostgresConnector::instance()->isNonTransConnected(0)
-				|| !tissuestack::database::TissueStackPostgresConnector::instance()->isNonTransBackupConnected())
+				|| !tissuestack::database::TissueStackPostgresConnector::instance()->isPoolConnected())
 		{
 			std::cerr << "Failed to initialize database connector!" << std::endl;
 			if (tissuestack::database::TissueStackPostgresConnector::doesInstanceExist())
@@ -255,10 +265,46 @@ int main(int argc, char * args[])
 		exit(-1);
 	}
 
+	try
+	{
+		// created up front: request threads must not race each other constructing it
+		tissuestack::imaging::TissueStackLookupTableCache::instance(); // fused contrast/color map lookup tables
+	} catch (std::exception & bad)
+	{
+		std::cerr << "Could not instantiate TissueStackLookupTableCache!" << std::endl;
+		Logger->error("Could not instantiate TissueStackLookupTableCache:\n%s\n", bad.what());
+		cleanUp();
+		exit(-1);
+	}
+
+	try
+	{
+		tissuestack::imaging::TissueStackTileCache::instance(); // rendered tile responses
+	} catch (std::exception & bad)
+	{
+		std::cerr << "Could not instantiate TissueStackTileCache!" << std::endl;
+		Logger->error("Could not instantiate TissueStackTileCache:\n%s\n", bad.what());
+		cleanUp();
+		exit(-1);
+	}
+
+	try
+	{
+		// looks up the tile directory in the database
+		tissuestack::imaging::TissueStackPreTiledTileStore::instance(); // pre-rendered tiles on disk
+	} catch (std::exception & bad)
+	{
+		std::cerr << "Could not instantiate TissueStackPreTiledTileStore!" << std::endl;
+		Logger->error("Could not instantiate TissueStackPreTiledTileStore:\n%s\n", bad.what());
+		cleanUp();
+		exit(-1);
+	}
+
 	try
 	{
 		tissuestack::services::TissueStackTaskQueue::instance();
 		//tissuestack::services::TissueStackTaskQueue::instance()->dumpAllTasksToDebugLog();
+		tissuestack::services::TissueStackProgressNotifier::instance(); // for streaming task and upload progress
 	} catch (std::exception & bad)
 	{
 		std::cerr << "Could not instantiate TissueStackTaskQueue!" << std::endl;
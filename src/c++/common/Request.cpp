@@ -28,6 +28,16 @@ const tissuestack::common::Request::Type tissuestack::common::Request::getType()
 	return this->_type;
 }
 
+const bool tissuestack::common::Request::isKeepAlive() const
+{
+	return this->_keep_alive;
+}
+
+void tissuestack::common::Request::setKeepAlive(const bool keep_alive)
+{
+	this->_keep_alive = keep_alive;
+}
+
 void tissuestack::common::Request::setType(tissuestack::common::Request::Type type)
 {
 	this->_type = type;
@@ -107,6 +107,49 @@ tissuestack::TissueStackConfigurationParameters::TissueStackConfigurationParamet
 	this->_parameters["db_name"] = new tissuestack::database::Configuration("db_name", "tissuestack");
 	this->_parameters["db_user"] = new tissuestack::database::Configuration("db_user", "tissuestack");
 	this->_parameters["db_password"] = new tissuestack::database::Configuration("db_password", "tissuestack");
+	// database connection pool: number of connections, milliseconds to wait for one
+	// and seconds after which an idle connection is checked before it is handed out again
+	this->_parameters["db_pool_size"] = new tissuestack::database::Configuration("db_pool_size", "5");
+	this->_parameters["db_pool_wait_timeout"] = new tissuestack::database::Configuration("db_pool_wait_timeout", "5000");
+	this->_parameters["db_health_check_interval"] = new tissuestack::database::Configuration("db_health_check_interval", "30");
+	// madvise policy for the memory mapped plane stacks of RAW files: normal, random, sequential or willneed
+	this->_parameters["mmap_advice_x"] = new tissuestack::database::Configuration("mmap_advice_x", "normal");
+	this->_parameters["mmap_advice_y"] = new tissuestack::database::Configuration("mmap_advice_y", "normal");
+	this->_parameters["mmap_advice_z"] = new tissuestack::database::Configuration("mmap_advice_z", "normal");
+	// byte budget of the slice cache in megabytes
+	this->_parameters["slice_cache_size"] = new tissuestack::database::Configuration("slice_cache_size", "1024");
+	// persistent http connections: idle timeout in seconds and maximum number of requests per connection
+	this->_parameters["keep_alive_timeout"] = new tissuestack::database::Configuration("keep_alive_timeout", "15");
+	this->_parameters["keep_alive_max_requests"] = new tissuestack::database::Configuration("keep_alive_max_requests", "100");
+	// number of fused contrast/color map lookup tables kept around
+	this->_parameters["lookup_table_cache_size"] = new tissuestack::database::Configuration("lookup_table_cache_size", "256");
+	// byte budget of the rendered tile cache in megabytes (0 disables it)
+	this->_parameters["tile_cache_size"] = new tissuestack::database::Configuration("tile_cache_size", "256");
+	// number of threads pre-tiling a data set (0 means one per core)
+	this->_parameters["pre_tiling_threads"] = new tissuestack::database::Configuration("pre_tiling_threads", "0");
+	// pre-tiling output: one image file per tile ("files"), which is what the viewer fetches statically,
+	// or packed tile archives ("archive") which only the image service can serve from
+	this->_parameters["pre_tiling_storage"] = new tissuestack::database::Configuration("pre_tiling_storage", "files");
+	// number of threads converting a data set to raw (0 means one per core)
+	this->_parameters["conversion_threads"] = new tissuestack::database::Configuration("conversion_threads", "0");
+	// memory in MB for transposing a 3D volume into raw in a single pass (0 converts slice by slice)
+	this->_parameters["conversion_memory_budget"] = new tissuestack::database::Configuration("conversion_memory_budget", "512");
+	// number of tasks the task queue runs side by side and how many of them may be conversions/tilings
+	this->_parameters["task_queue_slots"] = new tissuestack::database::Configuration("task_queue_slots", "2");
+	this->_parameters["task_queue_max_conversions"] = new tissuestack::database::Configuration("task_queue_max_conversions", "1");
+	this->_parameters["task_queue_max_tilings"] = new tissuestack::database::Configuration("task_queue_max_tilings", "1");
+	// queued tasks of higher priority run first, ties go to the task with the least work left
+	this->_parameters["conversion_task_priority"] = new tissuestack::database::Configuration("conversion_task_priority", "1");
+	this->_parameters["tiling_task_priority"] = new tissuestack::database::Configuration("tiling_task_priority", "0");
+	// task progress is appended to a journal every so many slices or milliseconds, whichever comes first
+	this->_parameters["task_progress_flush_slices"] = new tissuestack::database::Configuration("task_progress_flush_slices", "16");
+	this->_parameters["task_progress_flush_interval"] = new tissuestack::database::Configuration("task_progress_flush_interval", "1000");
+	// number of done, cancelled or erroneous tasks kept around for task listings
+	this->_parameters["task_history_size"] = new tissuestack::database::Configuration("task_history_size", "1000");
+	// number of clients that may have progress streamed to them at once (each one holds on to a request thread)
+	this->_parameters["progress_streams_max"] = new tissuestack::database::Configuration("progress_streams_max", "2");
+	// seconds after which a progress stream ends and the client has to reconnect
+	this->_parameters["progress_stream_timeout"] = new tissuestack::database::Configuration("progress_stream_timeout", "600");
 }
 
 
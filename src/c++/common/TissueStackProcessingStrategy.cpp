@@ -32,7 +32,7 @@ tissuestack::common::TissueStackProcessingStrategy::TissueStackProcessingStrateg
 	else if (cores > 10)
 		numberOfThreads = 20;
 
-	this->_default_strategy = new tissuestack::execution::ThreadPool(numberOfThreads);
+	this->_default_strategy = new tissuestack::execution::WorkStealingThreadPool(numberOfThreads);
 };
 
 tissuestack::common::TissueStackProcessingStrategy::~TissueStackProcessingStrategy()
@@ -98,11 +98,15 @@ namespace tissuestack
 				virtual const bool isObsolete() const = 0;
 				virtual ~Request();
 				const Request::Type getType() const;
+				// whether the connection stays open after the response, responses have to say so
+				const bool isKeepAlive() const;
+				void setKeepAlive(const bool keep_alive);
 			protected:
 				Request();
 				void setType(Request::Type type);
 			private:
 				Request::Type _type;
+				bool _keep_alive = true;
 		};
 
 		class ProcessingStrategy
@@ -24,14 +24,11 @@ const tissuestack::database::Configuration * tissuestack::database::Configuratio
 		return nullptr;
 
 
-	const std::string sql =
-			"SELECT * FROM configuration WHERE name='"
-			+ name + "';";
-
 	tissuestack::database::Configuration * ret = nullptr;
 
 	const pqxx::result results =
-			tissuestack::database::TissueStackPostgresConnector::instance()->executeNonTransactionalQuery(sql);
+			tissuestack::database::TissueStackPostgresConnector::instance()->executePreparedQuery(
+				"configuration_by_name", {name});
 
 	if (results.size() == 0) return ret;
 	if (results.size() > 1)
@@ -46,11 +46,10 @@ const bool tissuestack::database::SessionDataProvider::hasSessionExpired(
 
 	try
 	{
-		std::string sql =
-			std::string("SELECT * FROM session WHERE id='")
-				+ session + "';";
+		// asked on every request that needs a session
 		const pqxx::result result =
-			tissuestack::database::TissueStackPostgresConnector::instance()->executeNonTransactionalQuery({sql});
+			tissuestack::database::TissueStackPostgresConnector::instance()->executePreparedQuery(
+				"session_by_id", {session});
 		if (result.size() != 1) return true;
 
 		const unsigned long long int present_expiry = result[0]["expiry"].as<unsigned long long int>();
@@ -64,12 +63,9 @@ const bool tissuestack::database::SessionDataProvider::hasSessionExpired(
 
 		try
 		{
-			sql =
-					std::string("UPDATE session SET expiry=")
-					+ std::to_string(now+extension)
-					+ " WHERE id='"
-					+ session + "';";
-			tissuestack::database::TissueStackPostgresConnector::instance()->executeTransaction({sql});
+			// a single statement: no need to queue up for the transaction connection
+			tissuestack::database::TissueStackPostgresConnector::instance()->executePreparedQuery(
+				"session_extend", {session, std::to_string(now+extension)});
 
 			return false;
 		} catch(const std::exception & bad)
@@ -91,10 +87,10 @@ const bool tissuestack::database::SessionDataProvider::invalidateSession(
 
 	try
 	{
-		const std::string sql =
-				std::string("DELETE FROM session WHERE id='")
-				+ session + "';";
-		if (tissuestack::database::TissueStackPostgresConnector::instance()->executeTransaction({sql}) == 1)
+		const pqxx::result result =
+			tissuestack::database::TissueStackPostgresConnector::instance()->executePreparedQuery(
+				"session_delete", {session});
+		if (result.affected_rows() == 1)
 			return true;
 	} catch(const std::exception & bad)
 	{
@@ -17,10 +17,19 @@
 #include "database.h"
 #include "parameters.h"
 
+const std::map<std::string, std::string> tissuestack::database::TissueStackPostgresConnector::PREPARED_STATEMENTS =
+{
+	{ "session_by_id", "SELECT * FROM session WHERE id=$1" },
+	{ "session_extend", "UPDATE session SET expiry=$2 WHERE id=$1" },
+	{ "session_delete", "DELETE FROM session WHERE id=$1" },
+	{ "configuration_by_name", "SELECT * FROM configuration WHERE name=$1" }
+};
+
 tissuestack::database::TissueStackPostgresConnector::~TissueStackPostgresConnector()
 {
 	this->disconnectTransConnection();
-	this->disconnectNonTransConnections();
+	for (tissuestack::database::TissueStackPostgresConnector::PooledConnection & pooled : this->_pooled_connections)
+		this->disconnectPooledConnection(pooled);
 }
 
 tissuestack::database::TissueStackPostgresConnector::TissueStackPostgresConnector(
@@ -28,7 +37,9 @@ tissuestack::database::TissueStackPostgresConnector::TissueStackPostgresConnecto
 		const short port,
 		const std::string database,
 		const std::string user,
-		const std::string password)
+		const std::string password) :
+			_connections_in_use(0), _maximum_connections_in_use(0), _check_outs(0), _waits(0),
+			_time_outs(0), _reconnects(0), _total_wait_time(0), _maximum_wait_time(0)
 {
 	if (host.empty() || password.empty() || database.empty() || user.empty() || port <=0)
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
@@ -41,8 +52,27 @@ tissuestack::database::TissueStackPostgresConnector::TissueStackPostgresConnecto
 	connectString << " sslmode=allow";
 	this->_connectString = connectString.str();
 
+	const unsigned long int poolSize =
+		strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("db_pool_size").c_str(), NULL, 10);
+	this->_pool_wait_timeout = static_cast<unsigned int>(
+		strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("db_pool_wait_timeout").c_str(), NULL, 10));
+	this->_health_check_interval = static_cast<unsigned int>(
+		strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("db_health_check_interval").c_str(), NULL, 10));
+
 	this->reconnectTransConnection();
-	this->reconnectNonTransConnections();
+
+	const unsigned short numberOfConnections =
+		static_cast<unsigned short>(std::max<unsigned long int>(1, std::min<unsigned long int>(poolSize, 100)));
+	this->_pooled_connections.resize(numberOfConnections);
+	for (unsigned short index = 0; index < numberOfConnections; index++)
+	{
+		this->_pooled_connections[index].connection = nullptr;
+		this->reconnectPooledConnection(this->_pooled_connections[index]);
+		this->_pooled_connections[index].is_healthy = (this->_pooled_connections[index].connection != nullptr);
+		this->_pooled_connections[index].checked_at = std::chrono::steady_clock::now();
+		// the first connection is to be handed out first
+		this->_idle_connections.push_back(numberOfConnections - index - 1);
+	}
 }
 
 void tissuestack::database::TissueStackPostgresConnector::purgeInstance()
@@ -75,73 +105,34 @@ const pqxx::result tissuestack::database::TissueStackPostgresConnector::executeN
 {
 	//tissuestack::logging::TissueStackLogger::instance()->debug("Executing non transSQL: %s", sql.c_str());
 
-	const unsigned short indexForIdleConnection =
-		this->findNextIdleNonTransConnection();
-
-	if (indexForIdleConnection < tissuestack::database::TissueStackPostgresConnector::MAX_NON_TRANSACTIONAL_CONNECTIONS)
-	{
-		try
+	return this->executeOnPooledConnection(
+		[&sql] (pqxx::connection & connection) -> const pqxx::result
 		{
-			if (this->_non_trans_connections[indexForIdleConnection] == nullptr)
-			{
-				THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-							"Reconnecting database ...");
-			}
-
-			pqxx::nontransaction non_transaction(*this->_non_trans_connections[indexForIdleConnection]);
-
-			const pqxx::result ret = non_transaction.exec(sql);
+			pqxx::nontransaction non_transaction(connection);
 
-			this->_busyNonTransactionalConnections[indexForIdleConnection] = false;
-
-			return ret;
-		} catch (std::exception & bad) { // check connectivity
-			this->_busyNonTransactionalConnections[indexForIdleConnection] = false;
-			tissuestack::logging::TissueStackLogger::instance()->error("Failed to execute query: %s\n", bad.what());
-			try
-			{
-				if (this->_non_trans_connections[indexForIdleConnection])
-				{
-					this->_non_trans_connections[indexForIdleConnection]->activate();
-					THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-						"Reconnecting database ...");
-				}
-			} catch (...) {}
-			throw tissuestack::common::TissueStackApplicationException(
-				"ERROR: Failure to execute database query: " + std::string(bad.what()));
-		}
-	}
+			return non_transaction.exec(sql);
+		});
+}
 
-	// we have reached the maximum of our connection pool =>
-	// we switch our strategy to a mutexted backup connection
-	{
-		std::lock_guard<std::mutex> lock(this->_non_transactionMutex);
+const pqxx::result tissuestack::database::TissueStackPostgresConnector::executePreparedQuery(
+	const std::string & statement,
+	const std::vector<std::string> & parameters)
+{
+	if (tissuestack::database::TissueStackPostgresConnector::PREPARED_STATEMENTS.count(statement) == 0)
+		throw tissuestack::common::TissueStackApplicationException(
+			"ERROR: Unknown prepared statement: " + statement);
 
-		try
+	return this->executeOnPooledConnection(
+		[&statement, &parameters] (pqxx::connection & connection) -> const pqxx::result
 		{
-			if (this->_non_trans_backup_connection == nullptr)
-				THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-					"Reconnecting database ...");
+			pqxx::nontransaction non_transaction(connection);
 
-			pqxx::nontransaction non_transaction(*this->_non_trans_backup_connection);
-
-			return non_transaction.exec(sql);
-		} catch (std::exception & bad) { // check connectivity
-			tissuestack::logging::TissueStackLogger::instance()->error("Failed to execute query: %s\n", bad.what());
-			try
-			{
-				if (this->_non_trans_backup_connection)
-				{
-					this->_non_trans_backup_connection->activate();
-					THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-							"Reconnecting database ...");
-				}
-			} catch (...) {}
-			throw tissuestack::common::TissueStackApplicationException(
-				"ERROR: Failure to execute database query: " + std::string(bad.what()));
-		}
-	}
+			pqxx::prepare::invocation invocation = non_transaction.prepared(statement);
+			for (const std::string & parameter : parameters)
+				invocation(parameter);
 
+			return invocation.exec();
+		});
 }
 
 const unsigned long long int tissuestack::database::TissueStackPostgresConnector::executeTransaction(const std::vector<std::string> sql)
@@ -193,78 +184,151 @@ const pqxx::result tissuestack::database::TissueStackPostgresConnector::executeP
 		const unsigned int from,
 		const unsigned int to)
 {
-	const unsigned short indexForIdleConnection =
-		this->findNextIdleNonTransConnection();
-
-	if (indexForIdleConnection < tissuestack::database::TissueStackPostgresConnector::MAX_NON_TRANSACTIONAL_CONNECTIONS)
-	{
-		try
+	return this->executeOnPooledConnection(
+		[&sql, from, to] (pqxx::connection & connection) -> const pqxx::result
 		{
-			if (this->_non_trans_connections[indexForIdleConnection] == nullptr)
-				THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-					"Reconnecting database ...");
-
-			pqxx::nontransaction work(*this->_non_trans_connections[indexForIdleConnection]);
+			pqxx::nontransaction work(connection);
 			pqxx::stateless_cursor<pqxx::cursor_base::read_only, pqxx::cursor_base::owned> cursor(
 					work, sql, "query_cursor", false );
 
 			const pqxx::result res = cursor.retrieve( from, to );
 			cursor.close();
 
-			this->_busyNonTransactionalConnections[indexForIdleConnection] = false;
-
 			return res;
-		} catch (std::exception & bad) { // check connectivity
-			this->_busyNonTransactionalConnections[indexForIdleConnection] = false;
-			tissuestack::logging::TissueStackLogger::instance()->error("Failed to execute query: %s\n", bad.what());
-			try
-			{
-				if (this->_non_trans_connections[indexForIdleConnection])
-				{
-					this->_non_trans_connections[indexForIdleConnection]->activate();
-					THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-						"Reconnecting database ...");
-				}
-			} catch (...) {}
-			throw tissuestack::common::TissueStackApplicationException(
-				"ERROR: Failure to execute database query: " + std::string(bad.what()));
-		}
+		});
+}
+
+inline const pqxx::result tissuestack::database::TissueStackPostgresConnector::executeOnPooledConnection(
+	const std::function<const pqxx::result (pqxx::connection & connection)> & query)
+{
+	const unsigned short index = this->checkOutConnection();
+
+	try
+	{
+		if (this->_pooled_connections[index].connection == nullptr)
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Reconnecting database ...");
+
+		const pqxx::result ret = query(*this->_pooled_connections[index].connection);
+		this->checkInConnection(index, true);
+
+		return ret;
+	} catch (std::exception & bad) { // connectivity is checked before the connection is handed out again
+		this->checkInConnection(index, false);
+		tissuestack::logging::TissueStackLogger::instance()->error("Failed to execute query: %s\n", bad.what());
+		throw tissuestack::common::TissueStackApplicationException(
+			"ERROR: Failure to execute database query: " + std::string(bad.what()));
 	}
+}
 
-	// we have reached the maximum of our connection pool =>
-	// we switch our strategy to a mutexted backup connection
+inline const unsigned short tissuestack::database::TissueStackPostgresConnector::checkOutConnection()
+{
+	const std::chrono::steady_clock::time_point askedAt = std::chrono::steady_clock::now();
+	unsigned short index = 0;
+	bool isAnotherOneIdle = false;
 	{
-		std::lock_guard<std::mutex> lock(this->_non_transactionMutex);
+		std::unique_lock<std::mutex> lock(this->_pool_mutex);
 
-		try
+		// nobody jumps the queue: an idle connection goes to whoever has been waiting the longest
+		if (!this->_waiting_queue.empty() || this->_idle_connections.empty())
 		{
-			if (this->_non_trans_backup_connection == nullptr)
+			const unsigned long long int ticket = this->_next_ticket++;
+			this->_waiting_queue.push_back(ticket);
+			this->_waits++;
+
+			if (!this->_connection_returned.wait_for(
+					lock,
+					std::chrono::milliseconds(this->_pool_wait_timeout),
+					[this, ticket] {
+						return this->_waiting_queue.front() == ticket && !this->_idle_connections.empty();
+					}))
+			{
+				this->_waiting_queue.erase(
+					std::find(this->_waiting_queue.begin(), this->_waiting_queue.end(), ticket));
+				this->_time_outs++;
+				lock.unlock();
+				// whoever was behind us might be first in line now
+				this->_connection_returned.notify_all();
 				THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-					"Reconnecting database ...");
+					"Timed out waiting for a database connection!");
+			}
+			this->_waiting_queue.pop_front();
+		}
 
-			pqxx::nontransaction work(*this->_non_trans_backup_connection);
-			pqxx::stateless_cursor<pqxx::cursor_base::read_only, pqxx::cursor_base::owned> cursor(
-					work, sql, "query_cursor", false );
+		index = this->_idle_connections.back();
+		this->_idle_connections.pop_back();
+		isAnotherOneIdle = !this->_waiting_queue.empty() && !this->_idle_connections.empty();
+	}
+	if (isAnotherOneIdle)
+		this->_connection_returned.notify_all();
 
-			const pqxx::result res = cursor.retrieve( from, to );
-			cursor.close();
+	// metrics
+	const unsigned short inUse = ++this->_connections_in_use;
+	unsigned short maximumInUse = this->_maximum_connections_in_use.load();
+	while (inUse > maximumInUse && !this->_maximum_connections_in_use.compare_exchange_weak(maximumInUse, inUse));
 
-			return res;
-		} catch (std::exception & bad) { // check connectivity
-			tissuestack::logging::TissueStackLogger::instance()->error("Failed to execute query: %s\n", bad.what());
-			try
-			{
-				if (this->_non_trans_backup_connection)
-				{
-					this->_non_trans_backup_connection->activate();
-					THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-						"Reconnecting database ...");
-				}
-			} catch (...) {}
-			throw tissuestack::common::TissueStackApplicationException(
-				"ERROR: Failure to execute database query: " + std::string(bad.what()));
+	const unsigned long long int waited =
+		std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - askedAt).count();
+	this->_check_outs++;
+	this->_total_wait_time += waited;
+	unsigned long long int maximumWait = this->_maximum_wait_time.load();
+	while (waited > maximumWait && !this->_maximum_wait_time.compare_exchange_weak(maximumWait, waited));
+
+	// the connection is ours now, no need to hold up the others while we check on it
+	this->checkPooledConnection(this->_pooled_connections[index]);
+
+	return index;
+}
+
+inline void tissuestack::database::TissueStackPostgresConnector::checkInConnection(
+	const unsigned short index, const bool is_healthy)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->_pool_mutex);
+
+		if (!is_healthy)
+			this->_pooled_connections[index].is_healthy = false;
+		this->_idle_connections.push_back(index);
+	}
+	this->_connections_in_use--;
+
+	// only the first in line may take it but we don't know who is waiting for what
+	this->_connection_returned.notify_all();
+}
+
+inline void tissuestack::database::TissueStackPostgresConnector::checkPooledConnection(
+	tissuestack::database::TissueStackPostgresConnector::PooledConnection & pooled)
+{
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	// connections that failed a query or have not been looked at in a while are probed
+	if (pooled.connection != nullptr && pooled.is_healthy &&
+			now - pooled.checked_at < std::chrono::seconds(this->_health_check_interval))
+		return;
+
+	bool isAlive = false;
+	if (pooled.connection != nullptr)
+	{
+		try
+		{
+			pqxx::nontransaction probe(*pooled.connection);
+			probe.exec("SELECT 1;");
+			isAlive = true;
+		} catch (std::exception & bad)
+		{
+			tissuestack::logging::TissueStackLogger::instance()->error("Database Connection Error: %s\n", bad.what());
 		}
 	}
+
+	if (!isAlive)
+	{
+		this->reconnectPooledConnection(pooled);
+		this->_reconnects++;
+	}
+
+	pooled.is_healthy = (pooled.connection != nullptr);
+	pooled.checked_at = now;
 }
 
 void tissuestack::database::TissueStackPostgresConnector::disconnectTransConnection()
@@ -283,55 +347,21 @@ void tissuestack::database::TissueStackPostgresConnector::disconnectTransConnect
 	}
 }
 
-void tissuestack::database::TissueStackPostgresConnector::disconnectNonTransBackupConnection()
+void tissuestack::database::TissueStackPostgresConnector::disconnectPooledConnection(
+		tissuestack::database::TissueStackPostgresConnector::PooledConnection & pooled)
 {
-	if (this->_non_trans_backup_connection)
+	if (pooled.connection)
 	{
 		try {
-			if (this->_non_trans_backup_connection->is_open())
-				this->_non_trans_backup_connection->disconnect();
+			if (pooled.connection->is_open())
+				pooled.connection->disconnect();
 		} catch(...)
 		{
 			// anything happens here is disregarded
 		}
-		delete this->_non_trans_backup_connection;
-		this->_non_trans_backup_connection = nullptr;
-	}
-}
-
-
-void tissuestack::database::TissueStackPostgresConnector::disconnectNonTransConnection(
-		const unsigned short index)
-{
-	if (index >= tissuestack::database::TissueStackPostgresConnector::MAX_NON_TRANSACTIONAL_CONNECTIONS ||
-			this->_non_trans_connections[index] == nullptr)
-		return;
-
-	this->_busyNonTransactionalConnections[index] = true;
-
-	try {
-		if (this->_non_trans_connections[index]->is_open())
-			this->_non_trans_connections[index]->disconnect();
-	}  catch(...)
-	{
-		// anything happens here is disregarded
+		delete pooled.connection;
+		pooled.connection = nullptr;
 	}
-
-	if (this->_non_trans_connections[index])
-	{
-		delete this->_non_trans_connections[index];
-		this->_non_trans_connections[index] = nullptr;
-	}
-
-	this->_busyNonTransactionalConnections[index] = false;
-}
-
-
-void tissuestack::database::TissueStackPostgresConnector::disconnectNonTransConnections()
-{
-	for (unsigned short index = 0; index < tissuestack::database::TissueStackPostgresConnector::MAX_NON_TRANSACTIONAL_CONNECTIONS; index++)
-		this->disconnectNonTransConnection(index);
-	this->disconnectNonTransBackupConnection();
 }
 
 void tissuestack::database::TissueStackPostgresConnector::reconnectTransConnection()
@@ -347,36 +377,23 @@ void tissuestack::database::TissueStackPostgresConnector::reconnectTransConnecti
 	}
 }
 
-void tissuestack::database::TissueStackPostgresConnector::reconnectNonTransConnection(const unsigned short index)
+void tissuestack::database::TissueStackPostgresConnector::reconnectPooledConnection(
+		tissuestack::database::TissueStackPostgresConnector::PooledConnection & pooled)
 {
-	if (index >= tissuestack::database::TissueStackPostgresConnector::MAX_NON_TRANSACTIONAL_CONNECTIONS)
-		return;
-
-	this->disconnectNonTransConnection(index);
-
-	this->_busyNonTransactionalConnections[index] = true;
+	this->disconnectPooledConnection(pooled);
 
 	try
 	{
-		this->_non_trans_connections[index] = new pqxx::connection(this->_connectString);
+		pooled.connection = new pqxx::connection(this->_connectString);
+		// declared once per connection, prepared on the server the first time they are used
+		for (const std::pair<const std::string, std::string> & statement :
+				tissuestack::database::TissueStackPostgresConnector::PREPARED_STATEMENTS)
+			pooled.connection->prepare(statement.first, statement.second);
 	} catch(std::exception & bad)
 	{
 		tissuestack::logging::TissueStackLogger::instance()->error("Could not reconnect database Connection: %s\n", bad.what());
+		this->disconnectPooledConnection(pooled);
 	}
-
-	this->_busyNonTransactionalConnections[index] = false;
-}
-
-void tissuestack::database::TissueStackPostgresConnector::reconnectNonTransConnections()
-{
-	for (unsigned short index = 0; index < tissuestack::database::TissueStackPostgresConnector::MAX_NON_TRANSACTIONAL_CONNECTIONS; index++)
-	{
-		this->_busyNonTransactionalConnections[index] = true;
-		this->_non_trans_connections.push_back(nullptr);
-		this->reconnectNonTransConnection(index);
-		this->_busyNonTransactionalConnections[index] = false;
-	}
-	this->reconnectNonTransBackupConnection();
 }
 
 const bool tissuestack::database::TissueStackPostgresConnector::isTransConnected() const
@@ -396,72 +413,76 @@ const bool tissuestack::database::TissueStackPostgresConnector::isTransConnected
 	return false;
 }
 
-const bool tissuestack::database::TissueStackPostgresConnector::isNonTransBackupConnected() const
+const bool tissuestack::database::TissueStackPostgresConnector::isPoolConnected()
 {
-	if (this->_non_trans_backup_connection == nullptr) return false;
+	std::lock_guard<std::mutex> lock(this->_pool_mutex);
 
-	try
-	{
-		return this->_non_trans_backup_connection->is_open();
-	} catch (pqxx::broken_connection & disconnected)
+	// one working connection keeps us going, the others are reconnected as they are handed out
+	for (const tissuestack::database::TissueStackPostgresConnector::PooledConnection & pooled : this->_pooled_connections)
 	{
-		tissuestack::logging::TissueStackLogger::instance()->error("Database Connection Error: %s\n", disconnected.what());
-	} catch(std::exception & bad)
-	{
-		tissuestack::logging::TissueStackLogger::instance()->error("Database Connection Error: %s\n", bad.what());
+		if (pooled.connection == nullptr) continue;
+
+		try
+		{
+			if (pooled.connection->is_open())
+				return true;
+		} catch(std::exception & bad)
+		{
+			tissuestack::logging::TissueStackLogger::instance()->error("Database Connection Error: %s\n", bad.what());
+		}
 	}
+
 	return false;
 }
 
-void tissuestack::database::TissueStackPostgresConnector::reconnectNonTransBackupConnection()
+const unsigned long long int tissuestack::database::TissueStackPostgresConnector::getNumberOfCheckOuts() const
 {
-	this->disconnectNonTransBackupConnection();
+	return this->_check_outs.load();
+}
 
-	try
-	{
-		this->_non_trans_backup_connection = new pqxx::connection(this->_connectString);
-	} catch(std::exception & bad)
-	{
-		tissuestack::logging::TissueStackLogger::instance()->error("Could not reconnect database Connection: %s\n", bad.what());
-	}
+const unsigned long long int tissuestack::database::TissueStackPostgresConnector::getNumberOfWaits() const
+{
+	return this->_waits.load();
 }
 
-const bool tissuestack::database::TissueStackPostgresConnector::isNonTransConnected(const unsigned short index)
+const unsigned long long int tissuestack::database::TissueStackPostgresConnector::getNumberOfTimeOuts() const
 {
-	if (index >= tissuestack::database::TissueStackPostgresConnector::MAX_NON_TRANSACTIONAL_CONNECTIONS ||
-			this->_non_trans_connections[index] == nullptr)
-	{
-		this->_busyNonTransactionalConnections[index] = false;
-		return false;
-	}
+	return this->_time_outs.load();
+}
 
-	try
-	{
-		return this->_non_trans_connections[index]->is_open();
-	} catch (pqxx::broken_connection & disconnected) {
-		tissuestack::logging::TissueStackLogger::instance()->error("Database Connection Error: %s\n", disconnected.what());
-	} catch(std::exception & bad)
-	{
-		tissuestack::logging::TissueStackLogger::instance()->error("Database Connection Error: %s\n", bad.what());
-	}
-	this->_busyNonTransactionalConnections[index] = false;
-	return false;
+const unsigned long long int tissuestack::database::TissueStackPostgresConnector::getNumberOfReconnects() const
+{
+	return this->_reconnects.load();
 }
 
-const unsigned short tissuestack::database::TissueStackPostgresConnector::findNextIdleNonTransConnection()
+const unsigned long long int tissuestack::database::TissueStackPostgresConnector::getTotalWaitTimeInMicros() const
 {
-	unsigned short index = 0;
-	for (index = 0; index < tissuestack::database::TissueStackPostgresConnector::MAX_NON_TRANSACTIONAL_CONNECTIONS; index++)
-	{
-		if (this->_non_trans_connections[index] != nullptr && !this->_busyNonTransactionalConnections[index])
-		{
-			this->_busyNonTransactionalConnections[index] = true;
-			return index;
-		}
-	}
+	return this->_total_wait_time.load();
+}
 
-	return index;
+const unsigned long long int tissuestack::database::TissueStackPostgresConnector::getMaximumWaitTimeInMicros() const
+{
+	return this->_maximum_wait_time.load();
 }
 
+const std::string tissuestack::database::TissueStackPostgresConnector::getStatisticsAsJson() const
+{
+	const unsigned long long int checkOuts = this->getNumberOfCheckOuts();
+
+	std::ostringstream json;
+	json << "{ \"connections\": " << this->_pooled_connections.size();
+	json << ", \"in_use\": " << this->_connections_in_use.load();
+	json << ", \"maximum_in_use\": " << this->_maximum_connections_in_use.load();
+	json << ", \"check_outs\": " << checkOuts;
+	json << ", \"waits\": " << this->getNumberOfWaits();
+	json << ", \"time_outs\": " << this->getNumberOfTimeOuts();
+	json << ", \"reconnects\": " << this->getNumberOfReconnects();
+	json << ", \"average_wait_micros\": " <<
+		(checkOuts == 0 ? 0 : this->getTotalWaitTimeInMicros() / checkOuts);
+	json << ", \"maximum_wait_micros\": " << this->getMaximumWaitTimeInMicros();
+	json << " }";
+
+	return json.str();
+}
 
 tissuestack::database::TissueStackPostgresConnector * tissuestack::database::TissueStackPostgresConnector::_instance = nullptr;
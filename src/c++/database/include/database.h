@@ -18,6 +18,10 @@
 #define __DATABASE_H__
 
 #include "tissuestack.h"
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <map>
 #include <pqxx/pqxx>
 
 namespace tissuestack
@@ -39,6 +43,9 @@ namespace tissuestack
 				static TissueStackPostgresConnector * instance();
 				static const bool doesInstanceExist();
 				const pqxx::result executeNonTransactionalQuery(const std::string sql);
+				const pqxx::result executePreparedQuery(
+					const std::string & statement,
+					const std::vector<std::string> & parameters);
 				const unsigned long long int executeTransaction(const std::vector<std::string> sql);
 				const pqxx::result executePaginatedQuery(
 					const std::string sql,
@@ -46,23 +53,35 @@ namespace tissuestack
 					const unsigned int to);
 		    	void purgeInstance();
 		    	const bool isTransConnected() const;
-		    	const bool isNonTransBackupConnected() const;
-		    	const bool isNonTransConnected(const unsigned short index);
+		    	const bool isPoolConnected();
+				const unsigned long long int getNumberOfCheckOuts() const;
+				const unsigned long long int getNumberOfWaits() const;
+				const unsigned long long int getNumberOfTimeOuts() const;
+				const unsigned long long int getNumberOfReconnects() const;
+				const unsigned long long int getTotalWaitTimeInMicros() const;
+				const unsigned long long int getMaximumWaitTimeInMicros() const;
+				const std::string getStatisticsAsJson() const;
 			private:
-		    	static const unsigned short MAX_NON_TRANSACTIONAL_CONNECTIONS = 5;
-		    	std::atomic_bool _busyNonTransactionalConnections[MAX_NON_TRANSACTIONAL_CONNECTIONS];
+				// a connection of the pool for non transactional queries and when it was last known to work
+				typedef struct
+				{
+					pqxx::connection * connection;
+					bool is_healthy;
+					std::chrono::steady_clock::time_point checked_at;
+				} PooledConnection;
+				// statements prepared on every pooled connection: name => sql
+				static const std::map<std::string, std::string> PREPARED_STATEMENTS;
 		    	std::mutex _transactionMutex;
-		    	std::mutex _non_transactionMutex;
 		    	std::string _connectString;
 		    	void disconnectTransConnection();
-		    	void disconnectNonTransBackupConnection();
-		    	void disconnectNonTransConnections();
-		    	void disconnectNonTransConnection(const unsigned short index);
 		    	void reconnectTransConnection();
-		    	void reconnectNonTransConnections();
-		    	void reconnectNonTransBackupConnection();
-		    	void reconnectNonTransConnection(const unsigned short index);
-		    	const unsigned short findNextIdleNonTransConnection();
+		    	void disconnectPooledConnection(PooledConnection & pooled);
+		    	void reconnectPooledConnection(PooledConnection & pooled);
+		    	inline void checkPooledConnection(PooledConnection & pooled);
+		    	inline const unsigned short checkOutConnection();
+		    	inline void checkInConnection(const unsigned short index, const bool is_healthy);
+		    	inline const pqxx::result executeOnPooledConnection(
+		    		const std::function<const pqxx::result (pqxx::connection & connection)> & query);
 		    	TissueStackPostgresConnector(
 		    			const std::string host,
 		    			const short port,
@@ -70,9 +89,25 @@ namespace tissuestack
 		    			const std::string user,
 		    			const std::string password);
 				static TissueStackPostgresConnector * _instance;
-				std::vector<pqxx::connection *> _non_trans_connections;
 				pqxx::connection * _trans_connection = nullptr;
-				pqxx::connection * _non_trans_backup_connection = nullptr;
+				// the pool: idle connections are handed out last in first out,
+				// whoever has to wait for one gets served in order of arrival
+				std::mutex _pool_mutex;
+				std::condition_variable _connection_returned;
+				std::vector<PooledConnection> _pooled_connections;
+				std::vector<unsigned short> _idle_connections;
+				std::deque<unsigned long long int> _waiting_queue;
+				unsigned long long int _next_ticket = 0;
+				unsigned int _pool_wait_timeout = 0;
+				unsigned int _health_check_interval = 0;
+				std::atomic<unsigned short> _connections_in_use;
+				std::atomic<unsigned short> _maximum_connections_in_use;
+				std::atomic<unsigned long long int> _check_outs;
+				std::atomic<unsigned long long int> _waits;
+				std::atomic<unsigned long long int> _time_outs;
+				std::atomic<unsigned long long int> _reconnects;
+				std::atomic<unsigned long long int> _total_wait_time;
+				std::atomic<unsigned long long int> _maximum_wait_time;
 	 	};
 
 		class Configuration final
@@ -43,18 +43,6 @@ tissuestack::execution::TissueStackOnlineExecutor::~TissueStackOnlineExecutor()
 		delete this->_serviesDelegator;
 		this->_serviesDelegator = nullptr;
 	}
-
-	if (this->_tissueStackRawConverter)
-	{
-		delete this->_tissueStackRawConverter;
-		this->_tissueStackRawConverter = nullptr;
-	}
-
-	if (this->_tissueStackPreTiler)
-	{
-		delete this->_tissueStackPreTiler;
-		this->_tissueStackPreTiler = nullptr;
-	}
 }
 
 tissuestack::execution::TissueStackOnlineExecutor::TissueStackOnlineExecutor()
@@ -66,9 +54,7 @@ tissuestack::execution::TissueStackOnlineExecutor::TissueStackOnlineExecutor()
 	           	nullptr
 	        }), _imageExtractor(new tissuestack::imaging::ImageExtraction<tissuestack::imaging::SimpleCacheHeuristics>),
 			 	 //_imageExtractor(new tissuestack::imaging::ImageExtraction<tissuestack::imaging::NoCacheAdapter>),
-	        	_serviesDelegator(new tissuestack::services::TissueStackServicesDelegator()),
-	        	_tissueStackRawConverter(new tissuestack::imaging::RawConverter()),
-	        	_tissueStackPreTiler(new tissuestack::imaging::PreTiler()) {}
+	        	_serviesDelegator(new tissuestack::services::TissueStackServicesDelegator()) {}
 
 tissuestack::execution::TissueStackOnlineExecutor * tissuestack::execution::TissueStackOnlineExecutor::instance()
 {
@@ -79,12 +65,15 @@ tissuestack::execution::TissueStackOnlineExecutor * tissuestack::execution::Tiss
 	return tissuestack::execution::TissueStackOnlineExecutor::_instance;
 }
 
-void tissuestack::execution::TissueStackOnlineExecutor::execute(
+const bool tissuestack::execution::TissueStackOnlineExecutor::execute(
 		const tissuestack::common::ProcessingStrategy * processing_strategy,
 		const std::string request,
-		int client_descriptor)
+		int client_descriptor,
+		const bool keep_alive)
 {
 	std::string response = "";
+	// errors that occur before anything was written leave the connection intact
+	bool keepAlive = keep_alive;
 
 	try
 	{
@@ -96,6 +85,8 @@ void tissuestack::execution::TissueStackOnlineExecutor::execute(
 		  req.reset(this->_filters[i]->applyFilter(req.get()));
 		  i++;
 		}
+		// the handlers tell the client in their response whether we keep the connection
+		const_cast<tissuestack::common::Request *>(req.get())->setKeepAlive(keep_alive);
 
 		if (req.get()->getType() == tissuestack::common::Request::Type::TS_IMAGE) /* IMAGE REQUEST */
 			this->_imageExtractor->processImageRequest(
@@ -134,7 +125,8 @@ void tissuestack::execution::TissueStackOnlineExecutor::execute(
 				tissuestack::utils::Misc::composeHttpResponse(
 					"200 OK",
 					"application/json",
-					response);
+					response,
+					keepAlive);
 		}
 	}  catch (tissuestack::common::TissueStackObsoleteRequestException& obsoleteRequest) /* ERRONEOUS REQUESTS */
 	{
@@ -142,7 +134,8 @@ void tissuestack::execution::TissueStackOnlineExecutor::execute(
 				tissuestack::utils::Misc::composeHttpResponse(
 					"408 Request Timeout",
 					"application/json",
-					tissuestack::services::TissueStackServiceError(obsoleteRequest).toJson());
+					tissuestack::services::TissueStackServiceError(obsoleteRequest).toJson(),
+					keepAlive);
 	}  catch (tissuestack::common::TissueStackInvalidRequestException& invalidRequest)
 	{
 		if (std::strstr(invalidRequest.what(), "favicon.ico") != NULL)
@@ -150,7 +143,8 @@ void tissuestack::execution::TissueStackOnlineExecutor::execute(
 				tissuestack::utils::Misc::composeHttpResponse(
 					"404 Not Found",
 					"application/json",
-					tissuestack::services::TissueStackServiceError(invalidRequest).toJson());
+					tissuestack::services::TissueStackServiceError(invalidRequest).toJson(),
+					keepAlive);
 		else
 		{
 			tissuestack::logging::TissueStackLogger::instance()->error("Failed to execute Process: %s\n", invalidRequest.what());
@@ -158,54 +152,64 @@ void tissuestack::execution::TissueStackOnlineExecutor::execute(
 				tissuestack::utils::Misc::composeHttpResponse(
 					"200 OK",
 					"application/json",
-					tissuestack::services::TissueStackServiceError(invalidRequest).toJson());
+					tissuestack::services::TissueStackServiceError(invalidRequest).toJson(),
+					keepAlive);
 		}
 	}  catch (tissuestack::common::TissueStackFileUploadException& uploadException)
 	{
+		keepAlive = false;
 		tissuestack::logging::TissueStackLogger::instance()->error("Failed to upload a file: %s\n", uploadException.what());
 		response =
 			tissuestack::utils::Misc::composeHttpResponse(
 				"200 OK",
 				"application/json",
-				tissuestack::services::TissueStackServiceError(uploadException).toJson());
+				tissuestack::services::TissueStackServiceError(uploadException).toJson(),
+				keepAlive);
 	} catch (tissuestack::common::TissueStackApplicationException& ex)
 	{
+		keepAlive = false;
 		tissuestack::logging::TissueStackLogger::instance()->error("Failed to execute Process: %s\n", ex.what());
 		response =
 			tissuestack::utils::Misc::composeHttpResponse(
 				"200 OK",
 				"application/json",
-				tissuestack::services::TissueStackServiceError(ex).toJson());
+				tissuestack::services::TissueStackServiceError(ex).toJson(),
+				keepAlive);
 	} catch (tissuestack::common::TissueStackException& ex)
 	{
+		keepAlive = false;
 		tissuestack::logging::TissueStackLogger::instance()->error("Failed to execute Process: %s\n", ex.what());
 		response =
 			tissuestack::utils::Misc::composeHttpResponse(
 				"500 Internal Server Error",
 				"application/json",
-				tissuestack::services::TissueStackServiceError(ex).toJson());
+				tissuestack::services::TissueStackServiceError(ex).toJson(),
+				keepAlive);
 	}  catch (std::exception & bad)
 	{
+		keepAlive = false;
 		tissuestack::logging::TissueStackLogger::instance()->error("Failed to execute Process: %s\n", bad.what());
 		response =
 			tissuestack::utils::Misc::composeHttpResponse(
 				"500 Internal Server Error",
 				"application/json",
-				tissuestack::services::TissueStackServiceError(bad).toJson());
+				tissuestack::services::TissueStackServiceError(bad).toJson(),
+				keepAlive);
 	}
 
+	// the request handler has written its response already
 	if (response.empty())
-	{
-		close(client_descriptor);
-		return;
-	}
+		return keepAlive;
 
-	// sending error message
-	ssize_t  bytes = send(client_descriptor, response.c_str(), response.length(), 0);
-	if (bytes < 0)
+	// sending error message, a partial write leaves the connection unusable
+	if (!tissuestack::utils::Misc::writeHttpResponse(client_descriptor, response))
+	{
 		tissuestack::logging::TissueStackLogger::instance()->error(
 			"Error Sending 500 Internal Server Error: %s \n", strerror(errno));
-	close(client_descriptor);
+		return false;
+	}
+
+	return keepAlive;
 }
 
 void tissuestack::execution::TissueStackOnlineExecutor::executeTask(
@@ -215,14 +219,20 @@ void tissuestack::execution::TissueStackOnlineExecutor::executeTask(
 	if (task == nullptr || processing_strategy == nullptr)
 		return;
 
+	// tasks run side by side in the task queue slots, each gets its own converter/tiler
 	if (task->getType() == tissuestack::services::TissueStackTaskType::CONVERSION)
-		this->_tissueStackRawConverter->convert(
+	{
+		tissuestack::imaging::RawConverter converter;
+		converter.convert(
 			processing_strategy,
 			static_cast<const tissuestack::services::TissueStackConversionTask *>(task));
-	else if (task->getType() == tissuestack::services::TissueStackTaskType::TILING)
-		this->_tissueStackPreTiler->preTile(
+	} else if (task->getType() == tissuestack::services::TissueStackTaskType::TILING)
+	{
+		tissuestack::imaging::PreTiler tiler;
+		tiler.preTile(
 			processing_strategy,
 			static_cast<const tissuestack::services::TissueStackTilingTask *>(task));
+	}
 }
 
 tissuestack::execution::TissueStackOnlineExecutor * tissuestack::execution::TissueStackOnlineExecutor::_instance = nullptr;
@@ -52,9 +52,7 @@ void tissuestack::execution::TissueStackSliceCacheCleaner::init()
 				if (this->hasNoTasksQueued())
 					break;
 
-				if (tissuestack::utils::System::getFreeRam() > tissuestack::imaging::TissueStackSliceCache::MINIMUM_FREE_RAM_IN_BYTES)
-					continue;
-
+				// the cache keeps within its byte budget by itself, we only drop idle entries
 				tissuestack::imaging::TissueStackSliceCache::instance()->cleanUpCache();
 			}
 			tissuestack::logging::TissueStackLogger::instance()->info(
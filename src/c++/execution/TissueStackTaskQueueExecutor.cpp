@@ -20,9 +20,23 @@
 #include "execution.h"
 
 tissuestack::execution::TissueStackTaskQueueExecutor::TissueStackTaskQueueExecutor() :
-	tissuestack::execution::ThreadPool(1)
+	tissuestack::execution::ThreadPool(
+		tissuestack::execution::TissueStackTaskQueueExecutor::getConfiguredValue("task_queue_slots", 1)),
+	_max_conversions(tissuestack::execution::TissueStackTaskQueueExecutor::getConfiguredValue("task_queue_max_conversions", 1)),
+	_max_tilings(tissuestack::execution::TissueStackTaskQueueExecutor::getConfiguredValue("task_queue_max_tilings", 1))
 {
-	tissuestack::logging::TissueStackLogger::instance()->info("Launching Task Queue Executor");
+	tissuestack::logging::TissueStackLogger::instance()->info(
+		"Launching Task Queue Executor with %u slots (max. %u conversions, %u tilings)",
+		this->getNumberOfThreads(), this->_max_conversions, this->_max_tilings);
+}
+
+const unsigned short tissuestack::execution::TissueStackTaskQueueExecutor::getConfiguredValue(
+	const std::string & parameter, const unsigned short minimum)
+{
+	const unsigned long int value =
+		strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter(parameter).c_str(), NULL, 10);
+
+	return value < minimum ? minimum : static_cast<unsigned short>(value);
 }
 
 void tissuestack::execution::TissueStackTaskQueueExecutor::init()
@@ -37,21 +51,33 @@ void tissuestack::execution::TissueStackTaskQueueExecutor::init()
 
 			while (!this->isStopFlagRaised())
 			{
-				//std::this_thread::sleep_for(std::chrono::milliseconds(100));
-				usleep(100000); // 100,000 micro seconds /100 milli seconds
-
 				if (!tissuestack::services::TissueStackTaskQueue::doesInstanceExist())
 					break;
 
-				// fetch next item from the globale task queue
+				// claim the next item from the global task queue, waits until one is added or a slot frees up
 				tissuestack::services::TissueStackTask * next_task =
 					const_cast<tissuestack::services::TissueStackTask *>(
-					tissuestack::services::TissueStackTaskQueue::instance()->getNextTask());
+					tissuestack::services::TissueStackTaskQueue::instance()->claimNextTask(
+						this->_max_conversions,
+						this->_max_tilings,
+						tissuestack::execution::TissueStackTaskQueueExecutor::WAIT_FOR_TASK_IN_MILLIS));
 				if (next_task == nullptr) continue;
 
-				// delegate to online executor
-				tissuestack::execution::TissueStackOnlineExecutor::instance()->executeTask(
-					this, next_task);
+				// the task is gone once it has finished, hold on to the id for the release
+				const std::string task_id = next_task->getId();
+				try
+				{
+					// delegate to online executor
+					tissuestack::execution::TissueStackOnlineExecutor::instance()->executeTask(
+						this, next_task);
+				} catch (...)
+				{
+					tissuestack::logging::TissueStackLogger::instance()->error(
+						"Task %s failed unexpectedly!\n", task_id.c_str());
+				}
+
+				if (tissuestack::services::TissueStackTaskQueue::doesInstanceExist())
+					tissuestack::services::TissueStackTaskQueue::instance()->releaseTask(task_id);
 			}
 			tissuestack::logging::TissueStackLogger::instance()->info(
 					"Task Queue Thread %u is about to stop working!\n",
@@ -83,6 +109,6 @@ bool tissuestack::execution::TissueStackTaskQueueExecutor::hasNoTasksQueued()
 {
 	if (tissuestack::services::TissueStackTaskQueue::instance() == nullptr) return true;
 
-	return tissuestack::services::TissueStackTaskQueue::instance()->getNextTask() == nullptr;
+	return !tissuestack::services::TissueStackTaskQueue::instance()->hasQueuedTasks();
 }
 
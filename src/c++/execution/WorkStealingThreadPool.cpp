@@ -0,0 +1,227 @@
+/*
+ * This file is part of TissueStack.
+ *
+ * TissueStack is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TissueStack is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TissueStack.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "execution.h"
+
+tissuestack::execution::WorkStealingThreadPool::WorkStealingThreadPool(short number_of_threads) :
+	tissuestack::execution::ThreadPool(number_of_threads),
+	_next_worker_index(0), _next_queue_index(0), _queue_depth(0),
+	_dispatched_tasks(0), _stolen_tasks(0), _total_wait_time(0), _maximum_wait_time(0)
+{
+	// one queue (and lock) per worker so that submission and removal rarely contend
+	this->_work_queues = new std::deque<QueuedTask>[number_of_threads];
+	this->_work_queue_mutexes = new std::mutex[number_of_threads];
+}
+
+tissuestack::execution::WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+	// clean up whatever has not been processed
+	int i=0;
+	while (i<this->getNumberOfThreads()) {
+		for (auto queuedTask : this->_work_queues[i])
+			delete queuedTask.task;
+		i++;
+	}
+
+	delete [] this->_work_queues;
+	delete [] this->_work_queue_mutexes;
+}
+
+void tissuestack::execution::WorkStealingThreadPool::init()
+{
+	// the wait loop
+	std::function<void (tissuestack::execution::WorkerThread * assigned_worker)> wait_loop =
+		[this] (tissuestack::execution::WorkerThread * assigned_worker)
+		{
+			const short worker_index = this->_next_worker_index++ % this->getNumberOfThreads();
+
+			tissuestack::logging::TissueStackLogger::instance()->info(
+				"Thread %u is ready (queue %u)\n",
+				std::hash<std::thread::id>()(std::this_thread::get_id()), worker_index);
+
+			while (!this->isStopFlagRaised())
+			{
+				// fetch next item from our queue or steal one from somebody else's
+				const std::function<void (const tissuestack::common::ProcessingStrategy * _this)> * next_task =
+					this->removeTask(worker_index);
+				if (next_task == nullptr)
+				{
+					// nothing to do: sleep until somebody submits work or we are told to stop
+					// the timeout is merely a safety net, not the means of waking up
+					std::unique_lock<std::mutex> lock(this->_wake_up_mutex);
+					this->_wake_up_condition.wait_for(lock, std::chrono::seconds(1),
+						[this] { return this->_queue_depth.load() > 0 || this->isStopFlagRaised(); });
+					continue;
+				}
+
+				try
+				{
+					((*next_task)(this));
+					// clean up pointer
+					delete next_task;
+				}  catch (std::exception& bad)
+				{
+					// clean up and propagate
+					delete next_task;
+					throw bad;
+				}
+			}
+			tissuestack::logging::TissueStackLogger::instance()->info(
+					"Thread %u is about to stop working!\n",
+					std::hash<std::thread::id>()(std::this_thread::get_id()));
+			assigned_worker->stop();
+		};
+	this->init0(wait_loop);
+}
+
+void tissuestack::execution::WorkStealingThreadPool::stop()
+{
+	tissuestack::execution::ThreadPool::stop();
+
+	// wake up everybody so that they notice the stop flag
+	{
+		std::lock_guard<std::mutex> lock(this->_wake_up_mutex);
+	}
+	this->_wake_up_condition.notify_all();
+
+	if (!this->isRunning())
+		tissuestack::logging::TissueStackLogger::instance()->info(
+			"Thread Pool Statistics: %s\n", this->getStatisticsAsJson().c_str());
+}
+
+void tissuestack::execution::WorkStealingThreadPool::addTask(
+	const std::function<void (const tissuestack::common::ProcessingStrategy * _this)> * functionality)
+{
+	// distribute round robin
+	const short queue_index = this->_next_queue_index++ % this->getNumberOfThreads();
+	{
+		std::lock_guard<std::mutex> lock(this->_work_queue_mutexes[queue_index]);
+		this->_work_queues[queue_index].push_back({ functionality, std::chrono::steady_clock::now() });
+		this->_queue_depth++;
+	}
+
+	// taking the lock before notifying makes sure a worker that is about to go to sleep
+	// either sees the new queue depth or receives the notification
+	{
+		std::lock_guard<std::mutex> lock(this->_wake_up_mutex);
+	}
+	this->_wake_up_condition.notify_one();
+}
+
+const std::function<void (const tissuestack::common::ProcessingStrategy * _this)> * tissuestack::execution::WorkStealingThreadPool::removeTask()
+{
+	return this->removeTask(0);
+}
+
+const std::function<void (const tissuestack::common::ProcessingStrategy * _this)> * tissuestack::execution::WorkStealingThreadPool::removeTask(
+	const short worker_index)
+{
+	if (this->_queue_depth.load() == 0) return nullptr;
+
+	// own queue first: oldest request first
+	{
+		std::lock_guard<std::mutex> lock(this->_work_queue_mutexes[worker_index]);
+		if (!this->_work_queues[worker_index].empty())
+		{
+			const QueuedTask next = this->_work_queues[worker_index].front();
+			this->_work_queues[worker_index].pop_front();
+			this->_queue_depth--;
+			this->recordWaitTime(next.queued_at);
+			return next.task;
+		}
+	}
+
+	// steal from the back of the others
+	const short number_of_threads = this->getNumberOfThreads();
+	short i = 1;
+	while (i < number_of_threads)
+	{
+		const short victim = (worker_index + i) % number_of_threads;
+		std::lock_guard<std::mutex> lock(this->_work_queue_mutexes[victim]);
+		if (!this->_work_queues[victim].empty())
+		{
+			const QueuedTask next = this->_work_queues[victim].back();
+			this->_work_queues[victim].pop_back();
+			this->_queue_depth--;
+			this->_stolen_tasks++;
+			this->recordWaitTime(next.queued_at);
+			return next.task;
+		}
+		i++;
+	}
+
+	return nullptr;
+}
+
+bool tissuestack::execution::WorkStealingThreadPool::hasNoTasksQueued()
+{
+	return this->_queue_depth.load() == 0;
+}
+
+void tissuestack::execution::WorkStealingThreadPool::recordWaitTime(const std::chrono::steady_clock::time_point & queued_at)
+{
+	const unsigned long long int waited =
+		std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - queued_at).count();
+
+	this->_dispatched_tasks++;
+	this->_total_wait_time += waited;
+
+	unsigned long long int maximum = this->_maximum_wait_time.load();
+	while (waited > maximum && !this->_maximum_wait_time.compare_exchange_weak(maximum, waited));
+}
+
+const unsigned long long int tissuestack::execution::WorkStealingThreadPool::getQueueDepth() const
+{
+	return this->_queue_depth.load();
+}
+
+const unsigned long long int tissuestack::execution::WorkStealingThreadPool::getNumberOfDispatchedTasks() const
+{
+	return this->_dispatched_tasks.load();
+}
+
+const unsigned long long int tissuestack::execution::WorkStealingThreadPool::getNumberOfStolenTasks() const
+{
+	return this->_stolen_tasks.load();
+}
+
+const unsigned long long int tissuestack::execution::WorkStealingThreadPool::getTotalWaitTimeInMicros() const
+{
+	return this->_total_wait_time.load();
+}
+
+const unsigned long long int tissuestack::execution::WorkStealingThreadPool::getMaximumWaitTimeInMicros() const
+{
+	return this->_maximum_wait_time.load();
+}
+
+const std::string tissuestack::execution::WorkStealingThreadPool::getStatisticsAsJson() const
+{
+	const unsigned long long int dispatched = this->getNumberOfDispatchedTasks();
+
+	std::ostringstream json;
+	json << "{ \"threads\": " << this->getNumberOfThreads();
+	json << ", \"queue_depth\": " << this->getQueueDepth();
+	json << ", \"dispatched\": " << dispatched;
+	json << ", \"stolen\": " << this->getNumberOfStolenTasks();
+	json << ", \"average_wait_micros\": " <<
+		(dispatched == 0 ? 0 : this->getTotalWaitTimeInMicros() / dispatched);
+	json << ", \"maximum_wait_micros\": " << this->getMaximumWaitTimeInMicros();
+	json << " }";
+
+	return json.str();
+}
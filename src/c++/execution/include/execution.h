@@ -19,6 +19,7 @@
 
 #include "tissuestack.h"
 #include <condition_variable>
+#include <deque>
 #include <time.h>
 #include <thread>
 #include <chrono>
@@ -81,6 +82,45 @@ namespace tissuestack
 				std::queue<const std::function<void (const tissuestack::common::ProcessingStrategy * _this)> *> _work_load;
 		};
 
+		class WorkStealingThreadPool: public ThreadPool
+		{
+			public:
+				WorkStealingThreadPool & operator=(const WorkStealingThreadPool&) = delete;
+				WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+				explicit WorkStealingThreadPool(short number_of_threads);
+				~WorkStealingThreadPool();
+				void init();
+				void addTask(const std::function<void (const tissuestack::common::ProcessingStrategy * _this)> * functionality);
+				const std::function<void (const tissuestack::common::ProcessingStrategy * _this)> * removeTask();
+				bool hasNoTasksQueued();
+				void stop();
+				const unsigned long long int getQueueDepth() const;
+				const unsigned long long int getNumberOfDispatchedTasks() const;
+				const unsigned long long int getNumberOfStolenTasks() const;
+				const unsigned long long int getTotalWaitTimeInMicros() const;
+				const unsigned long long int getMaximumWaitTimeInMicros() const;
+				const std::string getStatisticsAsJson() const;
+			private:
+				typedef struct
+				{
+					const std::function<void (const tissuestack::common::ProcessingStrategy * _this)> * task;
+					std::chrono::steady_clock::time_point queued_at;
+				} QueuedTask;
+				const std::function<void (const tissuestack::common::ProcessingStrategy * _this)> * removeTask(const short worker_index);
+				void recordWaitTime(const std::chrono::steady_clock::time_point & queued_at);
+				std::deque<QueuedTask> * _work_queues = nullptr;
+				std::mutex * _work_queue_mutexes = nullptr;
+				std::mutex _wake_up_mutex;
+				std::condition_variable _wake_up_condition;
+				std::atomic<unsigned short> _next_worker_index;
+				std::atomic<unsigned long long int> _next_queue_index;
+				std::atomic<unsigned long long int> _queue_depth;
+				std::atomic<unsigned long long int> _dispatched_tasks;
+				std::atomic<unsigned long long int> _stolen_tasks;
+				std::atomic<unsigned long long int> _total_wait_time;
+				std::atomic<unsigned long long int> _maximum_wait_time;
+		};
+
 		class TissueStackTaskQueueExecutor: public ThreadPool
 		{
 			public:
@@ -93,6 +133,10 @@ namespace tissuestack
 				const std::function<void (const tissuestack::common::ProcessingStrategy * _this)> * removeTask();
 				bool hasNoTasksQueued();
 			private:
+				static const unsigned int WAIT_FOR_TASK_IN_MILLIS = 500;
+				static const unsigned short getConfiguredValue(const std::string & parameter, const unsigned short minimum);
+				const unsigned short _max_conversions;
+				const unsigned short _max_tilings;
 				std::mutex _conditional_mutex;
 		};
 
@@ -144,10 +188,11 @@ namespace tissuestack
 				TissueStackOnlineExecutor & operator=(const TissueStackOnlineExecutor&) = delete;
 				TissueStackOnlineExecutor(const TissueStackOnlineExecutor&) = delete;
 				static TissueStackOnlineExecutor * instance();
-				void execute(
+				const bool execute(
 					const tissuestack::common::ProcessingStrategy * processing_strategy,
 					const std::string request,
-					int client_descriptor);
+					int client_descriptor,
+					const bool keep_alive);
 				void executeTask(
 					const tissuestack::common::ProcessingStrategy * processing_strategy,
 					const tissuestack::services::TissueStackTask * task);
@@ -157,8 +202,6 @@ namespace tissuestack
 				tissuestack::common::RequestFilter ** _filters = nullptr;
 				tissuestack::imaging::ImageExtraction<tissuestack::imaging::SimpleCacheHeuristics> * _imageExtractor = nullptr;
 				tissuestack::services::TissueStackServicesDelegator * _serviesDelegator = nullptr;
-				tissuestack::imaging::RawConverter * _tissueStackRawConverter = nullptr;
-				tissuestack::imaging::PreTiler * _tissueStackPreTiler = nullptr;
 				static TissueStackOnlineExecutor * _instance;
 
 		};
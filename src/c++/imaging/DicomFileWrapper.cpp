@@ -41,8 +41,10 @@ tissuestack::imaging::DicomFileWrapper::DicomFileWrapper(const std::string filen
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 			"Supposed Dicom File does not exist in that location!");
 
-	// load file to read header tags
-	DcmFileFormat dicomFormat;
+	// load file to read header tags, large elements such as the pixel data are read lazily.
+	// we hold on to the parsed data set so that getData does not need to parse the file again
+	this->_dicom_file.reset(new DcmFileFormat());
+	DcmFileFormat & dicomFormat = *this->_dicom_file;
 	OFCondition status = dicomFormat.loadFile(filename.c_str());
 	if (!status.good())
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
@@ -237,8 +239,18 @@ const std::string tissuestack::imaging::DicomFileWrapper::getAcquisitionType() c
 
 const unsigned char * tissuestack::imaging::DicomFileWrapper::getData()
 {
-	// the dicom image
-	std::unique_ptr<DicomImage> dcmTmp(new DicomImage(this->_file_name.c_str(), CIF_AcrNemaCompatibility));
+	// take over the data set parsed in the constructor: decoding pulls the pixel data into it
+	// and we don't want to keep that around once the image (declared after it) is gone
+	std::unique_ptr<DcmFileFormat> parsedDicom(std::move(this->_dicom_file));
+
+	// the dicom image, decoded from the parsed data set if we still have it
+	std::unique_ptr<DicomImage> dcmTmp(
+		parsedDicom ?
+			new DicomImage(
+				parsedDicom->getDataset(),
+				parsedDicom->getDataset()->getOriginalXfer(),
+				CIF_AcrNemaCompatibility) :
+			new DicomImage(this->_file_name.c_str(), CIF_AcrNemaCompatibility));
 
 	unsigned long data_size = dcmTmp->getOutputDataSize(
 		(this->getAllocatedBits() <= 8 || this->isColor()) ? 8 : 16);
@@ -441,6 +453,7 @@ const bool tissuestack::imaging::DicomFileWrapper::isColor() const
 
 tissuestack::imaging::DicomFileWrapper::~DicomFileWrapper()
 {
+	this->_dicom_file.reset();
 	if (this->_isTemp)
 		unlink(this->_file_name.c_str());
 }
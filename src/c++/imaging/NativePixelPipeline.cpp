@@ -0,0 +1,226 @@
+/*
+ * This file is part of TissueStack.
+ *
+ * TissueStack is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TissueStack is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TissueStack.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "networking.h"
+#include "imaging.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+const unsigned short tissuestack::imaging::NativePixelPipeline::RENDER_PADDING = 16;
+
+void tissuestack::imaging::NativePixelPipeline::composeSampling(
+	std::vector<unsigned long int> & index_map,
+	const unsigned long int source_length,
+	const unsigned long int target_length)
+{
+	if (source_length == target_length || target_length == 0)
+		return;
+
+	for (auto & index : index_map)
+	{
+		index = static_cast<unsigned long int>(
+			((static_cast<double>(index) + 0.5) * static_cast<double>(source_length)) /
+				static_cast<double>(target_length));
+		if (index >= source_length)
+			index = source_length - 1;
+	}
+}
+
+void tissuestack::imaging::NativePixelPipeline::composeFlip(
+	std::vector<unsigned long int> & index_map,
+	const unsigned long int length)
+{
+	for (auto & index : index_map)
+		index = length - 1 - index;
+}
+
+const bool tissuestack::imaging::NativePixelPipeline::isAvx2Supported()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	static const bool avx2 = [] () { __builtin_cpu_init(); return __builtin_cpu_supports("avx2") != 0; } ();
+	return avx2;
+#else
+	return false;
+#endif
+}
+
+void tissuestack::imaging::NativePixelPipeline::render(
+	const unsigned char * source,
+	const unsigned long long int source_length,
+	const unsigned long int source_width,
+	const std::vector<unsigned long int> & rows,
+	const std::vector<unsigned long int> & columns,
+	const unsigned int * lookup_table,
+	const bool rgb_output,
+	unsigned char * destination)
+{
+	if (source == nullptr || destination == nullptr || lookup_table == nullptr ||
+			rows.empty() || columns.empty())
+		return;
+
+	const unsigned long int width = columns.size();
+	const unsigned short bytesPerPixel = rgb_output ? 3 : 1;
+
+	// 32 bit indices for the gathers
+	std::vector<unsigned int> columns32(columns.begin(), columns.end());
+	const unsigned long int maxColumn = *std::max_element(columns.begin(), columns.end());
+
+	const bool useAvx2 = tissuestack::imaging::NativePixelPipeline::isAvx2Supported();
+
+	for (unsigned long int y=0;y<rows.size();y++)
+	{
+		const unsigned long long int rowOffset =
+			static_cast<unsigned long long int>(rows[y]) * static_cast<unsigned long long int>(source_width);
+		unsigned char * destinationRow = destination + y * width * bytesPerPixel;
+
+		// the gathers load 4 bytes per pixel, don't let them read beyond the source
+		if (useAvx2 && rowOffset + maxColumn + 4 <= source_length)
+			tissuestack::imaging::NativePixelPipeline::renderRowAvx2(
+				source + rowOffset, columns32.data(), width, lookup_table, rgb_output, destinationRow);
+		else
+			tissuestack::imaging::NativePixelPipeline::renderRow(
+				source + rowOffset, columns32.data(), width, lookup_table, rgb_output, destinationRow);
+	}
+}
+
+void tissuestack::imaging::NativePixelPipeline::renderRgb(
+	const unsigned char * source,
+	const unsigned long int source_width,
+	const std::vector<unsigned long int> & rows,
+	const std::vector<unsigned long int> & columns,
+	const unsigned char * channel_lookup_table,
+	const unsigned int * color_lookup_table,
+	unsigned char * destination)
+{
+	if (source == nullptr || destination == nullptr || channel_lookup_table == nullptr ||
+			rows.empty() || columns.empty())
+		return;
+
+	for (unsigned long int y=0;y<rows.size();y++)
+	{
+		const unsigned char * sourceRow =
+			source + static_cast<unsigned long long int>(rows[y]) * source_width * 3;
+
+		for (unsigned long int x=0;x<columns.size();x++)
+		{
+			const unsigned char * pixel = sourceRow + columns[x] * 3;
+			if (color_lookup_table)
+			{
+				const unsigned int rgb = color_lookup_table[pixel[0]];
+				destination[0] = static_cast<unsigned char>(rgb & 0xFF);
+				destination[1] = static_cast<unsigned char>((rgb >> 8) & 0xFF);
+				destination[2] = static_cast<unsigned char>((rgb >> 16) & 0xFF);
+			} else
+			{
+				destination[0] = channel_lookup_table[pixel[0]];
+				destination[1] = channel_lookup_table[pixel[1]];
+				destination[2] = channel_lookup_table[pixel[2]];
+			}
+			destination += 3;
+		}
+	}
+}
+
+void tissuestack::imaging::NativePixelPipeline::renderRow(
+	const unsigned char * source_row,
+	const unsigned int * columns,
+	const unsigned long int width,
+	const unsigned int * lookup_table,
+	const bool rgb_output,
+	unsigned char * destination)
+{
+	if (rgb_output)
+	{
+		for (unsigned long int x=0;x<width;x++)
+		{
+			const unsigned int rgb = lookup_table[source_row[columns[x]]];
+			destination[0] = static_cast<unsigned char>(rgb & 0xFF);
+			destination[1] = static_cast<unsigned char>((rgb >> 8) & 0xFF);
+			destination[2] = static_cast<unsigned char>((rgb >> 16) & 0xFF);
+			destination += 3;
+		}
+		return;
+	}
+
+	for (unsigned long int x=0;x<width;x++)
+		destination[x] = static_cast<unsigned char>(lookup_table[source_row[columns[x]]] & 0xFF);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+void tissuestack::imaging::NativePixelPipeline::renderRowAvx2(
+	const unsigned char * source_row,
+	const unsigned int * columns,
+	const unsigned long int width,
+	const unsigned int * lookup_table,
+	const bool rgb_output,
+	unsigned char * destination)
+{
+	const __m256i lowByte = _mm256_set1_epi32(0xFF);
+	// per 128 bit lane: pack 4 RGBX dwords into 12 RGB bytes or pick the 4 gray bytes
+	const __m256i packRgb = _mm256_setr_epi8(
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	const __m256i packGray = _mm256_setr_epi8(
+		0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+	unsigned long int x = 0;
+	for (;x+8<=width;x+=8)
+	{
+		const __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(columns + x));
+		const __m256i gray =
+			_mm256_and_si256(
+				_mm256_i32gather_epi32(reinterpret_cast<const int *>(source_row), indices, 1), lowByte);
+		const __m256i mapped = _mm256_i32gather_epi32(reinterpret_cast<const int *>(lookup_table), gray, 4);
+
+		if (rgb_output)
+		{
+			// 16 byte stores with 12 bytes advance, the overlap is rewritten by the next block
+			const __m256i packed = _mm256_shuffle_epi8(mapped, packRgb);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + x * 3), _mm256_castsi256_si128(packed));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + x * 3 + 12), _mm256_extracti128_si256(packed, 1));
+		} else
+		{
+			const __m256i packed = _mm256_shuffle_epi8(mapped, packGray);
+			const int lower = _mm_cvtsi128_si32(_mm256_castsi256_si128(packed));
+			const int upper = _mm_cvtsi128_si32(_mm256_extracti128_si256(packed, 1));
+			memcpy(destination + x, &lower, 4);
+			memcpy(destination + x + 4, &upper, 4);
+		}
+	}
+
+	// remainder
+	if (x < width)
+		tissuestack::imaging::NativePixelPipeline::renderRow(
+			source_row, columns + x, width - x, lookup_table, rgb_output,
+			destination + x * (rgb_output ? 3 : 1));
+}
+#else
+void tissuestack::imaging::NativePixelPipeline::renderRowAvx2(
+	const unsigned char * source_row,
+	const unsigned int * columns,
+	const unsigned long int width,
+	const unsigned int * lookup_table,
+	const bool rgb_output,
+	unsigned char * destination)
+{
+	tissuestack::imaging::NativePixelPipeline::renderRow(
+		source_row, columns, width, lookup_table, rgb_output, destination);
+}
+#endif
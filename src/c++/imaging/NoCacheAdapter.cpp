@@ -79,9 +79,12 @@ const std::array<unsigned long long int, 3> tissuestack::imaging::NoCacheAdapter
 						request->getYCoordinate())*actualDimension->getWidth()*multiplier +
 					static_cast<unsigned long long int>(request->getXCoordinate()*multiplier));
 
+		// 8 bit data has a single grey value
 		pixel_value[0] = static_cast<unsigned long long int>(cache_data[actualOffset]);
-		pixel_value[1] = static_cast<unsigned long long int>(cache_data[actualOffset+1]);
-		pixel_value[2] = static_cast<unsigned long long int>(cache_data[actualOffset+2]);
+		pixel_value[1] = multiplier == 1 ?
+			pixel_value[0] : static_cast<unsigned long long int>(cache_data[actualOffset+1]);
+		pixel_value[2] = multiplier == 1 ?
+			pixel_value[0] : static_cast<unsigned long long int>(cache_data[actualOffset+2]);
 	} else
 	{
 		Image * img =
@@ -107,7 +110,7 @@ const std::array<unsigned long long int, 3> tissuestack::imaging::NoCacheAdapter
 		DestroyImage(img);
 	}
 
-	delete [] cache_data;
+	this->_uncached_extraction->releaseImageOnly(image, cache_data);
 
 	return pixel_value;
 }
@@ -128,8 +131,48 @@ const Image *  tissuestack::imaging::NoCacheAdapter::extractImage(
 	const Image * img =
 		this->_uncached_extraction->createImageFromDataRead(image, actualDimension, cache_data);
 
-	delete [] cache_data;
+	this->_uncached_extraction->releaseImageOnly(image, cache_data);
 
 	return img;
 
 }
+
+Image * tissuestack::imaging::NoCacheAdapter::extractAndProcessImage(
+	const tissuestack::common::ProcessingStrategy * processing_strategy,
+	const TissueStackRawData * image,
+	const tissuestack::networking::TissueStackImageRequest * request) const
+{
+	if (!this->_uncached_extraction->supportsNativeProcessing(image))
+	{
+		Image * img =
+			const_cast<Image *>(this->extractImage(processing_strategy, image, request));
+
+		// timeout/shutdown check
+		if (request->hasExpired() || processing_strategy->isStopFlagRaised())
+		{
+			if (img) DestroyImage(img);
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackObsoleteRequestException,
+				"Old Image Request!");
+		}
+
+		return this->applyPostExtractionTasks(img, image, request);
+	}
+
+	const unsigned char * data = this->_uncached_extraction->extractImageOnly(image, request);
+	if (data == nullptr)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Could not extract image data");
+
+	Image * img = NULL;
+	try
+	{
+		img = this->_uncached_extraction->processImageNatively(image, request, data);
+	} catch (...)
+	{
+		this->_uncached_extraction->releaseImageOnly(image, data);
+		throw;
+	}
+	this->_uncached_extraction->releaseImageOnly(image, data);
+
+	return img;
+}
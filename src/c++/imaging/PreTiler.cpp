@@ -131,232 +131,323 @@ inline void tissuestack::imaging::PreTiler::loopOverDimensions(
 	const std::vector<std::string> dims =
 		pretiling_task->getDimensions();
 
-	const std::vector<unsigned short> zoom_levels =
-			pretiling_task->getZoomLevels();
-
-	bool resumed = pretiling_task->getSlicesDone() == 0 ? false : true;
-	unsigned long long int dimSliceOffset = 0;
-	unsigned long long int accDimSliceNumber = 0;
-
-	// loop over all dimension
+	const unsigned long long int numberOfZoomLevels =
+			pretiling_task->getZoomLevels().size();
+	if (numberOfZoomLevels == 0)
+		return;
+
+	// the units of work are (dimension, slice) in the order progress is counted in,
+	// each of them accounts for all zoom levels of that slice
+	std::vector<TilingUnit> units;
 	for (auto dim : dims)
 	{
-		// shutdown/cancellation check
-		if (this->hasBeenCancelledOrShutDown(processing_strategy, pretiling_task))
-			return;
-
 		const tissuestack::imaging::TissueStackDataDimension * actualDimension =
 				pretiling_task->getInputImageData()->getDimensionByLongName(dim);
 
-		accDimSliceNumber +=
-			(actualDimension->getNumberOfSlices() * static_cast<unsigned long long int>(zoom_levels.size()));
+		for (unsigned int sliceNumber = 0; sliceNumber < actualDimension->getNumberOfSlices(); sliceNumber++)
+			units.push_back({ dim, actualDimension, sliceNumber });
+	}
 
-		// resume at a previously interrupted point
-		if (resumed && processing_strategy->isOnlineStrategy() &&
-			pretiling_task->getSlicesDone() >= accDimSliceNumber)
-		{
-			dimSliceOffset = accDimSliceNumber;
-			continue;
-		}
+	// resume at a previously interrupted point: everything below slices done has been tiled
+	const unsigned long long int firstUnit =
+		processing_strategy->isOnlineStrategy() ?
+			pretiling_task->getSlicesDone() / numberOfZoomLevels : 0;
+	if (firstUnit >= units.size())
+		return;
+
+	unsigned short numberOfThreads =
+		static_cast<unsigned short>(
+			strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("pre_tiling_threads").c_str(), NULL, 10));
+	if (numberOfThreads == 0)
+		numberOfThreads = tissuestack::utils::System::getNumberOfCores();
+	if (numberOfThreads > units.size() - firstUnit)
+		numberOfThreads = units.size() - firstUnit;
+
+	// tiles stay individual files unless the packed archives are asked for
+	std::unique_ptr<TileArchives> archives;
+	if (tissuestack::TissueStackConfigurationParameters::instance()->getParameter("pre_tiling_storage").compare("archive") == 0)
+	{
+		archives.reset(new TileArchives());
+		archives->square_length = pretiling_task->getSquareLength();
+	}
 
-		unsigned long long int zoomSliceOffset = dimSliceOffset;
-		unsigned long long int accNumber = zoomSliceOffset;
+	std::atomic<unsigned long long int> nextUnit(firstUnit);
+	std::atomic<bool> abort(false);
+	std::exception_ptr failure = nullptr;
 
-		// loop over all slices in the dimension
-		for (unsigned int sliceNumber = 0; sliceNumber < actualDimension->getNumberOfSlices(); sliceNumber++)
-		{
-			unsigned long long int accZoomSliceNumber =
-				dimSliceOffset +
-					static_cast<unsigned long long int>(sliceNumber) *
-						static_cast<unsigned long long int>(zoom_levels.size());
+	// units finish out of order, progress only advances over the completed prefix
+	// so that slices done stays monotonic and a resume never skips a unit
+	std::mutex progressMutex;
+	std::vector<bool> completed(units.size() - firstUnit, false);
+	unsigned long long int watermark = firstUnit;
 
-			// resume at a previously interrupted point
-			if (resumed && processing_strategy->isOnlineStrategy())
+	std::function<void ()> worker =
+		[&] ()
+		{
+			while (!abort)
 			{
-				if (pretiling_task->getSlicesDone() >= accZoomSliceNumber)
+				const unsigned long long int unit = nextUnit++;
+				if (unit >= units.size())
+					return;
+
+				try
 				{
-					zoomSliceOffset = accZoomSliceNumber;
-					accNumber = zoomSliceOffset;
-					continue;
+					if (!this->tileSlice(processing_strategy, pretiling_task, archives.get(), units[unit]))
+					{
+						abort = true;
+						return;
+					}
+				} catch (...)
+				{
+					std::lock_guard<std::mutex> lock(progressMutex);
+					if (!failure)
+						failure = std::current_exception();
+					abort = true;
+					return;
+				}
+
+				std::lock_guard<std::mutex> lock(progressMutex);
+				completed[unit - firstUnit] = true;
+
+				bool advanced = false;
+				while (watermark < units.size() && completed[watermark - firstUnit])
+				{
+					watermark++;
+					// a resumed slice may have been partially accounted for already
+					while (pretiling_task->getSlicesDone() < watermark * numberOfZoomLevels)
+						const_cast<tissuestack::services::TissueStackTilingTask *>(pretiling_task)->incrementSlicesDone();
+					advanced = true;
 				}
-				if (pretiling_task->getSlicesDone() >= accNumber)
-					resumed = false;
+				if (!advanced)
+					continue;
+
+				// persist for the online tiling
+				if (processing_strategy->isOnlineStrategy())
+					tissuestack::services::TissueStackTaskQueue::instance()->persistTaskProgress(
+							pretiling_task->getId());
+				else
+					std::cout << "Progress:\t" <<
+						std::to_string(pretiling_task->getSlicesDone()) << "\t["
+						<< std::to_string(pretiling_task->getTotalSlices()) << "]\t => "
+						<< std::to_string(pretiling_task->getProgress()) << "%\r" << std::flush;
 			}
+		};
 
-			// shutdown/cancellation check
-			if (this->hasBeenCancelledOrShutDown(processing_strategy, pretiling_task))
-				return;
+	std::vector<std::thread> workers;
+	for (unsigned short i=1;i<numberOfThreads;i++)
+		workers.push_back(std::thread(worker));
+	worker();
+	for (auto & w : workers)
+		w.join();
+
+	if (failure)
+		std::rethrow_exception(failure);
+}
 
-			Image * img =
-				this->_extractor->extractImageForPreTiling(
-					static_cast<const tissuestack::imaging::TissueStackRawData *>(pretiling_task->getInputImageData()),
-					actualDimension,
-					sliceNumber);
+inline const bool tissuestack::imaging::PreTiler::tileSlice(
+		const tissuestack::common::ProcessingStrategy * processing_strategy,
+		const tissuestack::services::TissueStackTilingTask * pretiling_task,
+		TileArchives * archives,
+		const TilingUnit & unit) const
+{
+	// shutdown/cancellation check
+	if (this->hasBeenCancelledOrShutDown(processing_strategy, pretiling_task))
+		return false;
+
+	const tissuestack::imaging::TissueStackDataDimension * actualDimension = unit.dimension;
+	const unsigned int sliceNumber = unit.slice_number;
+	const std::vector<float> scaleFactors = pretiling_task->getInputImageData()->getZoomLevels();
+
+	// every unit reads its own slice: graphics magick images are not to be shared across threads
+	Image * img =
+		this->_extractor->extractImageForPreTiling(
+			static_cast<const tissuestack::imaging::TissueStackRawData *>(pretiling_task->getInputImageData()),
+			actualDimension,
+			sliceNumber);
+	if (img == NULL)
+		return true;
 
+	// color map the full resolution slice once, all zoom levels are derived from it
+	const unsigned long int fullWidth = actualDimension->getAnisotropicWidth();
+	const unsigned long int fullHeight = actualDimension->getAnisotropicHeight();
+	unsigned long int width = fullWidth;
+	unsigned long int height = fullHeight;
+	Image * fullResolution =
+		this->_extractor->applyPreTilingProcessing(
+			img,
+			pretiling_task->getColorMap(),
+			width,
+			height,
+			1.0);
+
+	// build the pyramid from the largest zoom level down
+	std::vector<unsigned short> zoom_levels = pretiling_task->getZoomLevels();
+	std::sort(zoom_levels.begin(), zoom_levels.end(),
+		[&scaleFactors] (const unsigned short a, const unsigned short b)
+		{
+			return scaleFactors[a] > scaleFactors[b];
+		});
+
+	// the previous (larger) level for minification, or the full resolution image
+	Image * previousLevel = nullptr;
+	try
+	{
+		for (auto zoom : zoom_levels)
+		{
 			// shutdown/cancellation check
 			if (this->hasBeenCancelledOrShutDown(processing_strategy, pretiling_task))
 			{
-				DestroyImage(img);
-				return;
+				if (previousLevel) DestroyImage(previousLevel);
+				DestroyImage(fullResolution);
+				return false;
 			}
 
-			if (img)
+			// same dimensions as scaling the full resolution slice directly
+			const float scaleFactor = scaleFactors[zoom];
+			width = static_cast<unsigned int>(static_cast<const float>(fullWidth) * scaleFactor);
+			if (width < 1)
+				width = 1;
+			height = static_cast<unsigned int>(static_cast<const float>(fullHeight) * scaleFactor);
+			if (height < 1)
+				height = 1;
+
+			// magnified levels are sampled from the full resolution,
+			// minified ones are area averaged from the next larger level
+			const Image * source =
+				(scaleFactor < 1.0 && previousLevel != nullptr) ? previousLevel : fullResolution;
+			Image * level =
+				this->_extractor->resizeForPreTiling(source, width, height);
+			if (scaleFactor <= 1.0)
 			{
-				// now loop over all zoom levels
-				for (auto zoom : zoom_levels)
-				{
-					// resume at a previously interrupted point
-					if (resumed && processing_strategy->isOnlineStrategy())
-					{
-						if (pretiling_task->getSlicesDone() >= accNumber)
-						{
-							++accNumber;
-							continue;
-						}
-						resumed = false;
-					}
-
-					// check/create tile sub directory
-					const std::string subDir =
-							pretiling_task->getTileDir() + "/" + std::to_string(zoom) +
-							"/" + dim.substr(0,1) + "/" + std::to_string(sliceNumber);
+				if (previousLevel) DestroyImage(previousLevel);
+				previousLevel = level;
+			}
 
-					if (!tissuestack::utils::System::directoryExists(subDir) &&
-						!tissuestack::utils::System::createDirectory(subDir, 0755))
-					{
-						DestroyImage(img);
-							THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-								"Could not create tiling sub directory!");
-					}
+			this->tileZoomLevel(pretiling_task, archives, level, sliceNumber, unit.dimension_name, zoom, width, height);
 
-					// apply zoom and colormap if necessary
-					unsigned long int width = actualDimension->getAnisotropicWidth();
-					unsigned long int height = actualDimension->getAnisotropicHeight();
+			if (level != previousLevel)
+				DestroyImage(level);
+		}
+	} catch (...)
+	{
+		if (previousLevel) DestroyImage(previousLevel);
+		DestroyImage(fullResolution);
+		throw;
+	}
 
-					ExceptionInfo exception;
-					GetExceptionInfo(&exception);
-					Image * img_processed =
-						CloneImage(img, 0, 0, 1, &exception);
-					if (img_processed == NULL)
-					{
-						DestroyImage(img);
-							THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-								"Could not clone image for processsing!");
-					}
+	if (previousLevel) DestroyImage(previousLevel);
+	DestroyImage(fullResolution);
 
-					img_processed =
-						this->_extractor->applyPreTilingProcessing(
-							img_processed,
-							pretiling_task->getColorMap(),
-							width,
-							height,
-							pretiling_task->getInputImageData()->getZoomLevels()[zoom]
-					);
-
-					// shutdown/cancellation check
-					if (this->hasBeenCancelledOrShutDown(processing_strategy, pretiling_task))
-					{
-						DestroyImage(img);
-						DestroyImage(img_processed);
-						return;
-					}
+	return !this->hasBeenCancelledOrShutDown(processing_strategy, pretiling_task);
+}
 
-					// chop up into tiles first
-					// the x/y loop
-					unsigned int upperBoundX =
-							(width %
-									pretiling_task->getSquareLength() == 0) ?
-							(width / pretiling_task->getSquareLength()) :
-						ceil(
-							static_cast<double>(width) /
-							static_cast<double>(pretiling_task->getSquareLength()));
-					unsigned int upperBoundY =
-							(height %
-									pretiling_task->getSquareLength() == 0) ?
-							(height / pretiling_task->getSquareLength()) :
-						ceil(
-							static_cast<double>(height) /
-							static_cast<double>(pretiling_task->getSquareLength()));
-
-					for (unsigned int x=0; x<upperBoundX;x++)
-					{
-						for (unsigned int y=0; y<upperBoundY;y++)
-						{
-							Image * tile =
-								this->_extractor->getImageTileForPreTiling(
-									img_processed, x, y, pretiling_task->getSquareLength());
-							if (tile)
-							{
-								this->writeImageToFile(
-									tile,
-									subDir,
-									sliceNumber,
-									pretiling_task->getColorMap(),
-									false,
-									pretiling_task->getImageFormat(),
-									x,
-									y
-								);
-							}
-						}
-					}
+inline void tissuestack::imaging::PreTiler::tileZoomLevel(
+		const tissuestack::services::TissueStackTilingTask * pretiling_task,
+		TileArchives * archives,
+		const Image * img,
+		const unsigned int sliceNumber,
+		const std::string & dimension_name,
+		const unsigned short zoom,
+		const unsigned long int width,
+		const unsigned long int height) const
+{
+	TissueStackTileArchive * archive = nullptr;
+	std::string subDir = "";
+	if (archives)
+		archive =
+			this->findOrOpenArchive(
+				archives,
+				tissuestack::imaging::TissueStackTileArchive::composeArchivePath(
+					pretiling_task->getTileDir(),
+					zoom,
+					dimension_name,
+					pretiling_task->getColorMap(),
+					pretiling_task->getImageFormat()));
+	else
+	{
+		// check/create tile sub directory
+		subDir =
+			pretiling_task->getTileDir() + "/" + std::to_string(zoom) +
+			"/" + dimension_name.substr(0,1) + "/" + std::to_string(sliceNumber);
 
-					// shutdown/cancellation check
-					if (this->hasBeenCancelledOrShutDown(processing_strategy, pretiling_task))
-					{
-						DestroyImage(img);
-						DestroyImage(img_processed);
-						return;
-					}
+		if (!tissuestack::utils::System::directoryExists(subDir) &&
+			!tissuestack::utils::System::createDirectory(subDir, 0755))
+				THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+					"Could not create tiling sub directory!");
+	}
 
-					// generate preview last
-					img_processed =
-						this->_extractor->degradeImage(
-							img_processed,
-							width,
-							height,
-							0.05);
-					this->writeImageToFile(
-						img_processed,
-						subDir,
-						sliceNumber,
-						pretiling_task->getColorMap(),
-						true,
-						pretiling_task->getImageFormat()
-					);
-
-					// now increment slice progress
-					if (!this->hasBeenCancelledOrShutDown(processing_strategy, pretiling_task))
-					{
-						const bool finished =
-							const_cast<tissuestack::services::TissueStackTilingTask *>(pretiling_task)->incrementSlicesDone();
-
-						// persist for the online tiling
-						if (processing_strategy->isOnlineStrategy())
-							tissuestack::services::TissueStackTaskQueue::instance()->persistTaskProgress(
-									pretiling_task->getId());
-						else
-							std::cout << "Progress:\t" <<
-								std::to_string(pretiling_task->getSlicesDone()) << "\t["
-								<< std::to_string(pretiling_task->getTotalSlices()) << "]\t => "
-								<< std::to_string(pretiling_task->getProgress()) << "%\r" << std::flush;
-
-						if (finished)
-						{
-							if (img) DestroyImage(img);
-							return;
-						}
-					} else
-					{
-						if (img) DestroyImage(img);
-						return;
-					}
-				}
+	// chop up into tiles first
+	// the x/y loop
+	unsigned int upperBoundX =
+			(width %
+					pretiling_task->getSquareLength() == 0) ?
+			(width / pretiling_task->getSquareLength()) :
+		ceil(
+			static_cast<double>(width) /
+			static_cast<double>(pretiling_task->getSquareLength()));
+	unsigned int upperBoundY =
+			(height %
+					pretiling_task->getSquareLength() == 0) ?
+			(height / pretiling_task->getSquareLength()) :
+		ceil(
+			static_cast<double>(height) /
+			static_cast<double>(pretiling_task->getSquareLength()));
+
+	for (unsigned int x=0; x<upperBoundX;x++)
+	{
+		for (unsigned int y=0; y<upperBoundY;y++)
+		{
+			Image * tile =
+				this->_extractor->getImageTileForPreTiling(
+					const_cast<Image *>(img), x, y, pretiling_task->getSquareLength());
+			if (tile && archive)
+				this->writeImageToArchive(
+					tile,
+					archive,
+					sliceNumber,
+					pretiling_task->getImageFormat(),
+					x,
+					y);
+			else if (tile)
+			{
+				this->writeImageToFile(
+					tile,
+					subDir,
+					sliceNumber,
+					pretiling_task->getColorMap(),
+					false,
+					pretiling_task->getImageFormat(),
+					x,
+					y
+				);
 			}
-			if (img) DestroyImage(img);
 		}
-
 	}
+
+	// generate preview last, the level itself is kept for the next smaller one
+	Image * preview =
+		this->_extractor->degradeImage(
+			this->_extractor->resizeForPreTiling(img, width, height),
+			width,
+			height,
+			0.05);
+	if (archive)
+		this->writeImageToArchive(
+			preview,
+			archive,
+			sliceNumber,
+			pretiling_task->getImageFormat(),
+			tissuestack::imaging::TissueStackTileArchive::PREVIEW,
+			tissuestack::imaging::TissueStackTileArchive::PREVIEW);
+	else
+		this->writeImageToFile(
+			preview,
+			subDir,
+			sliceNumber,
+			pretiling_task->getColorMap(),
+			true,
+			pretiling_task->getImageFormat()
+		);
 }
 
 inline void tissuestack::imaging::PreTiler::writeImageToFile(
@@ -429,6 +520,82 @@ inline void tissuestack::imaging::PreTiler::writeImageToFile(
 	if (imgInfo) DestroyImageInfo(imgInfo);
 }
 
+inline tissuestack::imaging::TissueStackTileArchive * tissuestack::imaging::PreTiler::findOrOpenArchive(
+	TileArchives * archives,
+	const std::string & archive_path) const
+{
+	std::lock_guard<std::mutex> lock(archives->mutex);
+
+	auto existing = archives->archives.find(archive_path);
+	if (existing != archives->archives.end())
+		return existing->second.get();
+
+	const std::string zoomDir = archive_path.substr(0, archive_path.find_last_of('/'));
+	if (!tissuestack::utils::System::directoryExists(zoomDir) &&
+		!tissuestack::utils::System::createDirectory(zoomDir, 0755))
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Could not create tiling sub directory!");
+
+	// appending to an existing archive is fine: re-tiled images supersede the old ones
+	tissuestack::imaging::TissueStackTileArchive * archive =
+		new tissuestack::imaging::TissueStackTileArchive(archive_path, true, archives->square_length);
+	archives->archives[archive_path].reset(archive);
+
+	return archive;
+}
+
+inline void tissuestack::imaging::PreTiler::writeImageToArchive(
+	Image * img,
+	TissueStackTileArchive * archive,
+	const unsigned int slice_number,
+	const std::string & format,
+	const unsigned int x,
+	const unsigned int y) const
+{
+	if (img == NULL) return;
+
+	ImageInfo	*imgInfo = CloneImageInfo((ImageInfo *)NULL);
+	if (imgInfo == NULL)
+	{
+		DestroyImage(img);
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Could not create ImageInfo!");
+	}
+
+	std::string formatLowerCase =  format;
+	std::transform(formatLowerCase.begin(), formatLowerCase.end(), formatLowerCase.begin(), tolower);
+	strcpy(img->magick, formatLowerCase.c_str());
+	strcpy(imgInfo->magick, formatLowerCase.c_str());
+
+	size_t length = 0;
+	unsigned char * memImg =
+		static_cast<unsigned char *>(ImageToBlob(imgInfo, img, &length, &img->exception));
+	if (length==0)
+	{
+		CatchException(&img->exception);
+		tissuestack::logging::TissueStackLogger::instance()->error(
+				"Failed to encode image: %s\n", img->exception.reason);
+	}
+	DestroyImage(img);
+	DestroyImageInfo(imgInfo);
+
+	if (length==0)
+	{
+		if (memImg) free(memImg);
+		return;
+	}
+
+	try
+	{
+		archive->appendTile(slice_number, x, y, memImg, length);
+	} catch (...)
+	{
+		free(memImg);
+		throw;
+	}
+	free(memImg);
+}
+
 inline const bool tissuestack::imaging::PreTiler::hasBeenCancelledOrShutDown(
 	const tissuestack::common::ProcessingStrategy * processing_strategy,
 	const tissuestack::services::TissueStackTilingTask * pretiling_task) const
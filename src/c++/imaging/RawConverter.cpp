@@ -20,6 +20,20 @@
 
 tissuestack::imaging::RawConverter::RawConverter(){}
 
+tissuestack::imaging::RawConverter::~RawConverter()
+{
+	this->closeOutFile();
+}
+
+inline void tissuestack::imaging::RawConverter::closeOutFile()
+{
+	if (this->_file_descriptor < 0)
+		return;
+
+	close(this->_file_descriptor);
+	this->_file_descriptor = -1;
+}
+
 void tissuestack::imaging::RawConverter::convert(
 	const tissuestack::common::ProcessingStrategy * processing_strategy,
 	const tissuestack::services::TissueStackConversionTask * converter_task,
@@ -36,7 +50,7 @@ void tissuestack::imaging::RawConverter::convert(
 		if (processing_strategy->isOnlineStrategy() && !converter_task->hasBeenUnzipped()) // zip data will need to processed now!
 		{
 		   const_cast<tissuestack::services::TissueStackConversionTask *>(converter_task)->lazyLoadZipData();
-		   tissuestack::services::TissueStackTaskQueue::instance()->persistTaskProgress(
+		   tissuestack::services::TissueStackTaskQueue::instance()->persistTask(
 				  converter_task->getId());
 		}
 		const std::string fileName =
@@ -59,13 +73,15 @@ void tissuestack::imaging::RawConverter::convert(
 		}
 
 		// open our out file for writing and perform some basic checks
+		// (the offline executor converts one dimension after the other with the same instance)
+		this->closeOutFile();
 		if ((!processing_strategy->isOnlineStrategy() && dimension.empty()) || // offline (not multi processed)
 				(processing_strategy->isOnlineStrategy() && converter_task->getSlicesDone() == 0)) // online (not resume)
 			this->_file_descriptor = open(outFile.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
 		else
 			this->_file_descriptor = open(outFile.c_str(), O_RDWR);
 
-		if (this->_file_descriptor <= 0)
+		if (this->_file_descriptor < 0)
 			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 				"Could not open out file for RAW conversion!");
 
@@ -96,18 +112,10 @@ void tissuestack::imaging::RawConverter::convert(
 			return;
 		}
 
-		// in the case of an offline multi-process we have to fast-forward to the desired offset
-		if (!processing_strategy->isOnlineStrategy() && !dimension.empty())
-		{
-			lseek(this->_file_descriptor,
-				converter_task->getInputImageData()->getDimensionByLongName(dimension)->getOffset(),
-				SEEK_SET);
-		}
-
 		// shutdown/cancellation check
 		if (this->hasBeenCancelledOrShutDown(processing_strategy, converter_task))
 		{
-			close(this->_file_descriptor);
+			this->closeOutFile();
 			if (processing_strategy->isOnlineStrategy())
 				ptr_converter_task.release();
 
@@ -123,6 +131,20 @@ void tissuestack::imaging::RawConverter::convert(
 		else if (dimension.empty())
 			std::cout << "Starting Conversion: " << fileName << " => " << outFile << std::endl;
 
+		// determine the global min/max of a nifti up front and keep them in the task file for a resume
+		if (converter_task->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::NIFTI)
+		{
+			const tissuestack::imaging::TissueStackNiftiData * nifti =
+				static_cast<const tissuestack::imaging::TissueStackNiftiData *>(converter_task->getInputImageData());
+			if (!nifti->hasGlobalMinMax())
+			{
+				nifti->getMin();
+				if (processing_strategy->isOnlineStrategy())
+					tissuestack::services::TissueStackTaskQueue::instance()->persistTask(
+						converter_task->getId());
+			}
+		}
+
 		// FORMAT CONVERSION
 		if (converter_task->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::DICOM) // DICOM CONVERSION
 			this->convertDicom(processing_strategy, converter_task, resumed);
@@ -137,7 +159,7 @@ void tissuestack::imaging::RawConverter::convert(
 			else
 			{
 				const_cast<tissuestack::common::ProcessingStrategy *>(processing_strategy)->stop();
-				close(this->_file_descriptor);
+				this->closeOutFile();
 				// we erase our partial work !
 				unlink(converter_task->getOutFile().c_str());
 			}
@@ -145,6 +167,9 @@ void tissuestack::imaging::RawConverter::convert(
 			return;
 		}
 
+		// done writing before the finished raw file is handed on
+		this->closeOutFile();
+
 		if (processing_strategy->isOnlineStrategy())
 		{
 			tissuestack::services::TissueStackTaskQueue::instance()->flagTaskAsFinished(
@@ -164,7 +189,7 @@ void tissuestack::imaging::RawConverter::convert(
 			converter_task->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::DICOM)
 			static_cast<const tissuestack::imaging::TissueStackDicomData *>(converter_task->getInputImageData())->deregisterDcmtkDecoders();
 
-		close(this->_file_descriptor);
+		this->closeOutFile();
 		// we erase our partial work !
 		unlink(converter_task->getOutFile().c_str());
 
@@ -186,14 +211,11 @@ void tissuestack::imaging::RawConverter::convert(
 	}
 }
 
-inline void tissuestack::imaging::RawConverter::reconstructSliceFromDicom(
+inline void tissuestack::imaging::RawConverter::reconstructSlicesFromDicom(
 		const tissuestack::common::ProcessingStrategy * processing_strategy,
 		const tissuestack::services::TissueStackConversionTask * converter_task,
-		const unsigned int dicom_index,
-		const unsigned long int dicom_width,
-		const unsigned long int dicom_height,
-		const unsigned long int dicom_slices,
-		const unsigned char * dicom_data) const
+		const DicomSlab & slab,
+		const unsigned long int dicom_slices) const
 {
 	tissuestack::imaging::TissueStackDicomData * dicomData =
 		const_cast<tissuestack::imaging::TissueStackDicomData *>(
@@ -217,100 +239,195 @@ inline void tissuestack::imaging::RawConverter::reconstructSliceFromDicom(
 	const tissuestack::imaging::TissueStackDataDimension * y_dim =
 		dicomData->getDimension(ydim);
 
-	for (unsigned long long int h=0;h<dicom_height;h++)
+	// every dicom image is a column in each slice of the other two planes. for the images of the slab
+	// these columns form a band of adjacent pixels per row which becomes a single write,
+	// or a single write for the whole slice if the slab holds all images
+	const unsigned long long int imageSize = slab.width * slab.height * 3;
+	const unsigned long long int bandRowLength = slab.number_of_images * 3;
+	const unsigned long long int rowLength = dicom_slices * 3;
+	const bool rowsAreContiguous = bandRowLength == rowLength;
+
+	// x plane: slice w, row h
+	std::vector<unsigned char> band(slab.height * bandRowLength);
+	for (unsigned long long int w=0;w<slab.width;w++)
 	{
-		if (this->hasBeenCancelledOrShutDown(processing_strategy, converter_task))
+		if (this->isCancelledOrShutDown(processing_strategy, converter_task))
+			return;
+
+		for (unsigned long long int h=0;h<slab.height;h++)
+			for (unsigned int i=0;i<slab.number_of_images;i++)
+				memcpy(&band[h * bandRowLength + i * 3], &slab.data[i * imageSize + h * slab.width * 3 + w * 3], 3);
+
+		const unsigned long long int sliceOffset =
+			x_dim->getOffset() + w * x_dim->getSliceSize() * 3 + slab.first_index * 3;
+		if (rowsAreContiguous)
+			this->writeSlice(band.data(), band.size(), sliceOffset);
+		else
+			for (unsigned long long int h=0;h<slab.height;h++)
+				this->writeSlice(&band[h * bandRowLength], bandRowLength, sliceOffset + h * rowLength);
+	}
+
+	// y plane: slice (height - (h + 1)), row w
+	band.resize(slab.width * bandRowLength);
+	for (unsigned long long int h=0;h<slab.height;h++)
+	{
+		if (this->isCancelledOrShutDown(processing_strategy, converter_task))
 			return;
 
-		for (unsigned long long int w=0;w<dicom_width;w++)
+		for (unsigned long long int w=0;w<slab.width;w++)
+			for (unsigned int i=0;i<slab.number_of_images;i++)
+				memcpy(&band[w * bandRowLength + i * 3], &slab.data[i * imageSize + h * slab.width * 3 + w * 3], 3);
+
+		const unsigned long long int sliceOffset =
+			y_dim->getOffset() + (slab.height - (h + 1)) * y_dim->getSliceSize() * 3 + slab.first_index * 3;
+		if (rowsAreContiguous)
+			this->writeSlice(band.data(), band.size(), sliceOffset);
+		else
+			for (unsigned long long int w=0;w<slab.width;w++)
+				this->writeSlice(&band[w * bandRowLength], bandRowLength, sliceOffset + w * rowLength);
+	}
+}
+
+inline const tissuestack::imaging::DicomFileWrapper * tissuestack::imaging::RawConverter::findDicom(
+		const tissuestack::imaging::TissueStackDicomData * dicom_data,
+		const unsigned int dicom_index) const
+{
+	const tissuestack::imaging::DicomFileWrapper * dicom =
+		dicom_data->getDicomFileWrapper(
+			dicom_data->getPlanarOrientation() == tissuestack::imaging::DICOM_PLANAR_ORIENTATION::AXIAL ?
+				(dicom_data->getTotalNumberOfDicomFiles()-1) - dicom_index : dicom_index);
+	if (dicom == nullptr)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackNullPointerException,
+			"requested dicom file is null");
+
+	return dicom;
+}
+
+inline void tissuestack::imaging::RawConverter::decodeDicomImages(
+		const tissuestack::common::ProcessingStrategy * processing_strategy,
+		const tissuestack::services::TissueStackConversionTask * converter_task,
+		const unsigned int first_index,
+		const unsigned int number_of_images,
+		const unsigned short number_of_threads,
+		DecodedDicomImages & images) const
+{
+	const tissuestack::imaging::TissueStackDicomData * dicomData =
+		static_cast<const tissuestack::imaging::TissueStackDicomData *>(converter_task->getInputImageData());
+
+	images.clear();
+	images.resize(number_of_images);
+
+	unsigned short numberOfThreads = number_of_threads;
+	if (numberOfThreads > number_of_images)
+		numberOfThreads = number_of_images;
+
+	// every file has its own parsed data set, the images are decoded independently
+	// and land in their slot so that they can be written in order
+	std::atomic<unsigned int> nextImage(0);
+	std::atomic<bool> abort(false);
+	std::exception_ptr failure = nullptr;
+	std::mutex failureMutex;
+
+	std::function<void ()> worker =
+		[&] ()
 		{
-			const unsigned long long int dicomOffset =
-				h * dicom_width * 3 + w * 3;
-			const unsigned long long int xPlaneOffset =
-				x_dim->getOffset() + w * x_dim->getSliceSize() * 3 +
-					h * dicom_slices * 3 + dicom_index * 3;
-			const unsigned long long int yPlaneOffset =
-				y_dim->getOffset() + (dicom_height - (h + 1)) * y_dim->getSliceSize() * 3 +
-					w * dicom_slices * 3 + dicom_index * 3;
-
-			lseek(this->_file_descriptor, xPlaneOffset, SEEK_SET);
-			ssize_t bytesWritten =
-				write(this->_file_descriptor, &dicom_data[dicomOffset], 3);
-			if (bytesWritten != 3)
-			{
-				delete [] dicom_data;
-				THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-					"Dicom Conversion: written bytes do not match expected bytes!");
-			}
-			lseek(this->_file_descriptor, yPlaneOffset, SEEK_SET);
-			bytesWritten =
-				write(this->_file_descriptor, &dicom_data[dicomOffset], 3);
-			if (bytesWritten != 3)
+			while (!abort)
 			{
-				delete [] dicom_data;
-				THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-					"Dicom Conversion: written bytes do not match expected bytes!");
+				const unsigned int image = nextImage++;
+				if (image >= number_of_images)
+					return;
+
+				// shutdown/cancellation check
+				if (this->isCancelledOrShutDown(processing_strategy, converter_task))
+				{
+					abort = true;
+					return;
+				}
+
+				try
+				{
+					images[image].reset(
+						const_cast<tissuestack::imaging::DicomFileWrapper *>(
+							this->findDicom(dicomData, first_index + image))->getData());
+				} catch (...)
+				{
+					std::lock_guard<std::mutex> lock(failureMutex);
+					if (!failure)
+						failure = std::current_exception();
+					abort = true;
+					return;
+				}
 			}
-		}
-	}
+		};
+
+	std::vector<std::thread> workers;
+	for (unsigned short i=1;i<numberOfThreads;i++)
+		workers.push_back(std::thread(worker));
+	worker();
+	for (auto & w : workers)
+		w.join();
+
+	if (failure)
+		std::rethrow_exception(failure);
 }
 
 inline const bool tissuestack::imaging::RawConverter::convertDicom0(
 		const tissuestack::common::ProcessingStrategy * processing_strategy,
 		const tissuestack::services::TissueStackConversionTask * converter_task,
 		const unsigned int dicom_index,
-		const char dicomDimension) const
+		const unsigned long long int offset,
+		const unsigned char * data_out,
+		DicomSlab * slab) const
 {
 	if (this->hasBeenCancelledOrShutDown(processing_strategy, converter_task))
 		return true; // a false positive which is later evaluated and recognized as a shutdown/cancelation
 
-	tissuestack::imaging::TissueStackDicomData * dicomData =
-		const_cast<tissuestack::imaging::TissueStackDicomData *>(
-			static_cast<const tissuestack::imaging::TissueStackDicomData *>(converter_task->getInputImageData()));
-
 	const tissuestack::imaging::DicomFileWrapper * dicom =
-		dicomData->getDicomFileWrapper(
-			dicomData->getPlanarOrientation() == tissuestack::imaging::DICOM_PLANAR_ORIENTATION::AXIAL ?
-				(dicomData->getTotalNumberOfDicomFiles()-1) - dicom_index : dicom_index);
-	if (dicom == nullptr)
-		THROW_TS_EXCEPTION(tissuestack::common::TissueStackNullPointerException,
-			"requested dicom file is null");
+		this->findDicom(
+			static_cast<const tissuestack::imaging::TissueStackDicomData *>(converter_task->getInputImageData()),
+			dicom_index);
 
 	const unsigned long long int new_size_per_slice =
 		dicom->getWidth() * dicom->getHeight() * 3;
 
-	const unsigned char * data_out =
-			const_cast<tissuestack::imaging::DicomFileWrapper *>(dicom)->getData();
 	//dicomData->writeDicomDataAsPng(const_cast<tissuestack::imaging::DicomFileWrapper *>(dicom));
 	if (data_out == nullptr)
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 			"Read of dicom file failed!");
 
-	ssize_t bytesWritten =
-		write(this->_file_descriptor, data_out, new_size_per_slice);
-	if (bytesWritten != static_cast<ssize_t>(new_size_per_slice))
+	this->writeSlice(data_out, new_size_per_slice, offset);
+
+	// the other planes of a reconstruction are written, and progress made, once the slab is complete
+	if (slab != nullptr)
 	{
-		delete [] data_out;
-		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-			"Dicom Conversion: written bytes do not match expected bytes!");
+		if (new_size_per_slice != slab->width * slab->height * 3)
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Dicom Conversion: images of a volume differ in size!");
+		// the images are laid out as the dicom has them
+		slab->width = dicom->getWidth();
+		slab->height = dicom->getHeight();
+		memcpy(
+			slab->data + (dicom_index - slab->first_index) * new_size_per_slice,
+			data_out,
+			new_size_per_slice);
+		return false;
 	}
 
-	if (dicomDimension != '\0')
-		tissuestack::imaging::RawConverter::reconstructSliceFromDicom(
-			processing_strategy, converter_task,
-			dicom_index,
-			dicom->getWidth(),
-			dicom->getHeight(),
-			dicomData->getDimension(dicomDimension)->getNumberOfSlices(),
-			data_out);
-	delete [] data_out;
-
 	if (this->hasBeenCancelledOrShutDown(processing_strategy, converter_task))
 		return true; // a false positive which is later evaluated and recognized as a shutdown/cancelation
 
+	return this->advanceProgress(processing_strategy, converter_task, 1);
+}
 
-	const bool finished =
-		const_cast<tissuestack::services::TissueStackConversionTask *>(converter_task)->incrementSlicesDone();
+inline const bool tissuestack::imaging::RawConverter::advanceProgress(
+		const tissuestack::common::ProcessingStrategy * processing_strategy,
+		const tissuestack::services::TissueStackConversionTask * converter_task,
+		const unsigned long long int slices) const
+{
+	bool finished = false;
+	for (unsigned long long int i=0;i<slices;i++)
+		finished =
+			const_cast<tissuestack::services::TissueStackConversionTask *>(converter_task)->incrementSlicesDone();
 
 	// persist for the online tiling
 	if (processing_strategy->isOnlineStrategy())
@@ -341,40 +458,56 @@ void tissuestack::imaging::RawConverter::convertDicom(
 
 	dicomData->registerDcmtkDecoders();
 
+	// the images are decoded concurrently, a window of a few images per thread at a time,
+	// and then written in order
+	unsigned short numberOfThreads =
+		static_cast<unsigned short>(
+			strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("conversion_threads").c_str(), NULL, 10));
+	if (numberOfThreads == 0)
+		numberOfThreads = tissuestack::utils::System::getNumberOfCores();
+	const unsigned long long int decodingWindow = numberOfThreads * 2;
+	DecodedDicomImages images;
+
 	if (dicomData->getType() == tissuestack::imaging::DICOM_TYPE::SINGLE_IMAGE) // SINGLE IMAGE
 	{
-		this->convertDicom0(processing_strategy, converter_task, 0);
+		this->decodeDicomImages(processing_strategy, converter_task, 0, 1, 1, images);
+		this->convertDicom0(processing_strategy, converter_task, 0, dicomData->getHeader().length(), images[0].get());
 		dicomData->deregisterDcmtkDecoders();
 	}
 	else if (dicomData->getType() == tissuestack::imaging::DICOM_TYPE::TIME_SERIES)
 	{
 		unsigned int ind=0;
 		if (processing_strategy->isOnlineStrategy() && resumed)
+			ind = converter_task->getSlicesDone(); // we resumed so, let's fast forward...
+
+		while (ind < dicomData->get2DDimension()->getNumberOfSlices())
 		{
-			// we resumed so, let's fast forward...
-			ind = converter_task->getSlicesDone();
-			unsigned long long int toBeContinuedAt =
-					dicomData->get2DDimension()->getOffset() +
-					dicomData->get2DDimension()->getSliceSize() * ind * 3;
-			lseek(this->_file_descriptor, toBeContinuedAt, SEEK_SET);
+			this->decodeDicomImages(
+				processing_strategy,
+				converter_task,
+				ind,
+				std::min<unsigned long long int>(decodingWindow, dicomData->get2DDimension()->getNumberOfSlices() - ind),
+				numberOfThreads,
+				images);
+
+			for (unsigned int i=0;i<images.size();i++,ind++)
+				if (this->convertDicom0(
+						processing_strategy,
+						converter_task,
+						ind,
+						dicomData->get2DDimension()->getOffset() +
+							dicomData->get2DDimension()->getSliceSize() * ind * 3,
+						images[i].get()))
+				{
+					dicomData->deregisterDcmtkDecoders();
+					return;
+				}
 		}
 
-		for (;ind < dicomData->get2DDimension()->getNumberOfSlices();ind++)
-			if (this->convertDicom0(processing_strategy, converter_task, ind))
-			{
-				dicomData->deregisterDcmtkDecoders();
-				return;
-			}
-
 
 	} else if (dicomData->getType() == tissuestack::imaging::DICOM_TYPE::VOLUME ||
 		dicomData->getType() == tissuestack::imaging::DICOM_TYPE::VOLUME_TO_BE_RECONSTRUCTED)
 	{
-		// TODO: assess memory usage of loading all slices into memory
-		// and build dimensions sequentially jumping memory locations
-		// rather than processing slice by slice and jumping file offsets
-		// we'd probably have to make this decision before deciding on the total number
-		// for the progress
 		unsigned short ind=0;
 		unsigned long int slice = converter_task->getSlicesDone();
 
@@ -420,29 +553,102 @@ void tissuestack::imaging::RawConverter::convertDicom(
 				resumed = false;
 			}
 
-			// TODO: do this using threads ...
-
-			for (;slice < dim->getNumberOfSlices();slice++)
+			if (dicomSliceDimension == '\0')
 			{
-				// make sure we are where we need to be
-				unsigned long long int toBeContinuedAt =
-					dim->getOffset() + dim->getSliceSize() * slice * 3;
-				lseek(this->_file_descriptor, toBeContinuedAt, SEEK_SET);
-
-				const bool finished =
-					this->convertDicom0(processing_strategy, converter_task, slice, dicomSliceDimension);
-
-				if (this->hasBeenCancelledOrShutDown(processing_strategy, converter_task))
-					return; // a false positive which is later evaluated and recognized as a shutdown/cancelation
-
-				if (finished && dicomSliceDimension != '\0')
-					this->reorientDicomSlices(dicomData);
+				while (slice < dim->getNumberOfSlices())
+				{
+					this->decodeDicomImages(
+						processing_strategy, converter_task, slice,
+						std::min<unsigned long long int>(decodingWindow, dim->getNumberOfSlices() - slice),
+						numberOfThreads, images);
+
+					for (unsigned int i=0;i<images.size();i++,slice++)
+					{
+						const bool finished =
+							this->convertDicom0(
+								processing_strategy, converter_task, slice,
+								dim->getOffset() + dim->getSliceSize() * slice * 3,
+								images[i].get());
+
+						if (this->hasBeenCancelledOrShutDown(processing_strategy, converter_task))
+							return; // a false positive which is later evaluated and recognized as a shutdown/cancelation
+
+						if (finished) {
+							dicomData->deregisterDcmtkDecoders();
+							return;
+						}
+					}
+				}
+				ind++;
+				continue;
+			}
 
-				if (finished) {
-					dicomData->deregisterDcmtkDecoders();
-					return;
+			// reconstruction: as many images per slab as the memory budget allows
+			DicomSlab slab;
+			slab.width = dim->getWidth();
+			slab.height = dim->getHeight();
+			const unsigned long long int imageSize = slab.width * slab.height * 3;
+			const unsigned long long int memoryBudget =
+				strtoull(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("conversion_memory_budget").c_str(), NULL, 10)
+					* 1024 * 1024;
+			unsigned long long int imagesPerSlab = imageSize == 0 ? 1 : memoryBudget / imageSize;
+			if (imagesPerSlab == 0)
+				imagesPerSlab = 1;
+			if (imagesPerSlab > dim->getNumberOfSlices())
+				imagesPerSlab = dim->getNumberOfSlices();
+			slab.data = new unsigned char[imagesPerSlab * imageSize];
+
+			try
+			{
+				while (slice < dim->getNumberOfSlices())
+				{
+					slab.first_index = slice;
+					slab.number_of_images =
+						(slice + imagesPerSlab > dim->getNumberOfSlices()) ?
+							dim->getNumberOfSlices() - slice : imagesPerSlab;
+
+					while (slice < slab.first_index + slab.number_of_images)
+					{
+						this->decodeDicomImages(
+							processing_strategy, converter_task, slice,
+							std::min<unsigned long long int>(decodingWindow, slab.first_index + slab.number_of_images - slice),
+							numberOfThreads, images);
+
+						for (unsigned int i=0;i<images.size();i++,slice++)
+							if (this->convertDicom0(
+									processing_strategy, converter_task, slice,
+									dim->getOffset() + dim->getSliceSize() * slice * 3,
+									images[i].get(),
+									&slab))
+							{
+								delete [] slab.data;
+								return; // a shutdown/cancelation
+							}
+					}
+
+					this->reconstructSlicesFromDicom(
+						processing_strategy, converter_task, slab, dim->getNumberOfSlices());
+
+					if (this->hasBeenCancelledOrShutDown(processing_strategy, converter_task))
+					{
+						delete [] slab.data;
+						return; // a false positive which is later evaluated and recognized as a shutdown/cancelation
+					}
+
+					if (this->advanceProgress(processing_strategy, converter_task, slab.number_of_images))
+					{
+						delete [] slab.data;
+						this->reorientDicomSlices(dicomData);
+						dicomData->deregisterDcmtkDecoders();
+						return;
+					}
 				}
+			} catch (...)
+			{
+				delete [] slab.data;
+				throw;
 			}
+			delete [] slab.data;
 			ind++;
 		}
 	}
@@ -454,26 +660,19 @@ inline void tissuestack::imaging::RawConverter::loopOverDimensions(
 		const std::string & dimension,
 		bool & resumed) const
 {
+	// 3D volumes are transposed in a single pass over the input if they can be
+	const unsigned long long int memoryBudget =
+		strtoull(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("conversion_memory_budget").c_str(), NULL, 10)
+			* 1024 * 1024;
+	if (memoryBudget > 0 && (processing_strategy->isOnlineStrategy() || dimension.empty()) &&
+			this->transposeVolume(processing_strategy, converter_task, memoryBudget, resumed))
+		return;
+
 	std::vector<std::string> dimensionsToBeConverted =
 			converter_task->getInputImageData()->getDimensionOrder();
 
-	unsigned long long int dimOffset = 0;
-	unsigned long long int accSliceNumber = 0;
-
-	mihandle_t volume = NULL;
-	if (converter_task->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::MINC)
-	{
-		int result =
-			miopen_volume(
-				converter_task->getInputImageData()->getFileName().c_str(),
-				MI2_OPEN_READ,
-				&volume);
-		if (result != MI_NOERROR)
-			THROW_TS_EXCEPTION(
-				tissuestack::common::TissueStackApplicationException,
-				"Failed to open supposed MINC file!");
-	}
-
+	// the units of work are (dimension, slice) in the order progress is counted in
+	std::vector<ConversionUnit> units;
 	unsigned short order = 0;
 	for (auto d : dimensionsToBeConverted) // the dimension loop
 	{
@@ -491,73 +690,369 @@ inline void tissuestack::imaging::RawConverter::loopOverDimensions(
 			continue;
 		}
 
-		accSliceNumber += dim->getNumberOfSlices();
+		for (unsigned long long int sliceNumber = 0; sliceNumber < dim->getNumberOfSlices(); sliceNumber++) // the slice loop
+			units.push_back({ dim, order, sliceNumber });
+		order++;
+	}
 
-		if (processing_strategy->isOnlineStrategy() && resumed &&
-			converter_task->getSlicesDone() >= accSliceNumber)
-		{
-			dimOffset = accSliceNumber;
-			order++;
-			continue;
-		}
+	// resume at a previously interrupted point: everything below slices done has been converted
+	const unsigned long long int firstUnit =
+		(resumed && processing_strategy->isOnlineStrategy()) ? converter_task->getSlicesDone() : 0;
+	resumed = false;
+	if (firstUnit >= units.size())
+		return;
 
+	mihandle_t volume = NULL;
+	if (converter_task->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::MINC)
+	{
+		int result =
+			miopen_volume(
+				converter_task->getInputImageData()->getFileName().c_str(),
+				MI2_OPEN_READ,
+				&volume);
+		if (result != MI_NOERROR)
+			THROW_TS_EXCEPTION(
+				tissuestack::common::TissueStackApplicationException,
+				"Failed to open supposed MINC file!");
+	}
 
-		unsigned long long int accNumber = dimOffset;
-		for (unsigned long long int sliceNumber = 0; sliceNumber < dim->getNumberOfSlices(); sliceNumber++) // the slice loop
+	unsigned short numberOfThreads =
+		static_cast<unsigned short>(
+			strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("conversion_threads").c_str(), NULL, 10));
+	if (numberOfThreads == 0)
+		numberOfThreads = tissuestack::utils::System::getNumberOfCores();
+	if (numberOfThreads > units.size() - firstUnit)
+		numberOfThreads = units.size() - firstUnit;
+
+	std::atomic<unsigned long long int> nextUnit(firstUnit);
+	std::atomic<bool> abort(false);
+	std::exception_ptr failure = nullptr;
+	std::mutex readMutex; // the minc library is not thread-safe
+
+	// slices finish out of order, progress only advances over the completed prefix
+	// so that slices done stays monotonic and a resume never skips a slice
+	std::mutex progressMutex;
+	std::vector<bool> completed(units.size() - firstUnit, false);
+	unsigned long long int watermark = firstUnit;
+
+	std::function<void ()> worker =
+		[&] ()
 		{
-			// resume at a previously interrupted point
-			if (resumed && processing_strategy->isOnlineStrategy())
+			while (!abort)
 			{
-				if (converter_task->getSlicesDone() >= accNumber)
+				const unsigned long long int unit = nextUnit++;
+				if (unit >= units.size())
+					return;
+
+				// shutdown/cancellation check
+				if (this->isCancelledOrShutDown(processing_strategy, converter_task))
+				{
+					abort = true;
+					return;
+				}
+
+				// every slice has its fixed place in the raw file
+				const ConversionUnit & u = units[unit];
+				const unsigned long long int offset =
+					u.dimension->getOffset() + u.slice_number * u.dimension->getSliceSize() * 3;
+
+				try
+				{
+					// delegate to format specific conversion per slice
+					if (converter_task->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::MINC)
+						this->convertSlice(
+							static_cast<const tissuestack::imaging::TissueStackMincData *>(
+								converter_task->getInputImageData()),
+								volume,
+								readMutex,
+								u.slice_number,
+								u.order,
+								offset);
+					else if (converter_task->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::NIFTI)
+						this->convertSlice(
+							static_cast<const tissuestack::imaging::TissueStackNiftiData *>(
+								converter_task->getInputImageData()),
+								u.slice_number,
+								u.order,
+								offset);
+					else
+						THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+							"Image Format is not suitable for RAW conversion!");
+				} catch (...)
+				{
+					std::lock_guard<std::mutex> lock(progressMutex);
+					if (!failure)
+						failure = std::current_exception();
+					abort = true;
+					return;
+				}
+
+				std::lock_guard<std::mutex> lock(progressMutex);
+				completed[unit - firstUnit] = true;
+
+				bool advanced = false;
+				while (watermark < units.size() && completed[watermark - firstUnit])
 				{
-					++accNumber;
+					// increment slice progress
+					const_cast<tissuestack::services::TissueStackConversionTask *>(converter_task)->incrementSlicesDone();
+					watermark++;
+					advanced = true;
+				}
+				if (!advanced)
 					continue;
+
+				// persist for the online conversion
+				if (processing_strategy->isOnlineStrategy())
+					tissuestack::services::TissueStackTaskQueue::instance()->persistTaskProgress(
+						converter_task->getId());
+				else
+				{
+					const std::string output =
+						std::string("Progress:\t") +
+						std::to_string(converter_task->getSlicesDone()) + "\t[" +
+						std::to_string(converter_task->getTotalSlices()) + "]\t => " +
+						std::to_string(converter_task->getProgress()) + "%\r";
+					std::cout << output << std::flush;
 				}
-				// fast forward file position
-				unsigned long long int toBeContinuedAt =
-					dim->getOffset() + sliceNumber * dim->getSliceSize() * 3;
-				lseek(this->_file_descriptor, toBeContinuedAt, SEEK_SET);
-				resumed = false;
 			}
+		};
 
-			// delegate to format specific conversion per slice
-			if (converter_task->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::MINC)
-				this->convertSlice(
-					static_cast<const tissuestack::imaging::TissueStackMincData *>(
-						converter_task->getInputImageData()),
-						volume,
-						sliceNumber,
-						order);
-			else if (converter_task->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::NIFTI)
-				this->convertSlice(
-					static_cast<const tissuestack::imaging::TissueStackNiftiData *>(
-						converter_task->getInputImageData()),
-						sliceNumber,
-						order);
-			else
-				THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-					"Image Format is not suitable for RAW conversion!");
+	std::vector<std::thread> workers;
+	for (unsigned short i=1;i<numberOfThreads;i++)
+		workers.push_back(std::thread(worker));
+	worker();
+	for (auto & w : workers)
+		w.join();
+
+	if (volume) miclose_volume(volume);
+
+	if (failure)
+		std::rethrow_exception(failure);
+}
+
+inline const bool tissuestack::imaging::RawConverter::transposeVolume(
+		const tissuestack::common::ProcessingStrategy * processing_strategy,
+		const tissuestack::services::TissueStackConversionTask * converter_task,
+		const unsigned long long int memory_budget,
+		bool & resumed) const
+{
+	const tissuestack::imaging::TissueStackImageData * image = converter_task->getInputImageData();
+
+	// only grey scale 3D data qualifies, anything else is converted slice by slice
+	if (image->get2DDimension() != nullptr || image->getNumberOfDimensions() != 3)
+		return false;
+	const bool isMinc = image->getFormat() == tissuestack::imaging::FORMAT::MINC;
+	if ((isMinc && static_cast<const tissuestack::imaging::TissueStackMincData *>(image)->isColor()) ||
+		(!isMinc && static_cast<const tissuestack::imaging::TissueStackNiftiData *>(image)->isColor()))
+		return false;
+
+	const tissuestack::imaging::TissueStackDataDimension * dims[3];
+	unsigned long long int sizes[3];
+	for (unsigned short i=0;i<3;i++)
+	{
+		dims[i] = image->getDimensionByOrderIndex(i);
+		if (dims[i] == nullptr)
+			return false;
+		sizes[i] = dims[i]->getNumberOfSlices();
+	}
+
+	// the input is streamed in slabs along its slowest varying axis which is the
+	// first axis for minc and the last for nifti. within a slab slice the other two axes
+	// are laid out with these strides, which also gives us the order of the slices read
+	// by the slice wise conversion: the slab axis followed by the remaining in-plane axis
+	const unsigned short slabAxis = isMinc ? 0 : 2;
+	unsigned long long int strides[3];
+	if (isMinc)
+	{
+		strides[0] = 0;
+		strides[1] = sizes[2];
+		strides[2] = 1;
+	} else
+	{
+		strides[0] = 1;
+		strides[1] = sizes[0];
+		strides[2] = 0;
+	}
+	const unsigned long long int planeSize = dims[slabAxis]->getSliceSize();
+
+	// reorienting a slice is a fixed permutation of its pixels per dimension
+	std::vector<unsigned int> sourcePixels[3];
+	for (unsigned short i=0;i<3;i++)
+		if (!this->computeReorientation(image, dims[i], sourcePixels[i]))
+			return false;
+
+	unsigned long long int slabThickness = memory_budget / planeSize;
+	if (slabThickness == 0)
+		slabThickness = 1;
+	if (slabThickness > sizes[slabAxis])
+		slabThickness = sizes[slabAxis];
+
+	// progress is counted in slices of all dimensions and advances in proportion to the slabs done.
+	// a resume starts at the slab that covers the slices done, everything before it has been written
+	const unsigned long long int totalSlices = sizes[0] + sizes[1] + sizes[2];
+	unsigned long long int slabStart =
+		(resumed && processing_strategy->isOnlineStrategy()) ?
+			converter_task->getSlicesDone() * sizes[slabAxis] / totalSlices : 0;
+	resumed = false;
+
+	mihandle_t volume = NULL;
+	if (isMinc)
+	{
+		int result =
+			miopen_volume(
+				image->getFileName().c_str(),
+				MI2_OPEN_READ,
+				&volume);
+		if (result != MI_NOERROR)
+			THROW_TS_EXCEPTION(
+				tissuestack::common::TissueStackApplicationException,
+				"Failed to open supposed MINC file!");
+	}
+
+	unsigned short numberOfThreads =
+		static_cast<unsigned short>(
+			strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("conversion_threads").c_str(), NULL, 10));
+	if (numberOfThreads == 0)
+		numberOfThreads = tissuestack::utils::System::getNumberOfCores();
 
-			//if (converter_task->getInputImageData()->getNumberOfDimensions() == 2)
-			//	const_cast<tissuestack::services::TissueStackConversionTask *>(converter_task)->setSlicesDone(
-			//		converter_task->getTotalSlices()-1);
+	unsigned char * slab = new unsigned char[slabThickness * planeSize];
 
+	try
+	{
+		while (slabStart < sizes[slabAxis])
+		{
 			// shutdown/cancellation check
-			if (this->hasBeenCancelledOrShutDown(processing_strategy, converter_task))
+			if (this->isCancelledOrShutDown(processing_strategy, converter_task))
+				break;
+
+			const unsigned long long int slabEnd =
+				(slabStart + slabThickness > sizes[slabAxis]) ? sizes[slabAxis] : slabStart + slabThickness;
+			this->readSlab(image, volume, slabStart, slabEnd - slabStart, slab);
+
+			// the slab holds whole slices of the slab axis and a band of every slice of the other two.
+			// the band is the same for every slice of a dimension, so are the runs it is written in
+			SlabBand bands[3];
+			std::vector<ConversionUnit> units;
+			for (unsigned short d=0;d<3;d++)
 			{
-				if (volume) miclose_volume(volume);
-				return;
+				if (d == slabAxis)
+				{
+					for (unsigned long long int s=slabStart;s<slabEnd;s++)
+						units.push_back({ dims[d], d, s });
+					continue;
+				}
+
+				const unsigned long long int otherSize = sizes[3 - slabAxis - d];
+				for (unsigned long long int p=0;p<sourcePixels[d].size();p++)
+				{
+					const unsigned long long int slabCoordinate = sourcePixels[d][p] / otherSize;
+					if (slabCoordinate < slabStart || slabCoordinate >= slabEnd)
+						continue;
+
+					if (!bands[d].runs.empty() &&
+						bands[d].runs.back().pixel + bands[d].runs.back().length == p)
+						bands[d].runs.back().length++;
+					else
+						bands[d].runs.push_back({ bands[d].pixels.size(), p, 1 });
+					bands[d].pixels.push_back(static_cast<unsigned int>(p));
+				}
+				for (unsigned long long int s=0;s<sizes[d];s++)
+					units.push_back({ dims[d], d, s });
 			}
 
+			std::atomic<unsigned long long int> nextUnit(0);
+			std::atomic<bool> abort(false);
+			std::exception_ptr failure = nullptr;
+			std::mutex failureMutex;
+
+			std::function<void ()> worker =
+				[&] ()
+				{
+					std::vector<unsigned char> buffer;
+					while (!abort)
+					{
+						const unsigned long long int unit = nextUnit++;
+						if (unit >= units.size())
+							return;
+
+						if (this->isCancelledOrShutDown(processing_strategy, converter_task))
+						{
+							abort = true;
+							return;
+						}
+
+						const ConversionUnit & u = units[unit];
+						const unsigned long long int offset =
+							u.dimension->getOffset() + u.slice_number * u.dimension->getSliceSize() * 3;
+						const std::vector<unsigned int> & source = sourcePixels[u.order];
+
+						try
+						{
+							if (u.order == slabAxis)
+							{
+								// a complete slice, gathered in its reoriented order
+								const unsigned char * plane = slab + (u.slice_number - slabStart) * planeSize;
+								buffer.resize(source.size() * 3);
+								for (unsigned long long int p=0;p<source.size();p++)
+									buffer[p * 3 + 0] =
+										buffer[p * 3 + 1] =
+											buffer[p * 3 + 2] = plane[source[p]];
+								this->writeSlice(buffer.data(), buffer.size(), offset);
+								continue;
+							}
+
+							// the band of a slice of one of the other dimensions
+							const unsigned short otherAxis = 3 - slabAxis - u.order;
+							const SlabBand & band = bands[u.order];
+							buffer.resize(band.pixels.size() * 3);
+							for (unsigned long long int i=0;i<band.pixels.size();i++)
+							{
+								const unsigned long long int sourcePixel = source[band.pixels[i]];
+								const unsigned char value =
+									slab[
+										(sourcePixel / sizes[otherAxis] - slabStart) * planeSize +
+										u.slice_number * strides[u.order] +
+										(sourcePixel % sizes[otherAxis]) * strides[otherAxis]];
+								buffer[i * 3 + 0] = buffer[i * 3 + 1] = buffer[i * 3 + 2] = value;
+							}
+							for (auto & run : band.runs)
+								this->writeSlice(
+									buffer.data() + run.first * 3,
+									run.length * 3,
+									offset + run.pixel * 3);
+						} catch (...)
+						{
+							std::lock_guard<std::mutex> lock(failureMutex);
+							if (!failure)
+								failure = std::current_exception();
+							abort = true;
+							return;
+						}
+					}
+				};
+
+			std::vector<std::thread> workers;
+			for (unsigned short i=1;i<numberOfThreads && i<units.size();i++)
+				workers.push_back(std::thread(worker));
+			worker();
+			for (auto & w : workers)
+				w.join();
+
+			if (failure)
+				std::rethrow_exception(failure);
+			if (abort)
+				break;
+
 			// increment slice progress
-			const bool finished =
+			const unsigned long long int slicesDone = totalSlices * slabEnd / sizes[slabAxis];
+			while (converter_task->getSlicesDone() < slicesDone)
 				const_cast<tissuestack::services::TissueStackConversionTask *>(converter_task)->incrementSlicesDone();
 
-			// persist for the online tiling
+			// persist for the online conversion
 			if (processing_strategy->isOnlineStrategy())
 				tissuestack::services::TissueStackTaskQueue::instance()->persistTaskProgress(
 					converter_task->getId());
-			else if (!processing_strategy->isOnlineStrategy() && dimension.empty())
+			else
 			{
 				const std::string output =
 					std::string("Progress:\t") +
@@ -566,23 +1061,198 @@ inline void tissuestack::imaging::RawConverter::loopOverDimensions(
 					std::to_string(converter_task->getProgress()) + "%\r";
 				std::cout << output << std::flush;
 			}
-			else if (!processing_strategy->isOnlineStrategy() && !dimension.empty())
-			{
-				std::string output = "";
-				for (unsigned short pos=0;pos<order;pos++)
-					output += "\t\t\t";
-				output += (dim->getName() + ": ");
-				output += std::to_string(converter_task->getSlicesDone());
-				output += (" [" + std::to_string(dim->getNumberOfSlices()) + "]");
-				std::cout << output << "\r" << std::flush;
-			}
 
-			if (finished)
-				return;
+			slabStart = slabEnd;
 		}
-		order++;
+	} catch (...)
+	{
+		delete [] slab;
+		if (volume) miclose_volume(volume);
+		throw;
 	}
+
+	delete [] slab;
 	if (volume) miclose_volume(volume);
+
+	return true;
+}
+
+inline void tissuestack::imaging::RawConverter::readSlab(
+		const tissuestack::imaging::TissueStackImageData * image_data,
+		const mihandle_t & minc_handle,
+		const unsigned long long int first_slice,
+		const unsigned long long int number_of_slices,
+		unsigned char * slab) const
+{
+	if (image_data->getFormat() == tissuestack::imaging::FORMAT::MINC)
+	{
+		// one hyperslab for the whole slab, minc does the conversion to unsigned byte
+		const unsigned short numOfDims = image_data->getNumberOfDimensions();
+		unsigned long starts[numOfDims];
+		unsigned long counts[numOfDims];
+		for (unsigned short i=0;i<numOfDims;i++)
+		{
+			starts[i] = (i == 0) ? first_slice : 0;
+			if (i == 0)
+				counts[i] = number_of_slices;
+			else if (i < 3)
+				counts[i] = image_data->getDimensionByOrderIndex(i)->getNumberOfSlices();
+			else
+				counts[i] = 1;
+		}
+
+		if (miget_real_value_hyperslab(
+				minc_handle,
+				MI_TYPE_UBYTE,
+				starts,
+				counts,
+				slab) != MI_NOERROR)
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Minc => Raw Conversion failed: Could not read hyperslab!");
+		return;
+	}
+
+	// nifti is read plane by plane along its last axis, which is contiguous on disk
+	const tissuestack::imaging::TissueStackNiftiData * nifti =
+		static_cast<const tissuestack::imaging::TissueStackNiftiData *>(image_data);
+	const unsigned long long int planeSize = nifti->getDimensionByOrderIndex(2)->getSliceSize();
+	const unsigned long long int expected_bytes =
+		planeSize * static_cast<unsigned long long int>(nifti->getNiftiHandle()->nbyper);
+
+	int dims[8] = { 0, -1, -1, -1, -1, -1, -1, -1 };
+	// set time slice to 0 for any data set with dimensionality greater than 3
+	if (nifti->getNiftiHandle()->ndim > 3) dims[4] = 0;
+
+	for (unsigned long long int s=0;s<number_of_slices;s++)
+	{
+		void *data_in = NULL;
+		dims[3] = first_slice + s;
+
+		int ret = nifti_read_collapsed_image(
+				const_cast<nifti_image *>(nifti->getNiftiHandle()), dims, &data_in);
+		if (ret < 0)
+			THROW_TS_EXCEPTION(
+				tissuestack::common::TissueStackApplicationException,
+				"Failed to read NIFTI file!");
+		if (static_cast<unsigned long long int>(ret) != expected_bytes)
+		{
+			if (data_in) free(data_in);
+			THROW_TS_EXCEPTION(
+				tissuestack::common::TissueStackApplicationException,
+				"NIFTI read: number of read bytes does not match expected bytes!");
+		}
+
+		// both buffers are freed by the conversion if it fails
+		unsigned char * data_out = new unsigned char[planeSize * 3];
+		this->iteratOverPixelsAndConvert(
+			data_in,
+			data_out,
+			planeSize,
+			nifti->getNiftiHandle(),
+			nifti->getMin(),
+			nifti->getMax(),
+			false,
+			0);
+		if (data_in) free(data_in);
+
+		unsigned char * plane = slab + s * planeSize;
+		for (unsigned long long int p=0;p<planeSize;p++)
+			plane[p] = data_out[p * 3];
+		delete [] data_out;
+	}
+}
+
+inline const bool tissuestack::imaging::RawConverter::computeReorientation(
+		const tissuestack::imaging::TissueStackImageData * image_data,
+		const tissuestack::imaging::TissueStackDataDimension * dim,
+		std::vector<unsigned int> & source_pixels) const
+{
+	const unsigned long long int sliceSize = dim->getSliceSize();
+	if (sliceSize == 0 || sliceSize > 0xFFFFFFFFull)
+		return false;
+	source_pixels.assign(sliceSize, 0);
+
+	// the reorientation only moves pixels around. running it over a slice whose pixels carry
+	// their own index in the rgb channels, 24 bits at a time, tells us where each pixel came from
+	const unsigned short passes = ((sliceSize - 1) >> 24) == 0 ? 1 : 2;
+	for (unsigned short pass=0;pass<passes;pass++)
+	{
+		unsigned char * encoded = new unsigned char[sliceSize * 3];
+		for (unsigned long long int p=0;p<sliceSize;p++)
+		{
+			const unsigned long long int bits = p >> (24 * pass);
+			encoded[p * 3 + 0] = bits & 0xFF;
+			encoded[p * 3 + 1] = (bits >> 8) & 0xFF;
+			encoded[p * 3 + 2] = (bits >> 16) & 0xFF;
+		}
+
+		// the reorientation frees the buffer if it fails
+		if (image_data->getFormat() == tissuestack::imaging::FORMAT::MINC)
+			this->reorientMincSlice(
+				static_cast<const tissuestack::imaging::TissueStackMincData *>(image_data), dim, encoded, 0);
+		else
+			this->reorientNiftiSlice(
+				static_cast<const tissuestack::imaging::TissueStackNiftiData *>(image_data), dim, encoded, 0);
+
+		for (unsigned long long int p=0;p<sliceSize;p++)
+		{
+			const unsigned long long int bits =
+				static_cast<unsigned long long int>(encoded[p * 3 + 0]) |
+				(static_cast<unsigned long long int>(encoded[p * 3 + 1]) << 8) |
+				(static_cast<unsigned long long int>(encoded[p * 3 + 2]) << 16);
+			source_pixels[p] |= static_cast<unsigned int>(bits << (24 * pass));
+		}
+		delete [] encoded;
+	}
+
+	// make sure we got a permutation, otherwise we rather convert slice by slice
+	std::vector<bool> taken(sliceSize, false);
+	for (auto source : source_pixels)
+	{
+		if (source >= sliceSize || taken[source])
+			return false;
+		taken[source] = true;
+	}
+
+	return true;
+}
+
+inline const bool tissuestack::imaging::RawConverter::isCancelledOrShutDown(
+	const tissuestack::common::ProcessingStrategy * processing_strategy,
+	const tissuestack::services::TissueStackConversionTask * converter_task) const
+{
+	if (processing_strategy == nullptr || converter_task == nullptr)
+		return true;
+
+	// abortion check
+	if (!processing_strategy->isRunning()
+			|| processing_strategy->isStopFlagRaised())
+		return true;
+
+	// cancel check
+	return converter_task->getStatus() ==
+				tissuestack::services::TissueStackTaskStatus::CANCELLED
+			|| converter_task->getStatus() ==
+				tissuestack::services::TissueStackTaskStatus::ERRONEOUS;
+}
+
+inline void tissuestack::imaging::RawConverter::writeSlice(
+	const unsigned char * data,
+	const unsigned long long int length,
+	const unsigned long long int offset) const
+{
+	unsigned long long int written = 0;
+	while (written < length)
+	{
+		const ssize_t bytesWritten =
+			pwrite(this->_file_descriptor, data + written, length - written, offset + written);
+		if (bytesWritten < 0 && errno == EINTR)
+			continue;
+		if (bytesWritten <= 0)
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Raw Conversion: written bytes do not match expected bytes!");
+		written += bytesWritten;
+	}
 }
 
 inline const bool tissuestack::imaging::RawConverter::hasBeenCancelledOrShutDown(
@@ -605,8 +1275,7 @@ inline const bool tissuestack::imaging::RawConverter::hasBeenCancelledOrShutDown
 					|| converter_task->getStatus() ==
 							tissuestack::services::TissueStackTaskStatus::ERRONEOUS)))
 	{
-		close(this->_file_descriptor);
-		// we erase our partial work !
+		// we erase our partial work ! the descriptor is closed by convert/the destructor
 		unlink(converter_task->getOutFile().c_str());
 
 		return true;
@@ -619,8 +1288,10 @@ inline const bool tissuestack::imaging::RawConverter::hasBeenCancelledOrShutDown
 inline void tissuestack::imaging::RawConverter::convertSlice(
 	const tissuestack::imaging::TissueStackMincData * minc,
 	const mihandle_t & minc_handle,
+	std::mutex & read_mutex,
 	const unsigned long int slice_number,
-	const short dimension_number) const
+	const short dimension_number,
+	const unsigned long long int offset) const
 {
 	unsigned short numOfDims =
 		minc->isColor() ? minc->getNumberOfDimensions() + 1 :
@@ -675,16 +1346,21 @@ inline void tissuestack::imaging::RawConverter::convertSlice(
 			starts[numOfDims-1] = rgbChannel;
 
 		// read hyperslab as unsigned byte and let minc do the dirty deeds of conversion
-		int result =
-			miget_real_value_hyperslab(
-				minc_handle,
-				MI_TYPE_UBYTE,
-				starts,
-				counts,
-				buffer);
+		int result = MI_ERROR;
+		{
+			std::lock_guard<std::mutex> lock(read_mutex);
+			result =
+				miget_real_value_hyperslab(
+					minc_handle,
+					MI_TYPE_UBYTE,
+					starts,
+					counts,
+					buffer);
+		}
 		if (result != MI_NOERROR)
 		{
 			delete [] buffer;
+			delete [] newImage;
 			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 				"Minc => Raw Conversion failed: Could not read hyperslab!");
 		}
@@ -704,19 +1380,23 @@ inline void tissuestack::imaging::RawConverter::convertSlice(
 	this->reorientMincSlice(minc, dim, newImage, 0);
 
 	// write out into new raw file
-	ssize_t bytesWritten =
-		write(this->_file_descriptor, newImage, new_image_slice_size);
+	try
+	{
+		this->writeSlice(newImage, new_image_slice_size, offset);
+	} catch (...)
+	{
+		delete [] newImage;
+		throw;
+	}
 	delete [] newImage;
-	if (bytesWritten != static_cast<ssize_t>(new_image_slice_size))
-		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-			"Minc Conversion: written bytes do not match expected bytes!");
 
 }
 
 inline void tissuestack::imaging::RawConverter::convertSlice(
 	const tissuestack::imaging::TissueStackNiftiData * nifti,
 	const unsigned long int slice_number,
-	const short dimension_number) const
+	const short dimension_number,
+	const unsigned long long int offset) const
 {
 	int dims[8] = { 0, -1, -1, -1, -1, -1, -1, -1 };
 	void *data_in = NULL;
@@ -803,12 +1483,96 @@ inline void tissuestack::imaging::RawConverter::convertSlice(
 	this->reorientNiftiSlice(nifti, dim, data_out, 0);
 
 	// write out into new raw file
-	ssize_t bytesWritten =
-		write(this->_file_descriptor, data_out, new_size_per_slice);
+	try
+	{
+		this->writeSlice(data_out, new_size_per_slice, offset);
+	} catch (...)
+	{
+		delete [] data_out;
+		throw;
+	}
 	delete [] data_out;
-	if (bytesWritten != static_cast<ssize_t>(new_size_per_slice))
-		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-			"Nifti Conversion: written bytes do not match expected bytes!");
+}
+
+template <typename ValueType, typename ComputeType>
+inline void tissuestack::imaging::RawConverter::rescaleToUnsignedChar(
+	const ValueType * in,
+	unsigned char * out,
+	const unsigned long long int size,
+	const double min,
+	const double max,
+	const bool isRgb,
+	const unsigned short rgb_channel) const
+{
+	// the reference mapping, with the same precision and rounding as it always had
+	const long double range = max - min;
+	const auto exactValue =
+		[&] (const ValueType value) -> unsigned char
+		{
+			return (unsigned char) roundl(((((long double) value) - min) / range) * (long double) 255);
+		};
+
+	const ComputeType offset = static_cast<ComputeType>(min);
+	const ComputeType scale = static_cast<ComputeType>(255.0 / (max - min));
+	const ComputeType half = static_cast<ComputeType>(0.5);
+	const ComputeType epsilon = static_cast<ComputeType>(0.001);
+
+	unsigned char values[RESCALE_BLOCK_SIZE];
+	unsigned char inexact[RESCALE_BLOCK_SIZE];
+	for (unsigned long long int start = 0; start < size; start += RESCALE_BLOCK_SIZE)
+	{
+		const unsigned int length =
+			(size - start) < RESCALE_BLOCK_SIZE ? static_cast<unsigned int>(size - start) : RESCALE_BLOCK_SIZE;
+		const ValueType * block = in + start;
+
+		// the vectorisable loop: branch free scaling and rounding which flags any value
+		// that lands close to a rounding boundary or outside of 0..255 (nan included)
+		unsigned char anyInexact = 0;
+		for (unsigned int i = 0; i < length; i++)
+		{
+			const ComputeType scaled = (static_cast<ComputeType>(block[i]) - offset) * scale + half;
+			const ComputeType clamped =
+				std::min(static_cast<ComputeType>(256), std::max(static_cast<ComputeType>(0), scaled));
+			const int rounded = static_cast<int>(clamped);
+			const ComputeType fraction = clamped - static_cast<ComputeType>(rounded);
+			inexact[i] = static_cast<unsigned char>(
+				(fraction < epsilon) | (fraction > static_cast<ComputeType>(1) - epsilon) |
+				(scaled <= epsilon) | (scaled >= static_cast<ComputeType>(256) - epsilon) | (scaled != scaled));
+			anyInexact |= inexact[i];
+			values[i] = static_cast<unsigned char>(rounded);
+		}
+
+		// those few are redone the exact way so that the result does not change
+		if (anyInexact)
+			for (unsigned int i = 0; i < length; i++)
+				if (inexact[i])
+					values[i] = exactValue(block[i]);
+
+		unsigned char * o = out + start * 3;
+		if (!isRgb)
+			for (unsigned int i = 0; i < length; i++)
+				o[i * 3 + 0] = o[i * 3 + 1] = o[i * 3 + 2] = values[i];
+		else
+			for (unsigned int i = 0; i < length; i++)
+				o[i * 3 + rgb_channel] = values[i];
+	}
+}
+
+template <typename ValueType>
+inline void tissuestack::imaging::RawConverter::rescaleToUnsignedChar(
+	const ValueType * in,
+	unsigned char * out,
+	const unsigned long long int size,
+	const double min,
+	const double max,
+	const bool isRgb,
+	const unsigned short rgb_channel,
+	const bool single_precision) const
+{
+	if (single_precision)
+		this->rescaleToUnsignedChar<ValueType, float>(in, out, size, min, max, isRgb, rgb_channel);
+	else
+		this->rescaleToUnsignedChar<ValueType, double>(in, out, size, min, max, isRgb, rgb_channel);
 }
 
 inline void tissuestack::imaging::RawConverter::iteratOverPixelsAndConvert(
@@ -820,105 +1584,119 @@ inline void tissuestack::imaging::RawConverter::iteratOverPixelsAndConvert(
 	const double max,
 	const bool isRgb,
 	const unsigned short rgb_channel) const {
-	unsigned short error = 0;
-
-	for (unsigned int i = 0; i < size; i++) {
-		// keep track of error
-		error = 0;
-		// move start back "data type" number of bytes...
-		if (i != 0)
-			in = (void *) (((unsigned char*) in) + nifti->nbyper);
-		// range to map to
-		long double range = max - min;
-		unsigned char val = 0;
-
-		// now extract value
-		switch (nifti->datatype) {
-			case NIFTI_TYPE_UINT8: // unsigned char | nothing much to there but copy values
-				val = (unsigned char) ((unsigned char *) in)[0];
-				break;
-			case NIFTI_TYPE_INT8: // signed char | adjust range to min/max found previously
-				val = (unsigned char)
-						roundl(((((long double) ((char *) in)[0]) - min) / range) * (long double) 255);
-				break;
-			case NIFTI_TYPE_UINT16: // unsigned short
-				val = (unsigned char)
-						roundl(((((long double) ((unsigned short *) in)[0]) - min) / range) * (long double) 255);
-				break;
-			case NIFTI_TYPE_UINT32: // unsigned int
-				val = (unsigned char)
-						roundl(((((long double) ((unsigned int *) in)[0]) - min) / range) * (long double) 255);
-				break;
-			case NIFTI_TYPE_INT16: // signed short
-				val = (unsigned char)
-						roundl(((((long double) ((short *) in)[0]) - min) / range) * (long double) 255);
-				break;
-			case NIFTI_TYPE_INT32: // signed int
-				val = (unsigned char)
-						roundl(((((long double) ((int *) in)[0]) - min) / range) * (long double) 255);
-				break;
-			case NIFTI_TYPE_UINT64: // unsigned long long
-				val = (unsigned char)
-						roundl(((((long double) ((unsigned long long int *) in)[0]) - min) / range) * (long double) 255);
-				break;
-			case NIFTI_TYPE_INT64: // signed long long
-				val = (unsigned char)
-						roundl(((((long double) ((long long int *) in)[0]) - min) / range) * (long double) 255);
-				break;
-			case NIFTI_TYPE_FLOAT32: //	float
-				val = (unsigned char)
-						roundl(((((long double) ((float *) in)[0]) - min) / range) * (long double) 255);
-				break;
-			case NIFTI_TYPE_FLOAT64: //	double
-				val = (unsigned char)
-						roundl(((((long double) ((double *) in)[0]) - min) / range) * (long double) 255);
-				break;
-			case NIFTI_TYPE_FLOAT128: // long double
-				val = (unsigned char)
-						roundl(((((long double *) in)[0] - min) / range) * (long double) 255);
-				break;
-			case NIFTI_TYPE_RGB24:
-			case NIFTI_TYPE_RGBA32: // unsigned char per channel
-				val = (unsigned char) ((unsigned char *) in)[0];
-				out[i * 3 + 0] = val;
-				out[i * 3 + 1] = (unsigned char) ((unsigned char *) in)[1];
-				out[i * 3 + 2] = (unsigned char) ((unsigned char *) in)[2];
-				break;
-			case 0:				// UNKNOWN
-				error = 1;
-				break;
-			case DT_BINARY:				// NOT SUPPORTED
-			case NIFTI_TYPE_COMPLEX64:
-			case NIFTI_TYPE_COMPLEX128:
-			case NIFTI_TYPE_COMPLEX256:
-				error = 1;
-				break;
-			default:	//	even more unknown
-				error = 1;
-				break;
-			}
-		// set value in out array, depending on whether we have rgb or not
-		if (!isRgb)
-		{
-			if (nifti->datatype != NIFTI_TYPE_RGB24 && nifti->datatype != NIFTI_TYPE_RGBA32)
-				out[i * 3 + 0] = out[i * 3 + 1] = out[i * 3 + 2] = val;
-		} else out[i * 3 + rgb_channel] = val;
 
-		// check for error
-		if (error)
-		{
-			// free and good bye
-			if (in)
+	// single precision will do for values that a float holds exactly, provided min and max are
+	const bool minAndMaxAreFloats =
+		static_cast<double>(static_cast<float>(min)) == min &&
+		static_cast<double>(static_cast<float>(max)) == max;
+
+	// the kernel is chosen once per slice according to the data type
+	bool error = false;
+	switch (nifti->datatype) {
+		case NIFTI_TYPE_UINT8: // unsigned char | nothing much to there but copy values
+			for (unsigned long long int i = 0; i < size; i++)
 			{
-				free(in);
-				in = NULL;
+				const unsigned char val = ((unsigned char *) in)[i];
+				if (!isRgb)
+					out[i * 3 + 0] = out[i * 3 + 1] = out[i * 3 + 2] = val;
+				else out[i * 3 + rgb_channel] = val;
 			}
-			delete [] out;
-			THROW_TS_EXCEPTION(
-				tissuestack::common::TissueStackApplicationException,
-				"Failed to convert NIFTI file: Unknown or unsupported data type!");
+			break;
+		case NIFTI_TYPE_INT8: // signed char | adjust range to min/max found previously
+			this->rescaleToUnsignedChar<char>(
+				(const char *) in, out, size, min, max, isRgb, rgb_channel, minAndMaxAreFloats);
+			break;
+		case NIFTI_TYPE_UINT16: // unsigned short
+			this->rescaleToUnsignedChar<unsigned short>(
+				(const unsigned short *) in, out, size, min, max, isRgb, rgb_channel, minAndMaxAreFloats);
+			break;
+		case NIFTI_TYPE_INT16: // signed short
+			this->rescaleToUnsignedChar<short>(
+				(const short *) in, out, size, min, max, isRgb, rgb_channel, minAndMaxAreFloats);
+			break;
+		case NIFTI_TYPE_FLOAT32: //	float
+			this->rescaleToUnsignedChar<float>(
+				(const float *) in, out, size, min, max, isRgb, rgb_channel, minAndMaxAreFloats);
+			break;
+		case NIFTI_TYPE_UINT32: // unsigned int | exact in double only
+			this->rescaleToUnsignedChar<unsigned int>(
+				(const unsigned int *) in, out, size, min, max, isRgb, rgb_channel, false);
+			break;
+		case NIFTI_TYPE_INT32: // signed int | exact in double only
+			this->rescaleToUnsignedChar<int>(
+				(const int *) in, out, size, min, max, isRgb, rgb_channel, false);
+			break;
+		case NIFTI_TYPE_FLOAT64: //	double
+			this->rescaleToUnsignedChar<double>(
+				(const double *) in, out, size, min, max, isRgb, rgb_channel, false);
+			break;
+		case NIFTI_TYPE_UINT64: // unsigned long long | not exact in double, hence no kernel
+			for (unsigned long long int i = 0; i < size; i++)
+			{
+				const unsigned char val = (unsigned char)
+					roundl(((((long double) ((unsigned long long int *) in)[i]) - min) / (long double) (max - min)) * (long double) 255);
+				if (!isRgb)
+					out[i * 3 + 0] = out[i * 3 + 1] = out[i * 3 + 2] = val;
+				else out[i * 3 + rgb_channel] = val;
+			}
+			break;
+		case NIFTI_TYPE_INT64: // signed long long | not exact in double, hence no kernel
+			for (unsigned long long int i = 0; i < size; i++)
+			{
+				const unsigned char val = (unsigned char)
+					roundl(((((long double) ((long long int *) in)[i]) - min) / (long double) (max - min)) * (long double) 255);
+				if (!isRgb)
+					out[i * 3 + 0] = out[i * 3 + 1] = out[i * 3 + 2] = val;
+				else out[i * 3 + rgb_channel] = val;
+			}
+			break;
+		case NIFTI_TYPE_FLOAT128: // long double
+			for (unsigned long long int i = 0; i < size; i++)
+			{
+				const unsigned char val = (unsigned char)
+					roundl(((((long double *) in)[i] - min) / (long double) (max - min)) * (long double) 255);
+				if (!isRgb)
+					out[i * 3 + 0] = out[i * 3 + 1] = out[i * 3 + 2] = val;
+				else out[i * 3 + rgb_channel] = val;
+			}
+			break;
+		case NIFTI_TYPE_RGB24:
+		case NIFTI_TYPE_RGBA32: // unsigned char per channel
+			for (unsigned long long int i = 0; i < size; i++)
+			{
+				const unsigned char * pixel = ((unsigned char *) in) + i * nifti->nbyper;
+				out[i * 3 + 0] = pixel[0];
+				out[i * 3 + 1] = pixel[1];
+				out[i * 3 + 2] = pixel[2];
+			}
+			break;
+		case 0:				// UNKNOWN
+			error = true;
+			break;
+		case DT_BINARY:				// NOT SUPPORTED
+		case NIFTI_TYPE_COMPLEX64:
+		case NIFTI_TYPE_COMPLEX128:
+		case NIFTI_TYPE_COMPLEX256:
+			error = true;
+			break;
+		default:	//	even more unknown
+			error = true;
+			break;
+	}
 
+	// check for error
+	if (error)
+	{
+		// free and good bye
+		if (in)
+		{
+			free(in);
+			in = NULL;
 		}
+		delete [] out;
+		THROW_TS_EXCEPTION(
+			tissuestack::common::TissueStackApplicationException,
+			"Failed to convert NIFTI file: Unknown or unsupported data type!");
 	}
 }
 
@@ -1058,10 +1836,11 @@ void tissuestack::imaging::RawConverter::reorientDicomSlices(
 			const unsigned long long int offset =
 				dim->getOffset() + s * slice_size;
 			ssize_t bDone =
-					read(
-							this->_file_descriptor,
+					pread(
+						this->_file_descriptor,
 						static_cast<void *>(slice_data),
-						slice_size);
+						slice_size,
+						offset);
 
 			if (bDone != static_cast<ssize_t>(slice_size))
 				THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
@@ -1167,15 +1946,7 @@ void tissuestack::imaging::RawConverter::reorientDicomSlices(
 				slice_data[j * 3 + 2] = (unsigned char) pixels[j].blue;
 			}
 
-			lseek(this->_file_descriptor,offset, SEEK_SET);
-			bDone =
-				write(
-					this->_file_descriptor,
-					static_cast<void *>(slice_data),
-					slice_size);
-			if (bDone != static_cast<ssize_t>(slice_size))
-				THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-						"Failed to write back slice from RAW file!");
+			this->writeSlice(slice_data, slice_size, offset);
 			// tidy up
 			if (img) DestroyImage(img);
 		}
@@ -50,21 +50,14 @@ const std::array<unsigned long long int, 3> tissuestack::imaging::SimpleCacheHeu
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 			"Image Query: Coordinate (x/y) exceeds the width/height of the image slice!");
 
-	bool needsToBeAddedToCache = false;
-
+	// memory mapped data sets are cached by the kernel's page cache already
+	std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> cache_hit =
+		image->isMappedIntoMemory() ? nullptr : this->findOrLoadSlice(image, request);
 	const unsigned char * cache_data =
-		this->findCacheHit(image, request);
-
+		cache_hit ? cache_hit->getCacheData() : this->_uncached_extraction->extractImageOnly(image, request);
 	if (cache_data == nullptr)
-	{
-		if (tissuestack::utils::System::getFreeRam() > actualDimension->getSliceSize() * 3)
-			needsToBeAddedToCache = true;
-
-		cache_data = this->_uncached_extraction->extractImageOnly(image, request);
-		if (cache_data == nullptr)
-			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-					"Could not extract image data");
-	}
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Could not extract image data");
 
 	std::array<unsigned long long int, 3> pixel_value;
 	if ((image->getRawVersion() == tissuestack::imaging::RAW_FILE_VERSION::LEGACY &&
@@ -83,9 +76,12 @@ const std::array<unsigned long long int, 3> tissuestack::imaging::SimpleCacheHeu
 						static_cast<unsigned long long int>(actualDimension->getWidth())*multiplier +
 					static_cast<unsigned long long int>(request->getXCoordinate())*multiplier);
 
+		// 8 bit data has a single grey value
 		pixel_value[0] = static_cast<unsigned long long int>(cache_data[actualOffset]);
-		pixel_value[1] = static_cast<unsigned long long int>(cache_data[actualOffset+1]);
-		pixel_value[2] = static_cast<unsigned long long int>(cache_data[actualOffset+2]);
+		pixel_value[1] = multiplier == 1 ?
+			pixel_value[0] : static_cast<unsigned long long int>(cache_data[actualOffset+1]);
+		pixel_value[2] = multiplier == 1 ?
+			pixel_value[0] : static_cast<unsigned long long int>(cache_data[actualOffset+2]);
 	} else
 	{
 		Image * img =
@@ -111,12 +107,8 @@ const std::array<unsigned long long int, 3> tissuestack::imaging::SimpleCacheHeu
 		DestroyImage(img);
 	}
 
-	if (needsToBeAddedToCache)
-		this->addToCache(
-			processing_strategy,
-			image,
-			request,
-			cache_data);
+	if (!cache_hit)
+		this->_uncached_extraction->releaseImageOnly(image, cache_data);
 
 	return pixel_value;
 }
@@ -134,46 +126,29 @@ const Image *  tissuestack::imaging::SimpleCacheHeuristics::extractImage(
 	const TissueStackRawData * image,
 	const tissuestack::networking::TissueStackImageRequest * request) const
 {
-	bool needsToBeAddedToCache = false;
-
-	const unsigned char * cache_data =
-		this->findCacheHit(image, request);
-
-	if (cache_data == nullptr)
-	{
-		const tissuestack::imaging::TissueStackDataDimension * actualDimension =
-				image->getDimensionByLongName(request->getDimensionName());
-		cache_data = this->_uncached_extraction->extractImageOnly(image, request);
-
-		if (tissuestack::utils::System::getFreeRam() > actualDimension->getSliceSize() * 3)
-			needsToBeAddedToCache = true;
-	}
-
 	const tissuestack::imaging::TissueStackDataDimension * actualDimension =
 			image->getDimensionByLongName(request->getDimensionName());
 
+	// memory mapped data sets are cached by the kernel's page cache already
+	// otherwise we hold on to the cache entry while we use its data
+	std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> cache_hit =
+		image->isMappedIntoMemory() ? nullptr : this->findOrLoadSlice(image, request);
+	const unsigned char * cache_data =
+		cache_hit ? cache_hit->getCacheData() : this->_uncached_extraction->extractImageOnly(image, request);
+
 	Image * img =
 		this->_uncached_extraction->createImageFromDataRead(image, actualDimension, cache_data);
 
-	if (needsToBeAddedToCache)
-		this->addToCache(
-			processing_strategy,
-			image,
-			request,
-			cache_data);
+	if (!cache_hit)
+		this->_uncached_extraction->releaseImageOnly(image, cache_data);
 
 	return img;
 }
 
-void tissuestack::imaging::SimpleCacheHeuristics::addToCache(
-	const tissuestack::common::ProcessingStrategy * processing_strategy,
+std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> tissuestack::imaging::SimpleCacheHeuristics::findOrLoadSlice(
 	const TissueStackRawData * image,
-	const tissuestack::networking::TissueStackImageRequest * request,
-	const unsigned char * data) const
+	const tissuestack::networking::TissueStackImageRequest * request) const
 {
-
-	const std::string dataset = image->getFileName();
-
 	unsigned long int slice = 0;
 
 	for (auto dim : image->getDimensionOrder())
@@ -185,27 +160,80 @@ void tissuestack::imaging::SimpleCacheHeuristics::addToCache(
 	}
 	slice += request->getSliceNumber();
 
-	if (!tissuestack::imaging::TissueStackSliceCache::instance()->addCacheEntry(
-							dataset, slice, data))
-		delete [] data;
+	unsigned long long int size =
+		image->getDimensionByLongName(request->getDimensionName())->getSliceSize();
+	if (image->getType() != tissuestack::imaging::RAW_TYPE::UCHAR_8_BIT)
+		size *= 3;
+
+	// concurrent tile requests for the same slice share one read,
+	// which is why the read itself is not tied to the expiry of whoever started it
+	const tissuestack::imaging::TissueStackDataDimension * actualDimension =
+		image->getDimensionByLongName(request->getDimensionName());
+	const unsigned int sliceNumber = request->getSliceNumber();
+	std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> entry =
+		tissuestack::imaging::TissueStackSliceCache::instance()->findOrLoadCacheEntry(
+			image->getFileName(), slice,
+			[this, image, actualDimension, sliceNumber, size] () -> std::shared_ptr<const tissuestack::imaging::SliceCacheEntry>
+			{
+				const unsigned char * data =
+					this->_uncached_extraction->extractSliceOnly(image, actualDimension, sliceNumber);
+				if (data == nullptr)
+					return nullptr;
+
+				return std::shared_ptr<const tissuestack::imaging::SliceCacheEntry>(
+					new tissuestack::imaging::SliceCacheEntry(data, size));
+			});
+
+	// timeout check, for each request on its own
+	if (request->hasExpired())
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackObsoleteRequestException,
+			"Old Image Request!");
+
+	return entry;
 }
 
-const unsigned char * tissuestack::imaging::SimpleCacheHeuristics::findCacheHit(
+Image * tissuestack::imaging::SimpleCacheHeuristics::extractAndProcessImage(
+	const tissuestack::common::ProcessingStrategy * processing_strategy,
 	const TissueStackRawData * image,
 	const tissuestack::networking::TissueStackImageRequest * request) const
 {
-	unsigned long int slice = 0;
-
-	for (auto dim : image->getDimensionOrder())
+	if (!this->_uncached_extraction->supportsNativeProcessing(image))
 	{
-		if (request->getDimensionName().at(0) == dim.at(0))
-			break;
+		Image * img =
+			const_cast<Image *>(this->extractImage(processing_strategy, image, request));
+
+		// timeout/shutdown check
+		if (request->hasExpired() || processing_strategy->isStopFlagRaised())
+		{
+			if (img) DestroyImage(img);
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackObsoleteRequestException,
+				"Old Image Request!");
+		}
 
-		slice += image->getDimensionByLongName(dim)->getNumberOfSlices();
+		return this->applyPostExtractionTasks(img, image, request);
 	}
-	slice += request->getSliceNumber();
 
-	return
-		tissuestack::imaging::TissueStackSliceCache::instance()->findCacheEntry(
-			image->getFileName(), slice);
+	// memory mapped data sets are cached by the kernel's page cache already
+	std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> cache_hit =
+		image->isMappedIntoMemory() ? nullptr : this->findOrLoadSlice(image, request);
+	const unsigned char * data =
+		cache_hit ? cache_hit->getCacheData() : this->_uncached_extraction->extractImageOnly(image, request);
+	if (data == nullptr)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Could not extract image data");
+
+	Image * img = NULL;
+	try
+	{
+		img = this->_uncached_extraction->processImageNatively(image, request, data);
+	} catch (...)
+	{
+		if (!cache_hit)
+			this->_uncached_extraction->releaseImageOnly(image, data);
+		throw;
+	}
+	if (!cache_hit)
+		this->_uncached_extraction->releaseImageOnly(image, data);
+
+	return img;
 }
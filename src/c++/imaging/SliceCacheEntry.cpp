@@ -23,31 +23,16 @@ tissuestack::imaging::SliceCacheEntry::~SliceCacheEntry()
 		delete [] this->_cache_data;
 }
 
-tissuestack::imaging::SliceCacheEntry::SliceCacheEntry(const unsigned char * cache_data) :
-	_cache_data(cache_data), _timestamp_accessed(tissuestack::utils::System::getSystemTimeInMillis()), _access_count(0)
+tissuestack::imaging::SliceCacheEntry::SliceCacheEntry(const unsigned char * cache_data, const unsigned long long int size) :
+	_cache_data(cache_data), _size(size)
 {}
 
-
-const unsigned char * tissuestack::imaging::SliceCacheEntry::getCacheData()
+const unsigned char * tissuestack::imaging::SliceCacheEntry::getCacheData() const
 {
-	// every time this method is called we increment the access count
-	// and update the last access timestamp
-	const unsigned long long int MAX_UNSIGNED_LONG_LONG_INT =
-		std::numeric_limits<unsigned long long int>::max();
-	if (this->_access_count != MAX_UNSIGNED_LONG_LONG_INT)
-		this->_access_count++;
-	this->_timestamp_accessed = tissuestack::utils::System::getSystemTimeInMillis();
-
 	return this->_cache_data;
 }
 
-const unsigned long long int tissuestack::imaging::SliceCacheEntry::getAccessCount() const
-{
-	return this->_access_count;
-}
-
-const unsigned long long int tissuestack::imaging::SliceCacheEntry::getTimeStampForLastAccess() const
+const unsigned long long int tissuestack::imaging::SliceCacheEntry::getSize() const
 {
-	return this->_timestamp_accessed;
+	return this->_size;
 }
-
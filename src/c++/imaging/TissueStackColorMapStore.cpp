@@ -65,6 +65,12 @@ const bool tissuestack::imaging::TissueStackColorMapStore::doesInstanceExist()
 	 //	 delete this->_color_maps[colorMap->getColorMapId()];
 
 	 this->_color_maps[colorMap->getColorMapId()] = colorMap;
+
+	 // lookup tables and tiles rendered with the previous version are stale now
+	 if (tissuestack::imaging::TissueStackLookupTableCache::doesInstanceExist())
+		 tissuestack::imaging::TissueStackLookupTableCache::instance()->invalidateColorMap(colorMap->getColorMapId());
+	 if (tissuestack::imaging::TissueStackTileCache::doesInstanceExist())
+		 tissuestack::imaging::TissueStackTileCache::instance()->evictColorMap(colorMap->getColorMapId());
  }
 
  void tissuestack::imaging::TissueStackColorMapStore::addOrReplaceColorMap(
@@ -85,6 +91,11 @@ const bool tissuestack::imaging::TissueStackColorMapStore::doesInstanceExist()
 
 	 this->_color_maps[labelLookup->getLabelLookupId()] = colorFromLabel;
 
+	 if (tissuestack::imaging::TissueStackLookupTableCache::doesInstanceExist())
+		 tissuestack::imaging::TissueStackLookupTableCache::instance()->invalidateColorMap(labelLookup->getLabelLookupId());
+	 if (tissuestack::imaging::TissueStackTileCache::doesInstanceExist())
+		 tissuestack::imaging::TissueStackTileCache::instance()->evictColorMap(labelLookup->getLabelLookupId());
+
 	 if (oldPointer != nullptr)
 		 delete oldPointer;
 
@@ -59,6 +59,8 @@ void tissuestack::imaging::TissueStackDataSetStore::purgeInstance()
 	// walk through entries and clean them up
 	for (auto entry : this->_data_sets)
 		if (entry.second) delete entry.second;
+	for (auto retired : this->_retired_data_sets)
+		delete retired.second;
 
 	delete tissuestack::imaging::TissueStackDataSetStore::_instance;
 	tissuestack::imaging::TissueStackDataSetStore::_instance = nullptr;
@@ -202,11 +204,17 @@ void tissuestack::imaging::TissueStackDataSetStore::removeDataSetByDataBaseId(co
 		if (dataSet.second->getImageData()->getDataBaseId() == id)
 		{
 			key = dataSet.first;
-			delete dataSet.second;
+			this->retireDataSet(dataSet.second);
 			break;
 		}
-	if (!key.empty())
-		this->_data_sets.erase(key);
+	if (key.empty())
+		return;
+
+	this->_data_sets.erase(key);
+	if (tissuestack::imaging::TissueStackSliceCache::doesInstanceExist())
+		tissuestack::imaging::TissueStackSliceCache::instance()->evictDataSet(key);
+	if (tissuestack::imaging::TissueStackTileCache::doesInstanceExist())
+		tissuestack::imaging::TissueStackTileCache::instance()->evictDataSet(key);
 }
 
 void tissuestack::imaging::TissueStackDataSetStore::addDataSet(const tissuestack::imaging::TissueStackDataSet * dataSet)
@@ -215,6 +223,7 @@ void tissuestack::imaging::TissueStackDataSetStore::addDataSet(const tissuestack
 
 	if (this->findDataSet(dataSet->getDataSetId()) != nullptr) return; // we do not replace in here
 
+	this->mapRawDataIntoMemory(dataSet);
 	this->_data_sets[dataSet->getDataSetId()] = dataSet;
 }
 
@@ -226,11 +235,54 @@ void tissuestack::imaging::TissueStackDataSetStore::replaceDataSet(const tissues
 		this->findDataSet(dataSet->getDataSetId());
 
 	if (existing)
-		delete existing;
-
+		this->retireDataSet(existing);
+	// cached slices belong to the old data
+	if (tissuestack::imaging::TissueStackSliceCache::doesInstanceExist())
+		tissuestack::imaging::TissueStackSliceCache::instance()->evictDataSet(dataSet->getDataSetId());
+	if (tissuestack::imaging::TissueStackTileCache::doesInstanceExist())
+		tissuestack::imaging::TissueStackTileCache::instance()->evictDataSet(dataSet->getDataSetId());
+
+	this->mapRawDataIntoMemory(dataSet);
 	this->_data_sets[dataSet->getDataSetId()] = dataSet;
 }
 
+inline void tissuestack::imaging::TissueStackDataSetStore::retireDataSet(
+	const tissuestack::imaging::TissueStackDataSet * dataSet)
+{
+	// in-flight requests may still read the data set and its memory mapped slices:
+	// it is deleted (and unmapped) once it has been out of the store long enough
+	const unsigned long long int NOW = tissuestack::utils::System::getSystemTimeInMillis();
+
+	std::lock_guard<std::mutex> lock(this->_retired_data_sets_mutex);
+	while (!this->_retired_data_sets.empty() &&
+		NOW - this->_retired_data_sets.front().first > tissuestack::imaging::TissueStackDataSetStore::RETIREMENT_IN_MILLIS)
+	{
+		delete this->_retired_data_sets.front().second;
+		this->_retired_data_sets.pop_front();
+	}
+
+	this->_retired_data_sets.push_back(std::make_pair(NOW, dataSet));
+}
+
+inline void tissuestack::imaging::TissueStackDataSetStore::mapRawDataIntoMemory(
+	const tissuestack::imaging::TissueStackDataSet * dataSet) const
+{
+	if (dataSet->getImageData() == nullptr || !dataSet->getImageData()->isRaw())
+		return;
+
+	try
+	{
+		const_cast<tissuestack::imaging::TissueStackRawData *>(
+			static_cast<const tissuestack::imaging::TissueStackRawData *>(
+				dataSet->getImageData()))->mapIntoMemory();
+	} catch (std::exception & bad)
+	{
+		// not fatal: slice reads fall back onto the file descriptor
+		tissuestack::logging::TissueStackLogger::instance()->error(
+			"Could not memory map data set '%s': %s\n", dataSet->getDataSetId().c_str(), bad.what());
+	}
+}
+
 void tissuestack::imaging::TissueStackDataSetStore::dumpDataSetStoreIntoDebugLog() const
 {
 	for (auto entry : this->_data_sets)
@@ -258,4 +310,6 @@ const std::string tissuestack::imaging::TissueStackDataSetStore::getDataSetStore
 	return dir;
 }
 
+const unsigned long long int tissuestack::imaging::TissueStackDataSetStore::RETIREMENT_IN_MILLIS = 1000 * 60 * 5;
+
 tissuestack::imaging::TissueStackDataSetStore * tissuestack::imaging::TissueStackDataSetStore::_instance = nullptr;
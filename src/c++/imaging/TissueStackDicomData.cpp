@@ -637,8 +637,17 @@ const bool tissuestack::imaging::TissueStackDicomData::checkWidthAndHeightConsis
 	return true;
 }
 
+std::mutex tissuestack::imaging::TissueStackDicomData::_dcmtk_codecs_mutex;
+unsigned int tissuestack::imaging::TissueStackDicomData::_dcmtk_codecs_users = 0;
+
 void tissuestack::imaging::TissueStackDicomData::registerDcmtkDecoders() const
 {
+	// the codecs are global: conversions running side by side share them
+	// and only the last one to finish cleans them up
+	std::lock_guard<std::mutex> lock(tissuestack::imaging::TissueStackDicomData::_dcmtk_codecs_mutex);
+	if (tissuestack::imaging::TissueStackDicomData::_dcmtk_codecs_users++ > 0)
+		return;
+
 	DJDecoderRegistration::registerCodecs(EDC_photometricInterpretation);
 	DJLSDecoderRegistration::registerCodecs();
 	DcmRLEDecoderRegistration::registerCodecs();
@@ -646,6 +655,11 @@ void tissuestack::imaging::TissueStackDicomData::registerDcmtkDecoders() const
 
 void tissuestack::imaging::TissueStackDicomData::deregisterDcmtkDecoders() const
 {
+	std::lock_guard<std::mutex> lock(tissuestack::imaging::TissueStackDicomData::_dcmtk_codecs_mutex);
+	if (tissuestack::imaging::TissueStackDicomData::_dcmtk_codecs_users == 0 ||
+			--tissuestack::imaging::TissueStackDicomData::_dcmtk_codecs_users > 0)
+		return;
+
 	DJDecoderRegistration::cleanup();
 	DJLSDecoderRegistration::cleanup();
 	DcmRLEDecoderRegistration::cleanup();
@@ -0,0 +1,199 @@
+/*
+ * This file is part of TissueStack.
+ *
+ * TissueStack is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TissueStack is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TissueStack.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "networking.h"
+#include "imaging.h"
+
+tissuestack::imaging::TissueStackLookupTableCache::TissueStackLookupTableCache() :
+	_hits(0), _misses(0), _evictions(0)
+{
+	this->_capacity =
+		strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("lookup_table_cache_size").c_str(), NULL, 10);
+	if (this->_capacity == 0)
+		this->_capacity = 1;
+}
+
+tissuestack::imaging::TissueStackLookupTableCache * tissuestack::imaging::TissueStackLookupTableCache::instance()
+{
+	if (tissuestack::imaging::TissueStackLookupTableCache::_instance == nullptr)
+		tissuestack::imaging::TissueStackLookupTableCache::_instance = new tissuestack::imaging::TissueStackLookupTableCache();
+
+	return tissuestack::imaging::TissueStackLookupTableCache::_instance;
+}
+
+const bool tissuestack::imaging::TissueStackLookupTableCache::doesInstanceExist()
+{
+	return (tissuestack::imaging::TissueStackLookupTableCache::_instance != nullptr);
+}
+
+void tissuestack::imaging::TissueStackLookupTableCache::purgeInstance()
+{
+	delete tissuestack::imaging::TissueStackLookupTableCache::_instance;
+	tissuestack::imaging::TissueStackLookupTableCache::_instance = nullptr;
+}
+
+std::shared_ptr<const tissuestack::imaging::FusedLookupTable> tissuestack::imaging::TissueStackLookupTableCache::findOrBuildLookupTable(
+	const std::string & color_map_name,
+	const unsigned short contrast_min,
+	const unsigned short contrast_max,
+	const unsigned short dataset_min,
+	const unsigned short dataset_max)
+{
+	// without contrast adjustment the data set range is irrelevant, all data sets share the table
+	const bool applyContrast = !(contrast_min == 0 && contrast_max == 255);
+	const std::string key =
+		color_map_name + ":" + std::to_string(contrast_min) + ":" + std::to_string(contrast_max) + ":" +
+		(applyContrast ? std::to_string(dataset_min) + ":" + std::to_string(dataset_max) : "");
+
+	unsigned long long int generation = 0;
+	{
+		std::lock_guard<std::mutex> lock(this->_cache_mutex);
+		auto hit = this->_index.find(key);
+		if (hit != this->_index.end())
+		{
+			this->_lru.splice(this->_lru.begin(), this->_lru, hit->second);
+			this->_hits++;
+			return hit->second->table;
+		}
+		generation = this->_generation;
+	}
+
+	// building takes a few microseconds, a concurrent miss on the same key merely builds it twice
+	this->_misses++;
+	const std::shared_ptr<const tissuestack::imaging::FusedLookupTable> table =
+		tissuestack::imaging::TissueStackLookupTableCache::buildLookupTable(
+			color_map_name, contrast_min, contrast_max, dataset_min, dataset_max);
+
+	std::lock_guard<std::mutex> lock(this->_cache_mutex);
+	// a color map reloaded while we were building might have left us with stale values
+	if (generation != this->_generation || this->_index.find(key) != this->_index.end())
+		return table;
+
+	while (this->_lru.size() >= this->_capacity)
+	{
+		this->_index.erase(this->_lru.back().key);
+		this->_lru.pop_back();
+		this->_evictions++;
+	}
+	this->_lru.push_front({ key, color_map_name, table });
+	this->_index[key] = this->_lru.begin();
+
+	return table;
+}
+
+void tissuestack::imaging::TissueStackLookupTableCache::invalidateColorMap(const std::string & color_map_name)
+{
+	std::lock_guard<std::mutex> lock(this->_cache_mutex);
+
+	this->_generation++;
+	for (auto entry = this->_lru.begin(); entry != this->_lru.end();)
+	{
+		if (entry->color_map_name.compare(color_map_name) == 0)
+		{
+			this->_index.erase(entry->key);
+			entry = this->_lru.erase(entry);
+		} else
+			++entry;
+	}
+}
+
+const std::shared_ptr<const tissuestack::imaging::FusedLookupTable> tissuestack::imaging::TissueStackLookupTableCache::buildLookupTable(
+	const std::string & color_map_name,
+	const unsigned short contrast_min,
+	const unsigned short contrast_max,
+	const unsigned short dataset_min,
+	const unsigned short dataset_max)
+{
+	const tissuestack::imaging::TissueStackColorMap * colorMap = nullptr;
+	if (color_map_name.compare("gray") != 0 &&
+		color_map_name.compare("grey") != 0)
+	{
+		colorMap =
+			tissuestack::imaging::TissueStackColorMapStore::instance()->findColorMap(color_map_name);
+		if (colorMap == nullptr)
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Colormap Application: Could not find color map!");
+	}
+
+	tissuestack::imaging::FusedLookupTable * table = new tissuestack::imaging::FusedLookupTable();
+	table->color_mapped = colorMap != nullptr;
+
+	const bool applyContrast = !(contrast_min == 0 && contrast_max == 255);
+	const float cMin = static_cast<float>(contrast_min);
+	const float cMax = static_cast<float>(contrast_max);
+
+	for (unsigned short v=0;v<256;v++)
+	{
+		// same arithmetic as the per pixel contrast adjustment
+		unsigned char gray = static_cast<unsigned char>(v);
+		if (applyContrast)
+		{
+			const float val = static_cast<float>(v);
+			if (val <= cMin)
+				gray = static_cast<unsigned char>(dataset_min);
+			else if (val >= cMax)
+				gray = static_cast<unsigned char>(dataset_max);
+			else
+				gray =
+					static_cast<unsigned char>(
+						lround(((val - cMin) / (cMax - cMin))
+							* static_cast<float>(dataset_max - dataset_min)));
+		}
+		table->contrast[v] = gray;
+
+		unsigned int red = gray, green = gray, blue = gray;
+		if (colorMap)
+		{
+			const std::array<const unsigned short, 3> mapping =
+				colorMap->getRGBMapForGrayValue(static_cast<unsigned short>(gray));
+			red = static_cast<unsigned char>(mapping[0]);
+			green = static_cast<unsigned char>(mapping[1]);
+			blue = static_cast<unsigned char>(mapping[2]);
+		}
+		table->rgb[v] = red | (green << 8) | (blue << 16);
+	}
+
+	return std::shared_ptr<const tissuestack::imaging::FusedLookupTable>(table);
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackLookupTableCache::getNumberOfHits() const
+{
+	return this->_hits.load();
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackLookupTableCache::getNumberOfMisses() const
+{
+	return this->_misses.load();
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackLookupTableCache::getNumberOfEvictions() const
+{
+	return this->_evictions.load();
+}
+
+const std::string tissuestack::imaging::TissueStackLookupTableCache::getStatisticsAsJson() const
+{
+	std::ostringstream json;
+	json << "{ \"capacity\": " << this->_capacity;
+	json << ", \"hits\": " << this->getNumberOfHits();
+	json << ", \"misses\": " << this->getNumberOfMisses();
+	json << ", \"evictions\": " << this->getNumberOfEvictions();
+	json << " }";
+
+	return json.str();
+}
+
+tissuestack::imaging::TissueStackLookupTableCache * tissuestack::imaging::TissueStackLookupTableCache::_instance = nullptr;
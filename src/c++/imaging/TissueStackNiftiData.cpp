@@ -34,13 +34,29 @@ const nifti_image * tissuestack::imaging::TissueStackNiftiData::getNiftiHandle()
 
 const double tissuestack::imaging::TissueStackNiftiData::getMin() const
 {
+	this->determineGlobalMinMax();
 	return this->_min;
 }
 const double tissuestack::imaging::TissueStackNiftiData::getMax() const
 {
+	this->determineGlobalMinMax();
 	return this->_max;
 }
 
+const bool tissuestack::imaging::TissueStackNiftiData::hasGlobalMinMax() const
+{
+	std::lock_guard<std::mutex> lock(this->_min_max_mutex);
+	return this->_has_min_max;
+}
+
+void tissuestack::imaging::TissueStackNiftiData::setGlobalMinMax(const double min, const double max) const
+{
+	std::lock_guard<std::mutex> lock(this->_min_max_mutex);
+	this->_min = min;
+	this->_max = max;
+	this->_has_min_max = true;
+}
+
 
 tissuestack::imaging::TissueStackNiftiData::TissueStackNiftiData(const std::string & filename) :
 		tissuestack::imaging::TissueStackImageData(filename, tissuestack::imaging::FORMAT::NIFTI)
@@ -117,7 +133,6 @@ tissuestack::imaging::TissueStackNiftiData::TissueStackNiftiData(const std::stri
 	this->detectAndCorrectFor2DData();
 	this->generateRawHeader();
 	this->initializeOffsetsForNonRawFiles();
-	this->setGlobalMinMax();
 }
 
 tissuestack::imaging::TissueStackNiftiData::~TissueStackNiftiData()
@@ -125,8 +140,38 @@ tissuestack::imaging::TissueStackNiftiData::~TissueStackNiftiData()
 	if (this->_volume) free(this->_volume);
 }
 
-void tissuestack::imaging::TissueStackNiftiData::setGlobalMinMax()
+template <typename ValueType>
+inline void tissuestack::imaging::TissueStackNiftiData::findMinMax(
+	const void * values,
+	const unsigned long long int size,
+	double & min,
+	double & max) const
+{
+	// a branch free reduction the compiler can vectorise. nan never wins a comparison
+	const ValueType * v = static_cast<const ValueType *>(values);
+	ValueType lowest =
+		std::numeric_limits<ValueType>::has_infinity ?
+			std::numeric_limits<ValueType>::infinity() : std::numeric_limits<ValueType>::max();
+	ValueType highest =
+		std::numeric_limits<ValueType>::has_infinity ?
+			-std::numeric_limits<ValueType>::infinity() : std::numeric_limits<ValueType>::lowest();
+	for (unsigned long long int i = 0; i < size; i++)
+	{
+		lowest = v[i] < lowest ? v[i] : lowest;
+		highest = v[i] > highest ? v[i] : highest;
+	}
+
+	if (size == 0) return;
+	if (lowest < min) min = lowest;
+	if (highest > max) max = highest;
+}
+
+void tissuestack::imaging::TissueStackNiftiData::determineGlobalMinMax() const
 {
+	std::lock_guard<std::mutex> lock(this->_min_max_mutex);
+	if (this->_has_min_max)
+		return;
+
 	if (this->_is_color
 			|| this->_volume->datatype == NIFTI_TYPE_UINT8
 			|| this->_volume->datatype == NIFTI_TYPE_RGB24
@@ -141,105 +186,137 @@ void tissuestack::imaging::TissueStackNiftiData::setGlobalMinMax()
 		// don't require intensity value adjustments as they are already within the 8bit unsigned range
 		this->_min = 0;
 		this->_max = 255;
+		this->_has_min_max = true;
 		return;
 	}
 
-	int dims[8] = { 0, -1, -1, -1, -1, -1, -1, -1 };
-	// set time slice to 0 for any data set with dimensionality greater than 3
-	if (this->_volume->ndim > 3) dims[4] = 0;
-
-	unsigned int slice = 0;
-	void *data_in = NULL, *in = NULL;
-
-	const tissuestack::imaging::TissueStackDataDimension * firstDim =
+	// we scan along the last axis whose slices are contiguous on disk
+	const tissuestack::imaging::TissueStackDataDimension * scanDim =
 		this->get2DDimension() != nullptr ?
 				this->get2DDimension() :
-			this->getDimensionByOrderIndex(0);
-	if (firstDim == nullptr)
+			this->getDimensionByOrderIndex(2);
+	if (scanDim == nullptr)
 		THROW_TS_EXCEPTION(
 			tissuestack::common::TissueStackApplicationException,
-			"Could not find first dimension of read NIFTI file!");
-	short ind = this->getIndexForPlane(firstDim->getName()[0]);
+			"Could not find last dimension of read NIFTI file!");
+	const short ind = this->getIndexForPlane(scanDim->getName()[0]);
 
-	unsigned long long int size_per_slice =
-		firstDim->getSliceSize();
-	unsigned long long int expected_bytes =
+	const unsigned long long int size_per_slice =
+		scanDim->getSliceSize();
+	const unsigned long long int expected_bytes =
 		size_per_slice * static_cast<unsigned long long int>(this->_volume->nbyper);
 
-	// we use the first dimension, why not, don't make a difference to me ...
-	while (slice < firstDim->getNumberOfSlices())  // SLICE LOOP
-	{
-		dims[1+ind] = slice;
-
-		int ret = nifti_read_collapsed_image(this->_volume, dims, &data_in);
-		if (ret < 0)
-			THROW_TS_EXCEPTION(
-				tissuestack::common::TissueStackApplicationException,
-				"Failed to read NIFTI file!");
-
-		//sanity check
-		if (static_cast<unsigned long long int>(ret) != expected_bytes)
-			THROW_TS_EXCEPTION(
-				tissuestack::common::TissueStackApplicationException,
-				"NIFTI read: number of read bytes does not match expected bytes!");
-
-		for (unsigned int i = 0; i < size_per_slice; i++) {
-			// move start back "data type" number of bytes...
-			if (i == 0)
-				in = data_in;
-			else
-				in = (void *)(((char*) in) + this->_volume->nbyper);
-
-			switch (this->_volume->datatype) {
-				case NIFTI_TYPE_INT8: // signed char
-					if (((char *) in)[0] < this->_min) this->_min = ((char *) in)[0];
-					if (((char *) in)[0] > this->_min) this->_max = ((char *) in)[0];
-					break;
-				case NIFTI_TYPE_UINT16: // unsigned short
-					if (((unsigned short *) in)[0] < this->_min) this->_min = ((unsigned short *) in)[0];
-					if (((unsigned short *) in)[0] > this->_max) this->_max = ((unsigned short *) in)[0];
-					break;
-				case NIFTI_TYPE_UINT32: // unsigned int
-					if (((unsigned int *) in)[0] < this->_min) this->_min = ((unsigned int *) in)[0];
-					if (((unsigned int *) in)[0] > this->_max) this->_max = ((unsigned int *) in)[0];
-					break;
-				case NIFTI_TYPE_INT16: // signed short
-					if (((short *) in)[0] < this->_min) this->_min = ((short *) in)[0];
-					if (((short *) in)[0] > this->_max) this->_max = ((short *) in)[0];
-					break;
-				case NIFTI_TYPE_INT32: // signed int
-					if (((int *) in)[0] < this->_min) this->_min = ((int *) in)[0];
-					if (((int *) in)[0] > this->_max) this->_max = ((int *) in)[0];
-					break;
-				case NIFTI_TYPE_UINT64: // unsigned long long
-					if (((unsigned long long int *) in)[0] < this->_min) this->_min = ((unsigned long long int *) in)[0];
-					if (((unsigned long long int *) in)[0] > this->_max) this->_max = ((unsigned long long int *) in)[0];
-					break;
-				case NIFTI_TYPE_INT64: // signed long long
-					if (((long long int *) in)[0] < this->_min) this->_min = ((long long int *) in)[0];
-					if (((long long int *) in)[0] > this->_max) this->_max = ((long long int *) in)[0];
-					break;
-				case NIFTI_TYPE_FLOAT32: //	float
-					if (((float *) in)[0] < this->_min) this->_min = ((float *) in)[0];
-					if (((float *) in)[0] > this->_max) this->_max = ((float *) in)[0];
-					break;
-				case NIFTI_TYPE_FLOAT64: //	double
-					if (((double *) in)[0] < this->_min) this->_min = ((double *) in)[0];
-					if (((double *) in)[0] > this->_max) this->_max = ((double *) in)[0];
-					break;
-				case NIFTI_TYPE_FLOAT128: // long double
-					if (((long double *) in)[0] < this->_min) this->_min = ((long double *) in)[0];
-					if (((long double *) in)[0] > this->_max) this->_max = ((long double *) in)[0];
-					break;
-			}
-		}
+	unsigned short numberOfThreads =
+		static_cast<unsigned short>(
+			strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("conversion_threads").c_str(), NULL, 10));
+	if (numberOfThreads == 0)
+		numberOfThreads = tissuestack::utils::System::getNumberOfCores();
+	if (numberOfThreads > scanDim->getNumberOfSlices())
+		numberOfThreads = scanDim->getNumberOfSlices();
+
+	// every worker reduces the slices it takes, the results are merged at the end
+	std::atomic<unsigned long long int> nextSlice(0);
+	std::atomic<bool> abort(false);
+	std::exception_ptr failure = nullptr;
+	std::mutex mergeMutex;
+	double min = INFINITY;
+	double max = -INFINITY;
 
-		// increment slice
-		slice++;
-		if (data_in != NULL)
+	std::function<void ()> worker =
+		[&] ()
 		{
-			free(data_in);
-			data_in = NULL;
-		}
-	}
+			int dims[8] = { 0, -1, -1, -1, -1, -1, -1, -1 };
+			// set time slice to 0 for any data set with dimensionality greater than 3
+			if (this->_volume->ndim > 3) dims[4] = 0;
+
+			double localMin = INFINITY;
+			double localMax = -INFINITY;
+			try
+			{
+				while (!abort)
+				{
+					const unsigned long long int slice = nextSlice++;
+					if (slice >= scanDim->getNumberOfSlices())
+						break;
+					dims[1+ind] = slice;
+
+					void *data_in = NULL;
+					int ret = nifti_read_collapsed_image(this->_volume, dims, &data_in);
+					if (ret < 0)
+						THROW_TS_EXCEPTION(
+							tissuestack::common::TissueStackApplicationException,
+							"Failed to read NIFTI file!");
+
+					//sanity check
+					if (static_cast<unsigned long long int>(ret) != expected_bytes)
+					{
+						if (data_in) free(data_in);
+						THROW_TS_EXCEPTION(
+							tissuestack::common::TissueStackApplicationException,
+							"NIFTI read: number of read bytes does not match expected bytes!");
+					}
+
+					switch (this->_volume->datatype) {
+						case NIFTI_TYPE_INT8: // signed char
+							this->findMinMax<char>(data_in, size_per_slice, localMin, localMax);
+							break;
+						case NIFTI_TYPE_UINT16: // unsigned short
+							this->findMinMax<unsigned short>(data_in, size_per_slice, localMin, localMax);
+							break;
+						case NIFTI_TYPE_UINT32: // unsigned int
+							this->findMinMax<unsigned int>(data_in, size_per_slice, localMin, localMax);
+							break;
+						case NIFTI_TYPE_INT16: // signed short
+							this->findMinMax<short>(data_in, size_per_slice, localMin, localMax);
+							break;
+						case NIFTI_TYPE_INT32: // signed int
+							this->findMinMax<int>(data_in, size_per_slice, localMin, localMax);
+							break;
+						case NIFTI_TYPE_UINT64: // unsigned long long
+							this->findMinMax<unsigned long long int>(data_in, size_per_slice, localMin, localMax);
+							break;
+						case NIFTI_TYPE_INT64: // signed long long
+							this->findMinMax<long long int>(data_in, size_per_slice, localMin, localMax);
+							break;
+						case NIFTI_TYPE_FLOAT32: //	float
+							this->findMinMax<float>(data_in, size_per_slice, localMin, localMax);
+							break;
+						case NIFTI_TYPE_FLOAT64: //	double
+							this->findMinMax<double>(data_in, size_per_slice, localMin, localMax);
+							break;
+						case NIFTI_TYPE_FLOAT128: // long double
+							this->findMinMax<long double>(data_in, size_per_slice, localMin, localMax);
+							break;
+					}
+
+					if (data_in != NULL)
+						free(data_in);
+				}
+			} catch (...)
+			{
+				std::lock_guard<std::mutex> lock(mergeMutex);
+				if (!failure)
+					failure = std::current_exception();
+				abort = true;
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(mergeMutex);
+			if (localMin < min) min = localMin;
+			if (localMax > max) max = localMax;
+		};
+
+	std::vector<std::thread> workers;
+	for (unsigned short i=1;i<numberOfThreads;i++)
+		workers.push_back(std::thread(worker));
+	worker();
+	for (auto & w : workers)
+		w.join();
+
+	if (failure)
+		std::rethrow_exception(failure);
+
+	this->_min = min;
+	this->_max = max;
+	this->_has_min_max = true;
 }
@@ -0,0 +1,270 @@
+/*
+ * This file is part of TissueStack.
+ *
+ * TissueStack is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TissueStack is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TissueStack.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "networking.h"
+#include "imaging.h"
+#include "database.h"
+
+tissuestack::imaging::TissueStackPreTiledTileStore::TissueStackPreTiledTileStore() :
+	_hits(0), _misses(0), _not_modified(0)
+{
+	this->_tile_directory =
+		tissuestack::database::ConfigurationDataProvider::findSpecificApplicationDirectory("server_tile_directory");
+
+	tissuestack::logging::TissueStackLogger::instance()->info(
+		"Pre-Tiled Tiles served from: %s\n",
+		this->_tile_directory.empty() ? "<nowhere>" : this->_tile_directory.c_str());
+}
+
+tissuestack::imaging::TissueStackPreTiledTileStore * tissuestack::imaging::TissueStackPreTiledTileStore::instance()
+{
+	if (tissuestack::imaging::TissueStackPreTiledTileStore::_instance == nullptr)
+		tissuestack::imaging::TissueStackPreTiledTileStore::_instance = new tissuestack::imaging::TissueStackPreTiledTileStore();
+
+	return tissuestack::imaging::TissueStackPreTiledTileStore::_instance;
+}
+
+const bool tissuestack::imaging::TissueStackPreTiledTileStore::doesInstanceExist()
+{
+	return (tissuestack::imaging::TissueStackPreTiledTileStore::_instance != nullptr);
+}
+
+void tissuestack::imaging::TissueStackPreTiledTileStore::purgeInstance()
+{
+	delete tissuestack::imaging::TissueStackPreTiledTileStore::_instance;
+	tissuestack::imaging::TissueStackPreTiledTileStore::_instance = nullptr;
+}
+
+inline const int tissuestack::imaging::TissueStackPreTiledTileStore::findZoomLevel(
+	const tissuestack::imaging::TissueStackImageData * image_data,
+	const float scale_factor) const
+{
+	const std::vector<float> zoomLevels = image_data->getZoomLevels();
+	for (unsigned int z=0;z<zoomLevels.size();z++)
+		if (fabs(zoomLevels[z] - scale_factor) < 0.00001)
+			return static_cast<int>(z);
+
+	return -1;
+}
+
+inline std::shared_ptr<const tissuestack::imaging::TissueStackTileArchive>
+	tissuestack::imaging::TissueStackPreTiledTileStore::findArchive(
+		const std::string & archive_path,
+		unsigned long long int & inode)
+{
+	std::lock_guard<std::mutex> lock(this->_archives_mutex);
+
+	const unsigned long long int now = tissuestack::utils::System::getSystemTimeInMillis();
+	auto existing = this->_archives.find(archive_path);
+	if (existing != this->_archives.end())
+	{
+		OpenArchive & open = existing->second;
+		// archives that are still being tiled into are reopened to pick up the new tiles,
+		// every so often we also look for archives that have been created or replaced meanwhile
+		bool stale = open.archive && open.archive->hasBeenAppendedTo();
+		if (!stale &&
+			now - open.checked_at > tissuestack::imaging::TissueStackPreTiledTileStore::RECHECK_ARCHIVE_INTERVAL_IN_MILLIS)
+		{
+			struct stat dataStat;
+			const bool exists =
+				stat((archive_path + tissuestack::imaging::TissueStackTileArchive::DATA_SUFFIX).c_str(), &dataStat) == 0;
+			stale =
+				open.archive ?
+					(!exists || static_cast<unsigned long long int>(dataStat.st_ino) != open.inode) :
+					exists;
+			open.checked_at = now;
+		}
+		if (!stale)
+		{
+			inode = open.inode;
+			return open.archive;
+		}
+	}
+
+	OpenArchive open = { nullptr, 0, now };
+	struct stat dataStat;
+	if (stat((archive_path + tissuestack::imaging::TissueStackTileArchive::DATA_SUFFIX).c_str(), &dataStat) == 0 &&
+		tissuestack::utils::System::fileExists(archive_path + tissuestack::imaging::TissueStackTileArchive::INDEX_SUFFIX))
+	{
+		try
+		{
+			open.archive.reset(new tissuestack::imaging::TissueStackTileArchive(archive_path));
+			open.inode = static_cast<unsigned long long int>(dataStat.st_ino);
+		} catch (std::exception & bad)
+		{
+			tissuestack::logging::TissueStackLogger::instance()->error(
+				"Failed to open tile archive %s: %s\n", archive_path.c_str(), bad.what());
+		}
+	}
+	this->_archives[archive_path] = open;
+
+	inode = open.inode;
+	return open.archive;
+}
+
+const bool tissuestack::imaging::TissueStackPreTiledTileStore::serveTile(
+	const tissuestack::imaging::TissueStackImageData * image_data,
+	const tissuestack::networking::TissueStackImageRequest * request,
+	const int file_descriptor)
+{
+	if (image_data == nullptr || !image_data->isTiled() || this->_tile_directory.empty())
+		return false;
+
+	// pre-tiling knows nothing about contrast
+	if (!(request->getContrastMinimum() == 0 && request->getContrastMaximum() == 255))
+		return false;
+
+	const int zoomLevel = this->findZoomLevel(image_data, request->getScaleFactor());
+	if (zoomLevel < 0)
+		return false;
+
+	// the pre-tiler writes full quality tiles and the whole slice, degraded to 5%, as preview
+	unsigned int x = 0;
+	unsigned int y = 0;
+	if (request->isPreview())
+	{
+		if (request->showOnlyPortionOfImage() || fabs(request->getQualityFactor() - 0.05) > 0.00001)
+			return false;
+		x = y = tissuestack::imaging::TissueStackTileArchive::PREVIEW;
+	} else
+	{
+		if (request->getQualityFactor() < static_cast<const float>(1.0))
+			return false;
+		x = request->getXCoordinate();
+		y = request->getYCoordinate();
+	}
+
+	std::string formatLowerCase =  request->getOutputImageFormat();
+	std::transform(formatLowerCase.begin(), formatLowerCase.end(), formatLowerCase.begin(), tolower);
+	const std::string colorMap = request->getColorMapName();
+	const std::string tileDir =
+		this->_tile_directory + "/" + std::to_string(image_data->getDataBaseId());
+
+	int fd = -1;
+	bool closeFd = false;
+	unsigned long long int offset = 0;
+	unsigned long long int length = 0;
+	std::ostringstream entityTag;
+
+	// archives first
+	unsigned long long int inode = 0;
+	const std::shared_ptr<const tissuestack::imaging::TissueStackTileArchive> archive =
+		this->findArchive(
+			tissuestack::imaging::TissueStackTileArchive::composeArchivePath(
+				tileDir, static_cast<unsigned short>(zoomLevel), request->getDimensionName(), colorMap, formatLowerCase),
+			inode);
+	if (archive &&
+		(request->isPreview() || archive->getSquareLength() == request->getLengthOfSquare()) &&
+		archive->findTile(request->getSliceNumber(), x, y, offset, length))
+	{
+		fd = archive->getDataDescriptor();
+		// append only: a tile's bytes never change at a given offset
+		entityTag << "\"" << std::hex << inode << "-" << offset << "-" << length << "\"";
+	} else if (!archive && (request->isPreview() ||
+			request->getLengthOfSquare() == tissuestack::imaging::TissueStackPreTiledTileStore::LEGACY_SQUARE_LENGTH))
+	{
+		// individual files (older tilings or pre_tiling_storage = files)
+		const bool colorMapped =
+			!colorMap.empty() && colorMap.compare("grey") != 0 && colorMap.compare("gray") != 0;
+		std::ostringstream fileName;
+		fileName << tileDir << "/" << zoomLevel << "/" << request->getDimensionName().substr(0,1)
+			<< "/" << request->getSliceNumber() << "/";
+		if (request->isPreview())
+			fileName << request->getSliceNumber() << ".low.res." << (colorMapped ? colorMap + "." : "");
+		else
+			fileName << x << "_" << y << (colorMapped ? "_" + colorMap : "") << ".";
+		fileName << formatLowerCase;
+
+		fd = open(fileName.str().c_str(), O_RDONLY);
+		struct stat fileStat;
+		if (fd >= 0 && fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode))
+		{
+			closeFd = true;
+			length = static_cast<unsigned long long int>(fileStat.st_size);
+			entityTag << "\"" << std::hex << fileStat.st_ino << "-" << fileStat.st_mtime << "-" << length << "\"";
+		} else if (fd >= 0)
+		{
+			close(fd);
+			fd = -1;
+		}
+	}
+
+	if (fd < 0)
+	{
+		this->_misses++;
+		return false;
+	}
+	this->_hits++;
+
+	const std::string contentType = std::string("image/") + formatLowerCase;
+	bool success = true;
+
+	// conditional request: the client has the very same bytes already
+	if (tissuestack::utils::Misc::matchesEntityTag(request->getRequestHeader("If-None-Match"), entityTag.str()))
+	{
+		this->_not_modified++;
+		success =
+			tissuestack::utils::Misc::writeHttpResponse(
+				file_descriptor,
+				tissuestack::utils::Misc::composeHttpResponseHeader(
+					"304 Not Modified", contentType, 0, request->isKeepAlive(), false, entityTag.str()));
+	} else
+		success =
+			tissuestack::utils::Misc::writeHttpResponseFromFile(
+				file_descriptor,
+				tissuestack::utils::Misc::composeHttpResponseHeader(
+					"200 OK", contentType, length, request->isKeepAlive(), false, entityTag.str()),
+				fd,
+				offset,
+				length);
+
+	if (closeFd)
+		close(fd);
+
+	if (!success)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Failed to write pre-tiled image response!");
+
+	return true;
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackPreTiledTileStore::getNumberOfHits() const
+{
+	return this->_hits.load();
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackPreTiledTileStore::getNumberOfMisses() const
+{
+	return this->_misses.load();
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackPreTiledTileStore::getNumberOfNotModifiedResponses() const
+{
+	return this->_not_modified.load();
+}
+
+const std::string tissuestack::imaging::TissueStackPreTiledTileStore::getStatisticsAsJson() const
+{
+	std::ostringstream json;
+	json << "{ \"hits\": " << this->getNumberOfHits();
+	json << ", \"misses\": " << this->getNumberOfMisses();
+	json << ", \"not_modified\": " << this->getNumberOfNotModifiedResponses();
+	json << " }";
+
+	return json.str();
+}
+
+tissuestack::imaging::TissueStackPreTiledTileStore * tissuestack::imaging::TissueStackPreTiledTileStore::_instance = nullptr;
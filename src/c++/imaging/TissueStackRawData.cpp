@@ -19,7 +19,7 @@
 
 tissuestack::imaging::TissueStackRawData::~TissueStackRawData()
 {
-
+	this->unmapFromMemory();
 }
 
 const bool tissuestack::imaging::TissueStackRawData::isRaw() const
@@ -322,3 +322,116 @@ const unsigned long long int tissuestack::imaging::TissueStackRawData::getFileSi
 {
 	return tissuestack::utils::System::getFileSizeInBytes(this->getFileName());
 }
+
+void tissuestack::imaging::TissueStackRawData::mapIntoMemory()
+{
+	if (this->_mapped_data != nullptr) return;
+
+	const int fd = this->getFileDescriptor();
+	struct stat fileStats;
+	if (fd < 0 || fstat(fd, &fileStats) != 0 || fileStats.st_size <= 0)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Could not determine size of RAW file for memory mapping!");
+
+	void * mapping = mmap(NULL, fileStats.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (mapping == MAP_FAILED)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Could not memory map RAW file!");
+
+	this->_mapped_data = static_cast<const unsigned char *>(mapping);
+	this->_mapped_size = static_cast<unsigned long long int>(fileStats.st_size);
+
+	// each plane stack is read with a different locality => advise the kernel per dimension
+	for (auto dim : this->getDimensionMap())
+		this->adviseMappedDimension(dim.second);
+}
+
+inline void tissuestack::imaging::TissueStackRawData::adviseMappedDimension(
+	const tissuestack::imaging::TissueStackDataDimension * dimension) const
+{
+	if (dimension == nullptr || this->_mapped_data == nullptr) return;
+
+	std::string advice =
+		tissuestack::TissueStackConfigurationParameters::instance()->getParameter(
+			std::string("mmap_advice_") + dimension->getName().at(0));
+	std::transform(advice.begin(), advice.end(), advice.begin(), tolower);
+
+	int madviseFlag = MADV_NORMAL;
+	if (advice.empty() || advice.compare("normal") == 0)
+		return;
+	else if (advice.compare("random") == 0)
+		madviseFlag = MADV_RANDOM;
+	else if (advice.compare("sequential") == 0)
+		madviseFlag = MADV_SEQUENTIAL;
+	else if (advice.compare("willneed") == 0)
+		madviseFlag = MADV_WILLNEED;
+	else
+	{
+		tissuestack::logging::TissueStackLogger::instance()->error(
+			"Unknown mmap advice '%s' for dimension %s\n", advice.c_str(), dimension->getName().c_str());
+		return;
+	}
+
+	unsigned long long int multiplier = 1;
+	if (this->getType() != tissuestack::imaging::RAW_TYPE::UCHAR_8_BIT)
+		multiplier = 3;
+
+	// madvise wants a page aligned start address
+	const unsigned long long int pageSize = static_cast<unsigned long long int>(sysconf(_SC_PAGESIZE));
+	const unsigned long long int alignedOffset = dimension->getOffset() - (dimension->getOffset() % pageSize);
+	if (alignedOffset >= this->_mapped_size) return;
+
+	unsigned long long int length =
+		(dimension->getOffset() - alignedOffset) +
+		dimension->getNumberOfSlices() * dimension->getSliceSize() * multiplier;
+	if (alignedOffset + length > this->_mapped_size)
+		length = this->_mapped_size - alignedOffset;
+
+	if (madvise(
+			const_cast<unsigned char *>(this->_mapped_data) + alignedOffset,
+			length,
+			madviseFlag) != 0)
+		tissuestack::logging::TissueStackLogger::instance()->error(
+			"Failed to apply mmap advice '%s' for dimension %s\n", advice.c_str(), dimension->getName().c_str());
+}
+
+void tissuestack::imaging::TissueStackRawData::unmapFromMemory()
+{
+	if (this->_mapped_data == nullptr) return;
+
+	munmap(const_cast<unsigned char *>(this->_mapped_data), this->_mapped_size);
+	this->_mapped_data = nullptr;
+	this->_mapped_size = 0;
+}
+
+const bool tissuestack::imaging::TissueStackRawData::isMappedIntoMemory() const
+{
+	return this->_mapped_data != nullptr;
+}
+
+const bool tissuestack::imaging::TissueStackRawData::isWithinMappedMemory(const unsigned char * data) const
+{
+	if (this->_mapped_data == nullptr || data == nullptr) return false;
+
+	return (data >= this->_mapped_data && data < this->_mapped_data + this->_mapped_size);
+}
+
+const unsigned char * tissuestack::imaging::TissueStackRawData::getMappedSlice(
+	const tissuestack::imaging::TissueStackDataDimension * dimension,
+	const unsigned long int slice) const
+{
+	if (this->_mapped_data == nullptr || dimension == nullptr) return nullptr;
+
+	unsigned long long int multiplier = 1;
+	if (this->getType() != tissuestack::imaging::RAW_TYPE::UCHAR_8_BIT)
+		multiplier = 3;
+
+	const unsigned long long int sliceLength = dimension->getSliceSize() * multiplier;
+	const unsigned long long int offset =
+		dimension->getOffset() + static_cast<unsigned long long int>(slice) * sliceLength;
+
+	// the file is shorter than its header claims it to be
+	if (offset + sliceLength > this->_mapped_size) return nullptr;
+
+	return this->_mapped_data + offset;
+}
@@ -17,48 +17,30 @@
 #include "networking.h"
 #include "imaging.h"
 
-const unsigned long long int tissuestack::imaging::TissueStackSliceCache::MINIMUM_FREE_RAM_IN_BYTES = 500 * 1000 * 1024;
-const unsigned long long int tissuestack::imaging::TissueStackSliceCache::SECOND_IN_MILLIS = 1000;
-const unsigned long long int tissuestack::imaging::TissueStackSliceCache::MINUTE_IN_MILLIS =
-	tissuestack::imaging::TissueStackSliceCache::SECOND_IN_MILLIS * 60;
-const unsigned long long int tissuestack::imaging::TissueStackSliceCache::HOUR_IN_MILLIS =
-	tissuestack::imaging::TissueStackSliceCache::MINUTE_IN_MILLIS * 60;
-const unsigned long long int tissuestack::imaging::TissueStackSliceCache::DAY_IN_MILLIS =
-	tissuestack::imaging::TissueStackSliceCache::HOUR_IN_MILLIS * 24;
-const unsigned long long int tissuestack::imaging::TissueStackSliceCache::WEEK_IN_MILLIS =
-	tissuestack::imaging::TissueStackSliceCache::DAY_IN_MILLIS * 7;
-const unsigned long long int tissuestack::imaging::TissueStackSliceCache::MONTH_IN_MILLIS =
-	tissuestack::imaging::TissueStackSliceCache::WEEK_IN_MILLIS * 30;
+const unsigned short tissuestack::imaging::TissueStackSliceCache::NUMBER_OF_SHARDS = 16;
+const unsigned long long int tissuestack::imaging::TissueStackSliceCache::IDLE_TIME_IN_MILLIS = 1000 * 60 * 60;
 
 tissuestack::imaging::TissueStackSliceCache::~TissueStackSliceCache()
 {
-	std::lock_guard<std::mutex> lock(this->_cache_mutex);
-	this->_is_being_cleaned = true;
-
-	// loop over all data sets and cache entries and delete them
-	for (auto cached_dataset : this->_cache)
-		if (cached_dataset.second) delete cached_dataset.second;
-
-	this->_is_being_cleaned = false;
+	// the entries are cleaned up by their shared pointers
+	delete [] this->_shards;
 }
 
-tissuestack::imaging::TissueStackSliceCache::TissueStackSliceCache() : _is_being_cleaned(false), _is_empty(true)
+tissuestack::imaging::TissueStackSliceCache::TissueStackSliceCache() :
+	_size(0), _hits(0), _misses(0), _evictions(0), _coalesced_misses(0)
 {
-	// we take the existing data sets and build up a cache structure
-	if (!tissuestack::imaging::TissueStackDataSetStore::doesInstanceExist())
-		return;
-
-	this->_is_being_cleaned = true;
-
-	// we take the existing data sets and build up a cache structure
-	const std::vector<const tissuestack::imaging::TissueStackRawData * > dataSets =
-		tissuestack::imaging::TissueStackDataSetStore::instance()->getDataSetList();
-
-	// initialize cache
-	for (auto ds : dataSets)
-		this->_cache[ds->getFileName()] = new tissuestack::imaging::DataSetSliceCache(ds);
-
-	this->_is_being_cleaned = false;
+	unsigned long long int capacity =
+		strtoull(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("slice_cache_size").c_str(), NULL, 10);
+	capacity *= 1024 * 1024; // configured in megabytes
+
+	this->_shards = new CacheShard[tissuestack::imaging::TissueStackSliceCache::NUMBER_OF_SHARDS];
+	for (unsigned short i=0;i<tissuestack::imaging::TissueStackSliceCache::NUMBER_OF_SHARDS;i++)
+		this->_shards[i].size = 0;
+	this->_capacity_per_shard = capacity / tissuestack::imaging::TissueStackSliceCache::NUMBER_OF_SHARDS;
+
+	tissuestack::logging::TissueStackLogger::instance()->info(
+		"Slice Cache Capacity: %llu bytes in %u shards\n",
+		this->getCapacityInBytes(), tissuestack::imaging::TissueStackSliceCache::NUMBER_OF_SHARDS);
 }
 
 tissuestack::imaging::TissueStackSliceCache * tissuestack::imaging::TissueStackSliceCache::instance()
@@ -80,206 +62,231 @@ void tissuestack::imaging::TissueStackSliceCache::purgeInstance()
 	tissuestack::imaging::TissueStackSliceCache::_instance = nullptr;
 }
 
-const bool tissuestack::imaging::TissueStackSliceCache::addCacheEntry(
-	const std::string dataset, const unsigned long int slice, const unsigned char * data)
+inline tissuestack::imaging::TissueStackSliceCache::CacheShard & tissuestack::imaging::TissueStackSliceCache::findShard(
+	const std::string & key) const
 {
-	if (this->isBeingCleanedUp() || dataset.empty() || data == nullptr)
-			return false;
-
-	if (tissuestack::utils::System::getFreeRam() < tissuestack::imaging::TissueStackSliceCache::MINIMUM_FREE_RAM_IN_BYTES)
-		return false;
-
-	std::lock_guard<std::mutex> lock(this->_cache_mutex);
-
-	bool oldStatus = this->_is_empty;
+	return this->_shards[std::hash<std::string>()(key) % tissuestack::imaging::TissueStackSliceCache::NUMBER_OF_SHARDS];
+}
 
-	try
+inline void tissuestack::imaging::TissueStackSliceCache::evictLeastRecentlyUsed(
+	CacheShard & shard, const unsigned long long int room_needed)
+{
+	// caller holds the shard lock
+	while (!shard.lru.empty() && shard.size + room_needed > this->_capacity_per_shard)
 	{
-		this->_is_empty = false;
-		tissuestack::imaging::DataSetSliceCache * cache = this->_cache.at(dataset);
-		cache->setMostRecentCacheFailure(-1);
-		return cache->setSlice(slice, new tissuestack::imaging::SliceCacheEntry(data));
-	} catch (std::out_of_range & not_found) {
-		// we did not have this data set before => add it to cache structure
-		try
-		{
-			const tissuestack::imaging::TissueStackDataSet * ds =
-				tissuestack::imaging::TissueStackDataSetStore::instance()->findDataSet(dataset);
-			if (ds == nullptr || ds->getImageData() == nullptr || !ds->getImageData()->isRaw()) return false;
-
-			this->_cache[ds->getDataSetId()] =
-				new tissuestack::imaging::DataSetSliceCache(
-					static_cast<const tissuestack::imaging::TissueStackRawData *>(ds->getImageData()));
-			return this->_cache[ds->getDataSetId()]->setSlice(slice, new tissuestack::imaging::SliceCacheEntry(data));
-		} catch (std::exception & ex) {
-			this->_is_empty = oldStatus;
-			tissuestack::logging::TissueStackLogger::instance()->error(
-					"Unable to add new dataset %s to cache: %s", dataset.c_str(), ex.what());
-			return false;
-		}
+		const CachedSlice & victim = shard.lru.back();
+		shard.size -= victim.entry->getSize();
+		this->_size -= victim.entry->getSize();
+		shard.index.erase(victim.key);
+		shard.lru.pop_back();
+		this->_evictions++;
 	}
+}
 
-	this->_is_empty = oldStatus;
-	return false;
+inline void tissuestack::imaging::TissueStackSliceCache::insertIntoShard(
+	CacheShard & shard, const std::string & key, const std::string & dataset,
+	const std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> & entry)
+{
+	// caller holds the shard lock, entries beyond the shard's budget are not admitted
+	if (entry->getSize() == 0 || entry->getSize() > this->_capacity_per_shard ||
+		shard.index.find(key) != shard.index.end())
+		return;
+
+	this->evictLeastRecentlyUsed(shard, entry->getSize());
+
+	shard.lru.push_front({ key, dataset, entry, tissuestack::utils::System::getSystemTimeInMillis() });
+	shard.index[key] = shard.lru.begin();
+	shard.size += entry->getSize();
+	this->_size += entry->getSize();
 }
 
-const unsigned char *  tissuestack::imaging::TissueStackSliceCache::findCacheEntry(
+std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> tissuestack::imaging::TissueStackSliceCache::findCacheEntry(
 	const std::string dataset, const unsigned long int slice)
 {
-	if (this->isBeingCleanedUp() || dataset.empty() || this->_is_empty)
+	if (dataset.empty())
 		return nullptr;
 
-	try
-	{
-		tissuestack::imaging::DataSetSliceCache * cache = this->_cache.at(dataset);
+	const std::string key = dataset + ":" + std::to_string(slice);
+	CacheShard & shard = this->findShard(key);
+	std::lock_guard<std::mutex> lock(shard.mutex);
 
-		int waitLimit = 10000000;
-		while (waitLimit > 0 && cache->getMostRecentCacheFailure() == static_cast<long int>(slice))
-		{
-			usleep(100000); // 100,000 micro seconds /100 milli seconds
-			waitLimit -= 100000;
-		}
-	} catch (std::out_of_range & not_found) {
+	auto hit = shard.index.find(key);
+	if (hit == shard.index.end())
+	{
+		this->_misses++;
 		return nullptr;
 	}
 
-	std::lock_guard<std::mutex> lock(this->_cache_mutex);
+	// move to front: most recently used
+	shard.lru.splice(shard.lru.begin(), shard.lru, hit->second);
+	hit->second->timestamp_accessed = tissuestack::utils::System::getSystemTimeInMillis();
+	this->_hits++;
 
-	try
-	{
-		// look up data set
-		tissuestack::imaging::DataSetSliceCache * cache = this->_cache.at(dataset);
-		tissuestack::imaging::SliceCacheEntry * cached_slice = cache->getSlice(slice);
-		if (cached_slice == nullptr)
-		{
-			cache->setMostRecentCacheFailure(slice);
-			return nullptr;
-		}
-		return cached_slice->getCacheData();
-	} catch (std::out_of_range & not_found) {
-		return nullptr;
-	}
+	return hit->second->entry;
 }
 
-void tissuestack::imaging::TissueStackSliceCache::cleanUpCache()
+std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> tissuestack::imaging::TissueStackSliceCache::findOrLoadCacheEntry(
+	const std::string dataset, const unsigned long int slice,
+	const std::function<std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> ()> & loader)
 {
-	if (this->isBeingCleanedUp() || this->_is_empty)
-		return;
+	if (dataset.empty())
+		return loader();
 
-	std::lock_guard<std::mutex> lock(this->_cache_mutex);
+	const std::string key = dataset + ":" + std::to_string(slice);
+	CacheShard & shard = this->findShard(key);
 
-	this->_is_being_cleaned = true;
-
-	unsigned long int count = 0;
-
-	// let's use this strategy for now: access time loop down to 5 minutes
-	// with repeated checks whether we bring the free ram back up to exceed our threshold
-	unsigned long long int ACCESS_TIMES[] =
+	std::shared_ptr<std::promise<std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> > > promise;
+	std::shared_future<std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> > pending;
 	{
-		tissuestack::imaging::TissueStackSliceCache::MONTH_IN_MILLIS,
-		tissuestack::imaging::TissueStackSliceCache::WEEK_IN_MILLIS,
-		tissuestack::imaging::TissueStackSliceCache::DAY_IN_MILLIS,
-		tissuestack::imaging::TissueStackSliceCache::HOUR_IN_MILLIS,
-		tissuestack::imaging::TissueStackSliceCache::MINUTE_IN_MILLIS * 5
-	};
-
-	const unsigned long long int NOW = tissuestack::utils::System::getSystemTimeInMillis();
+		std::lock_guard<std::mutex> lock(shard.mutex);
 
-	for (auto t : ACCESS_TIMES)
-	{
-		for (auto cached_dataset : this->_cache)
+		auto hit = shard.index.find(key);
+		if (hit != shard.index.end())
 		{
-			tissuestack::imaging::DataSetSliceCache * cache = cached_dataset.second;
-			for (unsigned int x=0;x<cache->getNumberOfCachedSlices();x++)
-				if (cache->isSliceCached(x) && (NOW - cache->getSlice(x)->getTimeStampForLastAccess() > t))
-				{
-					cache->eraseSlice(x);
-					count++;
-				}
+			shard.lru.splice(shard.lru.begin(), shard.lru, hit->second);
+			hit->second->timestamp_accessed = tissuestack::utils::System::getSystemTimeInMillis();
+			this->_hits++;
+			return hit->second->entry;
 		}
+		this->_misses++;
 
-		if (tissuestack::utils::System::getFreeRam() > tissuestack::imaging::TissueStackSliceCache::MINIMUM_FREE_RAM_IN_BYTES)
+		auto loading = shard.loading.find(key);
+		if (loading != shard.loading.end())
 		{
-			if (count > 0)
-				tissuestack::logging::TissueStackLogger::instance()->info("Freed %lu cache entries.", count);
-
-			this->_is_being_cleaned = false;
-			return;
+			// somebody is reading this slice already
+			pending = loading->second;
+			this->_coalesced_misses++;
+		} else
+		{
+			promise.reset(new std::promise<std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> >());
+			pending = promise->get_future().share();
+			shard.loading[key] = pending;
 		}
 	}
 
-	double ACCESS_PERCENTAGES[] =
+	// wait for the loading thread, a failure is rethrown here too
+	if (!promise)
+		return pending.get();
+
+	std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> entry;
+	try
 	{
-		0.5, // 50 % of most accessed slice
-		0.4, // 40 % of most accessed slice
-		0.3, // etc.
-		0.2,
-		0.1
-	};
-
-	// should the above strategy fail to free sufficient memory the slice cache access numbers become the crucial criterion
-	// we do this over each data set separately and loop in percentages of highest access number
-	for (auto p : ACCESS_PERCENTAGES)
+		entry = loader();
+	} catch (...)
 	{
-		for (auto cached_dataset : this->_cache)
 		{
-			tissuestack::imaging::DataSetSliceCache * cache = cached_dataset.second;
-
-			// this loop determines the most frequently accessed entry
-			unsigned long long int highest_access_count = 0;
-			for (unsigned int x=0;x<cache->getNumberOfCachedSlices();x++)
-				if (cache->isSliceCached(x) && cache->getSlice(x)->getAccessCount() > highest_access_count)
-					highest_access_count = cache->getSlice(x)->getAccessCount();
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			shard.loading.erase(key);
+		}
+		promise->set_exception(std::current_exception());
+		throw;
+	}
 
-			// now delete those entries that are below the percentage
-			unsigned long long int threshold =
-				static_cast<unsigned long long int>(static_cast<double>(highest_access_count) * p);
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (entry)
+			this->insertIntoShard(shard, key, dataset, entry);
+		shard.loading.erase(key);
+	}
+	promise->set_value(entry);
 
-			if (threshold == 0)
-				continue;
+	return entry;
+}
 
-			for (unsigned int x=0;x<cache->getNumberOfCachedSlices();x++)
-				if (cache->isSliceCached(x) && cache->getSlice(x)->getAccessCount() < threshold &&
-						(NOW - cache->getSlice(x)->getTimeStampForLastAccess() > 10000))
-				{
-					cache->eraseSlice(x);
-					count++;
-				}
-		}
+void tissuestack::imaging::TissueStackSliceCache::evictDataSet(const std::string dataset)
+{
+	for (unsigned short i=0;i<tissuestack::imaging::TissueStackSliceCache::NUMBER_OF_SHARDS;i++)
+	{
+		CacheShard & shard = this->_shards[i];
+		std::lock_guard<std::mutex> lock(shard.mutex);
 
-		// we've free enough, let's leave ...
-		if (tissuestack::utils::System::getFreeRam() > tissuestack::imaging::TissueStackSliceCache::MINIMUM_FREE_RAM_IN_BYTES)
+		for (auto cached = shard.lru.begin(); cached != shard.lru.end();)
 		{
-			if (count > 0)
-				tissuestack::logging::TissueStackLogger::instance()->info("Freed %lu cache entries.", count);
-
-			this->_is_being_cleaned = false;
-			return;
+			if (cached->dataset.compare(dataset) != 0)
+			{
+				++cached;
+				continue;
+			}
+			shard.size -= cached->entry->getSize();
+			this->_size -= cached->entry->getSize();
+			shard.index.erase(cached->key);
+			cached = shard.lru.erase(cached);
+			this->_evictions++;
 		}
 	}
+}
+
+void tissuestack::imaging::TissueStackSliceCache::cleanUpCache()
+{
+	// give memory back that has not been asked for in a long time
+	const unsigned long long int NOW = tissuestack::utils::System::getSystemTimeInMillis();
+	unsigned long int count = 0;
 
-	// still not good enough => empty entire cache
-	for (auto cached_dataset : this->_cache)
+	for (unsigned short i=0;i<tissuestack::imaging::TissueStackSliceCache::NUMBER_OF_SHARDS;i++)
 	{
-		tissuestack::imaging::DataSetSliceCache * cache = cached_dataset.second;
-		for (unsigned int x=0;x<cache->getNumberOfCachedSlices();x++)
-			if (cache->isSliceCached(x))
-			{
-				cache->eraseSlice(x);
-				count++;
-			}
+		CacheShard & shard = this->_shards[i];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		// the least recently used are at the back
+		while (!shard.lru.empty() &&
+			NOW - shard.lru.back().timestamp_accessed > tissuestack::imaging::TissueStackSliceCache::IDLE_TIME_IN_MILLIS)
+		{
+			const CachedSlice & victim = shard.lru.back();
+			shard.size -= victim.entry->getSize();
+			this->_size -= victim.entry->getSize();
+			shard.index.erase(victim.key);
+			shard.lru.pop_back();
+			this->_evictions++;
+			count++;
+		}
 	}
-	this->_is_empty = true;
 
 	if (count > 0)
-		tissuestack::logging::TissueStackLogger::instance()->info("Freed %lu cache entries.", count);
+		tissuestack::logging::TissueStackLogger::instance()->info("Freed %lu idle cache entries.\n", count);
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackSliceCache::getCapacityInBytes() const
+{
+	return this->_capacity_per_shard * tissuestack::imaging::TissueStackSliceCache::NUMBER_OF_SHARDS;
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackSliceCache::getSizeInBytes() const
+{
+	return this->_size.load();
+}
 
-	this->_is_being_cleaned = false;
+const unsigned long long int tissuestack::imaging::TissueStackSliceCache::getNumberOfHits() const
+{
+	return this->_hits.load();
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackSliceCache::getNumberOfMisses() const
+{
+	return this->_misses.load();
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackSliceCache::getNumberOfEvictions() const
+{
+	return this->_evictions.load();
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackSliceCache::getNumberOfCoalescedMisses() const
+{
+	return this->_coalesced_misses.load();
 }
 
-const bool tissuestack::imaging::TissueStackSliceCache::isBeingCleanedUp() const
+const std::string tissuestack::imaging::TissueStackSliceCache::getStatisticsAsJson() const
 {
-	return this->_is_being_cleaned;
+	std::ostringstream json;
+	json << "{ \"capacity\": " << this->getCapacityInBytes();
+	json << ", \"size\": " << this->getSizeInBytes();
+	json << ", \"hits\": " << this->getNumberOfHits();
+	json << ", \"misses\": " << this->getNumberOfMisses();
+	json << ", \"evictions\": " << this->getNumberOfEvictions();
+	json << ", \"coalesced_misses\": " << this->getNumberOfCoalescedMisses();
+	json << " }";
+
+	return json.str();
 }
 
 tissuestack::imaging::TissueStackSliceCache * tissuestack::imaging::TissueStackSliceCache::_instance = nullptr;
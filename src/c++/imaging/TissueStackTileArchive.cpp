@@ -0,0 +1,245 @@
+/*
+ * This file is part of TissueStack.
+ *
+ * TissueStack is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TissueStack is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TissueStack.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "networking.h"
+#include "imaging.h"
+
+const char tissuestack::imaging::TissueStackTileArchive::MAGIC[8] = { 'T', 'S', 'T', 'I', 'L', 'E', '0', '1' };
+const std::string tissuestack::imaging::TissueStackTileArchive::DATA_SUFFIX = ".tiles";
+const std::string tissuestack::imaging::TissueStackTileArchive::INDEX_SUFFIX = ".tiles.idx";
+
+tissuestack::imaging::TissueStackTileArchive::TissueStackTileArchive(
+	const std::string & archive_path, const bool for_writing, const unsigned int square_length) :
+		_archive_path(archive_path), _for_writing(for_writing), _square_length(square_length)
+{
+	const std::string dataFile = archive_path + tissuestack::imaging::TissueStackTileArchive::DATA_SUFFIX;
+	const std::string indexFile = archive_path + tissuestack::imaging::TissueStackTileArchive::INDEX_SUFFIX;
+
+	if (for_writing)
+	{
+		this->_data_fd = open(dataFile.c_str(), O_WRONLY | O_CREAT, 0644);
+		this->_index_fd = open(indexFile.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+	} else
+	{
+		this->_data_fd = open(dataFile.c_str(), O_RDONLY);
+		this->_index_fd = open(indexFile.c_str(), O_RDONLY);
+	}
+
+	if (this->_data_fd < 0 || this->_index_fd < 0)
+	{
+		if (this->_data_fd >= 0) close(this->_data_fd);
+		if (this->_index_fd >= 0) close(this->_index_fd);
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Could not open tile archive!");
+	}
+
+	try
+	{
+		this->loadIndex();
+	} catch (std::exception & bad)
+	{
+		close(this->_data_fd);
+		close(this->_index_fd);
+		throw;
+	}
+}
+
+tissuestack::imaging::TissueStackTileArchive::~TissueStackTileArchive()
+{
+	if (this->_data_fd >= 0) close(this->_data_fd);
+	if (this->_index_fd >= 0) close(this->_index_fd);
+}
+
+inline void tissuestack::imaging::TissueStackTileArchive::loadIndex()
+{
+	struct stat dataStat;
+	struct stat indexStat;
+	if (fstat(this->_data_fd, &dataStat) < 0 || fstat(this->_index_fd, &indexStat) < 0)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Could not stat tile archive!");
+	this->_data_size = static_cast<unsigned long long int>(dataStat.st_size);
+
+	// a brand new archive
+	if (indexStat.st_size == 0 && this->_for_writing)
+	{
+		IndexHeader header;
+		memcpy(header.magic, tissuestack::imaging::TissueStackTileArchive::MAGIC, sizeof(header.magic));
+		header.square_length = this->_square_length;
+		header.reserved = 0;
+		if (write(this->_index_fd, &header, sizeof(header)) != sizeof(header))
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Could not initialize tile archive index!");
+		this->_index_size = sizeof(header);
+		return;
+	}
+
+	const unsigned long long int indexSize = static_cast<unsigned long long int>(indexStat.st_size);
+	IndexHeader header;
+	if (indexSize < sizeof(header) ||
+		pread(this->_index_fd, &header, sizeof(header), 0) != sizeof(header) ||
+		memcmp(header.magic, tissuestack::imaging::TissueStackTileArchive::MAGIC, sizeof(header.magic)) != 0)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Tile archive index is corrupt!");
+
+	// tiles of different sizes don't mix
+	if (this->_for_writing && this->_square_length != 0 && header.square_length != this->_square_length)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Tile archive holds tiles of a different size!");
+	this->_square_length = header.square_length;
+
+	// an interrupted append may have left a partial entry at the end: it is ignored (and cut off for writing)
+	const unsigned long long int numberOfEntries = (indexSize - sizeof(header)) / sizeof(IndexEntry);
+	this->_index_size = sizeof(header) + numberOfEntries * sizeof(IndexEntry);
+	if (this->_for_writing &&
+		ftruncate(this->_index_fd, this->_index_size) < 0)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Could not repair tile archive index!");
+
+	std::vector<IndexEntry> entries(numberOfEntries);
+	unsigned long long int bytesToRead = numberOfEntries * sizeof(IndexEntry);
+	unsigned long long int bytesRead = 0;
+	while (bytesRead < bytesToRead)
+	{
+		const ssize_t ret =
+			pread(this->_index_fd,
+				reinterpret_cast<char *>(entries.data()) + bytesRead,
+				bytesToRead - bytesRead,
+				sizeof(header) + bytesRead);
+		if (ret <= 0)
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Could not read tile archive index!");
+		bytesRead += ret;
+	}
+
+	this->_index.reserve(numberOfEntries);
+	for (auto entry : entries)
+	{
+		// entries are only appended after their data, anything else is not trustworthy
+		if (entry.offset + entry.length > this->_data_size)
+			continue;
+		this->_index[{{ entry.slice_number, entry.x, entry.y }}] =
+			std::make_pair(entry.offset, entry.length);
+	}
+}
+
+const std::string tissuestack::imaging::TissueStackTileArchive::composeArchivePath(
+	const std::string & tile_dir,
+	const unsigned short zoom_level,
+	const std::string & dimension_name,
+	const std::string & color_map,
+	const std::string & format)
+{
+	std::string formatLowerCase = format;
+	std::transform(formatLowerCase.begin(), formatLowerCase.end(), formatLowerCase.begin(), tolower);
+
+	std::ostringstream path;
+	path << tile_dir;
+	if (!tile_dir.empty() && tile_dir.at(tile_dir.length()-1) != '/')
+		path << "/";
+	path << std::to_string(zoom_level) << "/" << dimension_name.substr(0,1);
+	if (!color_map.empty()
+		&& color_map.compare("grey") != 0
+		&& color_map.compare("gray") != 0)
+		path << "_" << color_map;
+	path << "." << formatLowerCase;
+
+	return path.str();
+}
+
+void tissuestack::imaging::TissueStackTileArchive::appendTile(
+	const unsigned int slice_number,
+	const unsigned int x,
+	const unsigned int y,
+	const void * data,
+	const unsigned long long int length)
+{
+	if (!this->_for_writing)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Tile archive has been opened read-only!");
+
+	std::lock_guard<std::mutex> lock(this->_write_mutex);
+
+	// data first, then the index entry that makes it visible
+	unsigned long long int written = 0;
+	while (written < length)
+	{
+		const ssize_t ret =
+			pwrite(this->_data_fd,
+				static_cast<const char *>(data) + written,
+				length - written,
+				this->_data_size + written);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Could not append tile to archive!");
+		written += ret;
+	}
+
+	const IndexEntry entry = { slice_number, x, y, 0, this->_data_size, length };
+	if (write(this->_index_fd, &entry, sizeof(entry)) != sizeof(entry))
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Could not append tile to archive index!");
+
+	this->_index[{{ slice_number, x, y }}] = std::make_pair(this->_data_size, length);
+	this->_data_size += length;
+	this->_index_size += sizeof(entry);
+}
+
+const bool tissuestack::imaging::TissueStackTileArchive::findTile(
+	const unsigned int slice_number,
+	const unsigned int x,
+	const unsigned int y,
+	unsigned long long int & offset,
+	unsigned long long int & length) const
+{
+	const auto hit = this->_index.find({{ slice_number, x, y }});
+	if (hit == this->_index.end())
+		return false;
+
+	offset = hit->second.first;
+	length = hit->second.second;
+	return true;
+}
+
+const int tissuestack::imaging::TissueStackTileArchive::getDataDescriptor() const
+{
+	return this->_data_fd;
+}
+
+const std::string tissuestack::imaging::TissueStackTileArchive::getArchivePath() const
+{
+	return this->_archive_path;
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackTileArchive::getNumberOfTiles() const
+{
+	return this->_index.size();
+}
+
+const unsigned int tissuestack::imaging::TissueStackTileArchive::getSquareLength() const
+{
+	return this->_square_length;
+}
+
+const bool tissuestack::imaging::TissueStackTileArchive::hasBeenAppendedTo() const
+{
+	struct stat indexStat;
+	if (fstat(this->_index_fd, &indexStat) < 0)
+		return false;
+
+	return static_cast<unsigned long long int>(indexStat.st_size) > this->_index_size;
+}
@@ -0,0 +1,217 @@
+/*
+ * This file is part of TissueStack.
+ *
+ * TissueStack is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TissueStack is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TissueStack.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "networking.h"
+#include "imaging.h"
+
+tissuestack::imaging::TissueStackTileCache::TissueStackTileCache() :
+	_hits(0), _misses(0), _evictions(0), _not_modified(0)
+{
+	this->_capacity =
+		strtoull(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("tile_cache_size").c_str(), NULL, 10);
+	this->_capacity *= 1024 * 1024; // configured in megabytes
+
+	tissuestack::logging::TissueStackLogger::instance()->info(
+		"Tile Cache Capacity: %llu bytes\n", this->getCapacityInBytes());
+}
+
+tissuestack::imaging::TissueStackTileCache * tissuestack::imaging::TissueStackTileCache::instance()
+{
+	if (tissuestack::imaging::TissueStackTileCache::_instance == nullptr)
+		tissuestack::imaging::TissueStackTileCache::_instance = new tissuestack::imaging::TissueStackTileCache();
+
+	return tissuestack::imaging::TissueStackTileCache::_instance;
+}
+
+const bool tissuestack::imaging::TissueStackTileCache::doesInstanceExist()
+{
+	return (tissuestack::imaging::TissueStackTileCache::_instance != nullptr);
+}
+
+void tissuestack::imaging::TissueStackTileCache::purgeInstance()
+{
+	delete tissuestack::imaging::TissueStackTileCache::_instance;
+	tissuestack::imaging::TissueStackTileCache::_instance = nullptr;
+}
+
+const std::string tissuestack::imaging::TissueStackTileCache::composeCacheKey(
+	const std::string & dataset,
+	const tissuestack::networking::TissueStackImageRequest * request)
+{
+	// every request parameter that has an influence on the rendered bytes
+	std::ostringstream key;
+	key << dataset << "|" << request->getDimensionName() << "|" << request->getSliceNumber();
+	if (request->isPreview())
+	{
+		key << "|preview";
+		if (request->showOnlyPortionOfImage())
+			key << "|" << request->getXCoordinate() << "|" << request->getYCoordinate()
+				<< "|" << request->getWidth() << "|" << request->getHeight();
+	} else
+		key << "|" << request->getXCoordinate() << "|" << request->getYCoordinate()
+			<< "|" << request->getLengthOfSquare();
+	// floats with enough digits to tell any two of them apart
+	key << "|" << std::setprecision(9) << request->getScaleFactor() << "|" << request->getQualityFactor()
+		<< "|" << request->getColorMapName()
+		<< "|" << request->getContrastMinimum() << "|" << request->getContrastMaximum()
+		<< "|" << request->getOutputImageFormat();
+
+	return key.str();
+}
+
+std::shared_ptr<const tissuestack::imaging::RenderedTile> tissuestack::imaging::TissueStackTileCache::findTile(
+	const std::string & key)
+{
+	std::lock_guard<std::mutex> lock(this->_cache_mutex);
+
+	auto hit = this->_index.find(key);
+	if (hit == this->_index.end())
+	{
+		this->_misses++;
+		return nullptr;
+	}
+
+	this->_lru.splice(this->_lru.begin(), this->_lru, hit->second);
+	this->_hits++;
+
+	return hit->second->tile;
+}
+
+void tissuestack::imaging::TissueStackTileCache::addTile(
+	const std::string & key,
+	const std::string & dataset,
+	const std::string & color_map_name,
+	const std::shared_ptr<const tissuestack::imaging::RenderedTile> & tile,
+	const unsigned long long int generation)
+{
+	if (!tile || tile->body.empty())
+		return;
+
+	const unsigned long long int tileSize = tile->body.length() + tile->gzipped_body.length();
+	if (tileSize > this->_capacity)
+		return;
+
+	std::lock_guard<std::mutex> lock(this->_cache_mutex);
+
+	if (generation != this->_generation || this->_index.find(key) != this->_index.end())
+		return;
+
+	while (!this->_lru.empty() && this->_size + tileSize > this->_capacity)
+	{
+		this->_size -= this->_lru.back().tile->body.length() + this->_lru.back().tile->gzipped_body.length();
+		this->_index.erase(this->_lru.back().key);
+		this->_lru.pop_back();
+		this->_evictions++;
+	}
+
+	this->_lru.push_front({ key, dataset, color_map_name, tile });
+	this->_index[key] = this->_lru.begin();
+	this->_size += tileSize;
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackTileCache::getGeneration()
+{
+	std::lock_guard<std::mutex> lock(this->_cache_mutex);
+	return this->_generation;
+}
+
+inline void tissuestack::imaging::TissueStackTileCache::evictIf(
+	const std::function<bool (const CachedTile & cached_tile)> & predicate)
+{
+	std::lock_guard<std::mutex> lock(this->_cache_mutex);
+
+	this->_generation++;
+
+	for (auto entry = this->_lru.begin(); entry != this->_lru.end();)
+	{
+		if (predicate(*entry))
+		{
+			this->_size -= entry->tile->body.length() + entry->tile->gzipped_body.length();
+			this->_index.erase(entry->key);
+			entry = this->_lru.erase(entry);
+		} else
+			++entry;
+	}
+}
+
+void tissuestack::imaging::TissueStackTileCache::evictDataSet(const std::string & dataset)
+{
+	this->evictIf(
+		[&dataset] (const CachedTile & cached_tile) -> bool
+		{
+			return cached_tile.dataset.compare(dataset) == 0;
+		});
+}
+
+void tissuestack::imaging::TissueStackTileCache::evictColorMap(const std::string & color_map_name)
+{
+	this->evictIf(
+		[&color_map_name] (const CachedTile & cached_tile) -> bool
+		{
+			return cached_tile.color_map_name.compare(color_map_name) == 0;
+		});
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackTileCache::getCapacityInBytes() const
+{
+	return this->_capacity;
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackTileCache::getSizeInBytes() const
+{
+	return this->_size;
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackTileCache::getNumberOfHits() const
+{
+	return this->_hits.load();
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackTileCache::getNumberOfMisses() const
+{
+	return this->_misses.load();
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackTileCache::getNumberOfEvictions() const
+{
+	return this->_evictions.load();
+}
+
+const unsigned long long int tissuestack::imaging::TissueStackTileCache::getNumberOfNotModifiedResponses() const
+{
+	return this->_not_modified.load();
+}
+
+void tissuestack::imaging::TissueStackTileCache::countNotModifiedResponse()
+{
+	this->_not_modified++;
+}
+
+const std::string tissuestack::imaging::TissueStackTileCache::getStatisticsAsJson() const
+{
+	std::ostringstream json;
+	json << "{ \"capacity\": " << this->getCapacityInBytes();
+	json << ", \"size\": " << this->getSizeInBytes();
+	json << ", \"hits\": " << this->getNumberOfHits();
+	json << ", \"misses\": " << this->getNumberOfMisses();
+	json << ", \"evictions\": " << this->getNumberOfEvictions();
+	json << ", \"not_modified\": " << this->getNumberOfNotModifiedResponses();
+	json << " }";
+
+	return json.str();
+}
+
+tissuestack::imaging::TissueStackTileCache * tissuestack::imaging::TissueStackTileCache::_instance = nullptr;
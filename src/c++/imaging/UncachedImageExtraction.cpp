@@ -22,11 +22,17 @@ tissuestack::imaging::UncachedImageExtraction::UncachedImageExtraction()
 
 }
 
-inline unsigned char * tissuestack::imaging::UncachedImageExtraction::readRawSlice(
+inline const unsigned char * tissuestack::imaging::UncachedImageExtraction::readRawSlice(
 		const tissuestack::imaging::TissueStackRawData * image,
 		const tissuestack::imaging::TissueStackDataDimension * actualDimension,
 		const unsigned int sliceNumber) const
 {
+	// memory mapped data sets are served straight from the mapping
+	const unsigned char * mappedData =
+		image->getMappedSlice(actualDimension, sliceNumber);
+	if (mappedData != nullptr)
+		return mappedData;
+
 	unsigned long long int multiplier = 1;
 	if (image->getType() != tissuestack::imaging::RAW_TYPE::UCHAR_8_BIT)
 		multiplier = 3;
@@ -41,23 +47,34 @@ inline unsigned char * tissuestack::imaging::UncachedImageExtraction::readRawSli
 	unsigned char * data = new unsigned char[dataLength];
 	const int fd =
 		const_cast<tissuestack::imaging::TissueStackRawData *>(image)->getFileDescriptor();
-	lseek(
-		fd,
-		actualOffset,
-		SEEK_SET);
 	ssize_t bRead =
-		read(
+		pread(
 			fd,
 			static_cast<void *>(data),
-			dataLength);
+			dataLength,
+			actualOffset);
 
 	if (bRead != dataLength)
+	{
+		delete [] data;
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 				"Failed to read entire slice from RAW file!");
+	}
 
 	return data;
 }
 
+void tissuestack::imaging::UncachedImageExtraction::releaseImageOnly(
+		const tissuestack::imaging::TissueStackRawData * image,
+		const unsigned char * data) const
+{
+	// the mapping belongs to the data set, only slices we read ourselves get freed
+	if (data == nullptr || image->isWithinMappedMemory(data))
+		return;
+
+	delete [] data;
+}
+
 const unsigned char * tissuestack::imaging::UncachedImageExtraction::extractImageOnly(
 		const tissuestack::imaging::TissueStackRawData * image,
 		const tissuestack::networking::TissueStackImageRequest * request) const
@@ -66,12 +83,12 @@ const unsigned char * tissuestack::imaging::UncachedImageExtraction::extractImag
 	const tissuestack::imaging::TissueStackDataDimension * actualDimension =
 			image->getDimensionByLongName(request->getDimensionName());
 
-	unsigned char * data =
+	const unsigned char * data =
 		this->readRawSlice(image, actualDimension, request->getSliceNumber());
 
 	if (request->hasExpired())
 	{
-		delete [] data;
+		this->releaseImageOnly(image, data);
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackObsoleteRequestException,
 			"Old Image Request!");
 	}
@@ -79,22 +96,42 @@ const unsigned char * tissuestack::imaging::UncachedImageExtraction::extractImag
 	return data;
 }
 
+const unsigned char * tissuestack::imaging::UncachedImageExtraction::extractSliceOnly(
+		const tissuestack::imaging::TissueStackRawData * image,
+		const tissuestack::imaging::TissueStackDataDimension * actualDimension,
+		const unsigned int sliceNumber) const
+{
+	// no request attached: reads shared by several requests must not expire with any one of them
+	return this->readRawSlice(image, actualDimension, sliceNumber);
+}
+
 Image * tissuestack::imaging::UncachedImageExtraction::extractImageForPreTiling(
 		const tissuestack::imaging::TissueStackRawData * image,
 		const tissuestack::imaging::TissueStackDataDimension * actualDimension,
 		const unsigned int sliceNumber) const
 {
-	std::unique_ptr<unsigned char[]> data(
+	const unsigned char * data =
 		this->readRawSlice(
 				image,
 				actualDimension,
-				sliceNumber));
+				sliceNumber);
 
-	return
-		this->createImageFromDataRead0(
-			image,
-			actualDimension,
-			data.get());
+	Image * img = nullptr;
+	try
+	{
+		img =
+			this->createImageFromDataRead0(
+				image,
+				actualDimension,
+				data);
+	} catch (std::exception & bad)
+	{
+		this->releaseImageOnly(image, data);
+		throw;
+	}
+	this->releaseImageOnly(image, data);
+
+	return img;
 }
 
 Image * tissuestack::imaging::UncachedImageExtraction::applyPreTilingProcessing(
@@ -146,6 +183,37 @@ Image * tissuestack::imaging::UncachedImageExtraction::applyPreTilingProcessing(
 	return img;
 }
 
+Image * tissuestack::imaging::UncachedImageExtraction::resizeForPreTiling(
+	const Image * img,
+	const unsigned long int width,
+	const unsigned long int height) const
+{
+	if (img == nullptr)
+		return nullptr;
+
+	ExceptionInfo exception;
+	GetExceptionInfo(&exception);
+
+	// minification averages the covered source pixels (box filter),
+	// magnification stays nearest neighbour like the on-the-fly scaling
+	Image * resized = nullptr;
+	if (width == img->columns && height == img->rows)
+		resized = CloneImage(img, 0, 0, 1, &exception);
+	else if (width <= img->columns && height <= img->rows)
+		resized = ScaleImage(img, width < 1 ? 1 : width, height < 1 ? 1 : height, &exception);
+	else
+		resized = SampleImage(img, width < 1 ? 1 : width, height < 1 ? 1 : height, &exception);
+
+	if (resized == NULL)
+	{
+		CatchException(&exception);
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Image Extraction: Failed to resize image for pre-tiling!");
+	}
+
+	return resized;
+}
+
 
 Image * tissuestack::imaging::UncachedImageExtraction::applyPostExtractionTasks(
 		Image * img,
@@ -246,8 +314,8 @@ const std::array<unsigned long long int, 3> tissuestack::imaging::UncachedImageE
 	const tissuestack::imaging::TissueStackDataDimension * actualDimension =
 			image->getDimensionByLongName(request->getDimensionName());
 
-	if (request->getXCoordinate() > actualDimension->getWidth() ||
-			request->getYCoordinate() > actualDimension->getHeight())
+	if (request->getXCoordinate() >= actualDimension->getWidth() ||
+			request->getYCoordinate() >= actualDimension->getHeight())
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 			"Image Query: Coordinate (x/y) exceeds the width/height of the image slice!");
 
@@ -260,42 +328,58 @@ const std::array<unsigned long long int, 3> tissuestack::imaging::UncachedImageE
 		unsigned long long int multiplier = 1;
 		if (image->getType() != tissuestack::imaging::RAW_TYPE::UCHAR_8_BIT)
 			multiplier = 3;
+		// set position within slice
+		const unsigned long long int positionWithinSlice =
+			static_cast<unsigned long long int>(
+					static_cast<unsigned long long int>(
+						request->getYCoordinate())*actualDimension->getWidth()*multiplier +
+					static_cast<unsigned long long int>(request->getXCoordinate()*multiplier));
+
 		long long int dataLength =
 				actualDimension->getSliceSize() * multiplier;
+		// the last channel of the pixel has to lie within the slice still
+		if (positionWithinSlice + (multiplier - 1) >= static_cast<unsigned long long int>(dataLength))
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Image Query: Coordinate (x/y) exceeds the width/height of the image slice!");
+
+		// memory mapped data sets are queried straight from the mapping
+		const unsigned char * mappedData =
+			image->getMappedSlice(actualDimension, request->getSliceNumber());
+		if (mappedData != nullptr)
+		{
+			// 8 bit data has a single grey value
+			pixel_value[0] = static_cast<unsigned long long int>(mappedData[positionWithinSlice]);
+			pixel_value[1] = multiplier == 1 ?
+				pixel_value[0] : static_cast<unsigned long long int>(mappedData[positionWithinSlice+1]);
+			pixel_value[2] = multiplier == 1 ?
+				pixel_value[0] : static_cast<unsigned long long int>(mappedData[positionWithinSlice+2]);
+
+			return pixel_value;
+		}
+
 		// set slice offset
 		unsigned long long int actualOffset =
 				actualDimension->getOffset() +
 					static_cast<unsigned long long int>(request->getSliceNumber()) * static_cast<unsigned long long int>(dataLength);
-		// set position within slice
-		actualOffset +=
-			static_cast<unsigned long long int>(
-					static_cast<unsigned long long int>(
-						request->getYCoordinate())*actualDimension->getWidth()*multiplier +
-					static_cast<unsigned long long int>(request->getXCoordinate()*multiplier));
+		actualOffset += positionWithinSlice;
 
-		unsigned char * data = new unsigned char[3] {'\0', '\0', '\0'};
+		unsigned char data[3] = {'\0', '\0', '\0'};
 		const int fd =
 			const_cast<tissuestack::imaging::TissueStackRawData *>(image)->getFileDescriptor();
-		lseek(
-			fd,
-			actualOffset,
-			SEEK_SET);
 		ssize_t bRead =
-			read(
+			pread(
 				fd,
 				static_cast<void *>(data),
-				3);
+				multiplier,
+				actualOffset);
 
-		if (bRead != 3)
-		{
-			delete [] data;
+		if (bRead != static_cast<ssize_t>(multiplier))
 			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 					"Failed to query slice within RAW file!");
-		}
 
 		pixel_value[0] = static_cast<unsigned long long int>(data[0]);
-		pixel_value[1] = static_cast<unsigned long long int>(data[1]);
-		pixel_value[2] = static_cast<unsigned long long int>(data[2]);
+		pixel_value[1] = static_cast<unsigned long long int>(multiplier == 1 ? data[0] : data[1]);
+		pixel_value[2] = static_cast<unsigned long long int>(multiplier == 1 ? data[0] : data[2]);
 
 		return pixel_value;
 	}
@@ -338,11 +422,21 @@ Image * tissuestack::imaging::UncachedImageExtraction::extractImage(
 	const tissuestack::imaging::TissueStackDataDimension * actualDimension =
 			image->getDimensionByLongName(request->getDimensionName());
 
-	Image * img =
-		this->createImageFromDataRead0(
-		image,
-		actualDimension,
-		data);
+	Image * img = nullptr;
+	try
+	{
+		img =
+			this->createImageFromDataRead0(
+			image,
+			actualDimension,
+			data);
+	} catch (std::exception & bad)
+	{
+		this->releaseImageOnly(image, data);
+		throw;
+	}
+	this->releaseImageOnly(image, data);
+
 	if (img == NULL)
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 				"Could not create Image");
@@ -367,9 +461,6 @@ inline Image * tissuestack::imaging::UncachedImageExtraction::createImageFromDat
 	ExceptionInfo exception;
 	GetExceptionInfo(&exception);
 
-	const std::vector<std::string> dim_order = image->getDimensionOrder();
-	const char dim = actualDimension->getName().at(0);
-
 	if (data == nullptr)
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 			"Data is null!");
@@ -384,7 +475,6 @@ inline Image * tissuestack::imaging::UncachedImageExtraction::createImageFromDat
 	// sanity check: was graphics magick able to create an image based on what we gave it?
 	if (img == NULL)
 	{
-		delete [] data;
 		CatchException(&exception);
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 			"Could not constitute Image!");
@@ -395,6 +485,26 @@ inline Image * tissuestack::imaging::UncachedImageExtraction::createImageFromDat
 		actualDimension->getHeight() != actualDimension->getAnisotropicHeight())
 		img = this->scaleImage(img, actualDimension->getAnisotropicWidth(), actualDimension->getAnisotropicHeight());
 
+	if (this->countBackwardCompatibilityFlips(image, actualDimension) % 2 == 0)
+		return img;
+
+	Image * tmp = img;
+	img = FlipImage(img, &exception);
+	DestroyImage(tmp);
+	if (img == NULL)
+	{
+		CatchException(&exception);
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Image Extraction: Failed to flip image to make it backward compatible!");
+	}
+
+	return img;
+}
+
+inline const unsigned short tissuestack::imaging::UncachedImageExtraction::countBackwardCompatibilityFlips(
+		const tissuestack::imaging::TissueStackRawData * image,
+		const tissuestack::imaging::TissueStackDataDimension * actualDimension) const
+{
 	//if (image->getFormat() == tissuestack::imaging::FORMAT::RAW ||
 	//		image->getNumberOfDimensions() < 3) return img;
 
@@ -403,43 +513,25 @@ inline Image * tissuestack::imaging::UncachedImageExtraction::createImageFromDat
 			image->getFormat() == tissuestack::imaging::FORMAT::RAW) ||
 			image->getRawVersion() == tissuestack::imaging::RAW_FILE_VERSION::V1 ||
 			image->getNumberOfDimensions() < 3)
-		return img;
+		return 0;
+
+	const std::vector<std::string> dim_order = image->getDimensionOrder();
+	const char dim = actualDimension->getName().at(0);
+	unsigned short flips = 0;
 
-	Image * tmp = img;
 	if (image->getFormat() == tissuestack::imaging::FORMAT::NIFTI ||
 			(image->getFormat() == tissuestack::imaging::FORMAT::MINC &&
 				!((dim == 'x' && dim_order[0].at(0) == 'y' && dim_order[1].at(0) == 'z' && dim_order[2].at(0) == 'x') ||
 				(dim == 'z' && dim_order[0].at(0) == 'z' && dim_order[1].at(0) == 'x' && dim_order[2].at(0) == 'y') ||
 				((dim == 'x' || dim == 'y') && dim_order[0].at(0) == 'y' && dim_order[1].at(0) == 'x' && dim_order[2].at(0) == 'z') ||
 				(dim_order[0].at(0) == 'x' && dim_order[1].at(0) == 'y' && dim_order[2].at(0) == 'z'))))
-	{
-		img = FlipImage(img, &exception);
-		DestroyImage(tmp);
-		if (img == NULL)
-		{
-			delete [] data;
-			CatchException(&exception);
-			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-					"Image Extraction: Failed to flip image to make it backward compatible!");
-		}
-	}
+		flips++;
 
 	if ((dim == 'y' || dim == 'z') &&
 			dim_order[0].at(0) == 'x' && dim_order[1].at(0) == 'z' && dim_order[2].at(0) == 'y')
-	{
-		tmp = img;
-		img = FlipImage(img, &exception);
-		DestroyImage(tmp);
-		if (img == NULL)
-		{
-			delete [] data;
-			CatchException(&exception);
-			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-					"Image Extraction: Failed to flop image to make it backward compatible!");
-		}
-	}
+		flips++;
 
-	return img;
+	return flips;
 }
 
 Image * tissuestack::imaging::UncachedImageExtraction::degradeImage(
@@ -613,13 +705,14 @@ void inline tissuestack::imaging::UncachedImageExtraction::changeContrast(
 			"Contrast Application: Could not obtain pixels from image!");
 	}
 
+	const std::shared_ptr<const tissuestack::imaging::FusedLookupTable> lookupTable =
+		tissuestack::imaging::TissueStackLookupTableCache::instance()->findOrBuildLookupTable(
+			"gray", minimum, maximum, dataset_min, dataset_max);
+
 	unsigned int i = 0;
 	unsigned int j = 0;
 	unsigned long long int pixel_values[3];
 
-	float contrast_min = static_cast<float>(minimum);
-	float contrast_max = static_cast<float>(maximum);
-
 	while (i < height)
 	{
 		j = 0;
@@ -635,17 +728,7 @@ void inline tissuestack::imaging::UncachedImageExtraction::changeContrast(
 					pixel_values[z] =
 						this->mapUnsignedValue(img->depth, 8, pixel_values[z]);
 
-				float val = static_cast<float>(pixel_values[z]);
-
-				if (val <= contrast_min)
-					pixel_values[z] = dataset_min;
-				else if (val >= contrast_max)
-					pixel_values[z] = dataset_max;
-				else
-					pixel_values[z] =
-						static_cast<unsigned long long int>(
-							lround(((val - contrast_min) / (contrast_max - contrast_min))
-								* static_cast<float>(dataset_max - dataset_min)));
+				pixel_values[z] = lookupTable->contrast[pixel_values[z] & 0xFF];
 			}
 
 			// graphicmagick quantum depth mess which we have to react to at runtime
@@ -694,14 +777,17 @@ void inline tissuestack::imaging::UncachedImageExtraction::applyColorMap(
 		const unsigned long int width,
 		const unsigned long int height) const
 {
-	// retrieve color map
-	const tissuestack::imaging::TissueStackColorMap * colorMap =
-			tissuestack::imaging::TissueStackColorMapStore::instance()->findColorMap(color_map_name);
-	if (colorMap == nullptr)
+	// retrieve color map as a lookup table
+	std::shared_ptr<const tissuestack::imaging::FusedLookupTable> lookupTable;
+	try
+	{
+		lookupTable =
+			tissuestack::imaging::TissueStackLookupTableCache::instance()->findOrBuildLookupTable(
+				color_map_name, 0, 255, 0, 0);
+	} catch (std::exception & bad)
 	{
 		if (img) DestroyImage(img);
-		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
-			"Colormap Application: Could not find color map!");
+		throw;
 	}
 
 	ExceptionInfo exception;
@@ -728,8 +814,13 @@ void inline tissuestack::imaging::UncachedImageExtraction::applyColorMap(
 			pixel_value = static_cast<unsigned long long int>(pixels[(width * i) + j].red);
 			if (QuantumDepth != 8 && img->depth == QuantumDepth) pixel_value =
 							this->mapUnsignedValue(img->depth, 8, pixel_value);
-			const std::array<const unsigned short, 3> mapping =
-					colorMap->getRGBMapForGrayValue(static_cast<unsigned short>(pixel_value));
+			const unsigned int rgb = lookupTable->rgb[pixel_value & 0xFF];
+			const unsigned short mapping[3] =
+				{
+					static_cast<unsigned short>(rgb & 0xFF),
+					static_cast<unsigned short>((rgb >> 8) & 0xFF),
+					static_cast<unsigned short>((rgb >> 16) & 0xFF)
+				};
 
 			pixels[(width * i) + j].red = static_cast<unsigned char>(mapping[0]);
 			pixels[(width * i) + j].green = static_cast<unsigned char>(mapping[1]);
@@ -869,3 +960,159 @@ inline Image * tissuestack::imaging::UncachedImageExtraction::getImageTile(
 		height,
 		false);
 }
+
+const bool tissuestack::imaging::UncachedImageExtraction::supportsNativeProcessing(
+		const tissuestack::imaging::TissueStackRawData * image) const
+{
+	return image != nullptr &&
+		(image->getType() == tissuestack::imaging::RAW_TYPE::UCHAR_8_BIT ||
+		 image->getType() == tissuestack::imaging::RAW_TYPE::RGB_24BIT);
+}
+
+Image * tissuestack::imaging::UncachedImageExtraction::processImageNatively(
+		const tissuestack::imaging::TissueStackRawData * image,
+		const tissuestack::networking::TissueStackImageRequest * request,
+		const unsigned char * data) const
+{
+	if (data == nullptr)
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Data is null!");
+
+	const tissuestack::imaging::TissueStackDataDimension * actualDimension =
+			image->getDimensionByLongName(request->getDimensionName());
+
+	// the geometry that applyPostExtractionTasks would produce for the whole slice
+	const unsigned long int width = actualDimension->getWidth();
+	const unsigned long int height = actualDimension->getHeight();
+	const unsigned long int anisotropicWidth = actualDimension->getAnisotropicWidth();
+	const unsigned long int anisotropicHeight = actualDimension->getAnisotropicHeight();
+
+	const float scaledWith = static_cast<const float>(anisotropicWidth) * request->getScaleFactor();
+	const float scaledHeight = static_cast<const float>(anisotropicHeight) * request->getScaleFactor();
+	unsigned long int finalWidth = scaledWith < 0 ? 1 : static_cast<const unsigned int>(scaledWith);
+	unsigned long int finalHeight = scaledHeight < 0 ? 1 : static_cast<const unsigned int>(scaledHeight);
+	if (finalWidth < 1) finalWidth = 1;
+	if (finalHeight < 1) finalHeight = 1;
+
+	// the tile window within that geometry
+	unsigned long int xOffset = 0;
+	unsigned long int yOffset = 0;
+	unsigned long int tileWidth = finalWidth;
+	unsigned long int tileHeight = finalHeight;
+	if (!request->isPreview() || request->showOnlyPortionOfImage())
+	{
+		tileWidth = request->isPreview() ? request->getWidth() : request->getLengthOfSquare();
+		tileHeight = request->isPreview() ? request->getHeight() : request->getLengthOfSquare();
+		xOffset = request->isPreview() ? request->getXCoordinate() : request->getXCoordinate() * tileWidth;
+		yOffset = request->isPreview() ? request->getYCoordinate() : request->getYCoordinate() * tileHeight;
+
+		if (xOffset > finalWidth || yOffset > finalHeight)
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Image Extraction: tile number(x/y) exceeds the width/height of the image (given the square length)");
+
+		// tiles at the edges are clipped, just like CropImage does
+		if (xOffset + tileWidth > finalWidth) tileWidth = finalWidth - xOffset;
+		if (yOffset + tileHeight > finalHeight) tileHeight = finalHeight - yOffset;
+		if (tileWidth == 0 || tileHeight == 0)
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+					"Image Extraction: Failed to crop image to get tile!");
+	}
+
+	// walk the chain of geometric operations backwards to find the source pixel of each tile pixel
+	std::vector<unsigned long int> columns(tileWidth);
+	std::vector<unsigned long int> rows(tileHeight);
+	for (unsigned long int x=0;x<tileWidth;x++) columns[x] = xOffset + x;
+	for (unsigned long int y=0;y<tileHeight;y++) rows[y] = yOffset + y;
+
+	if (request->getQualityFactor() < static_cast<const float>(1.0))
+	{
+		float reducedWidth = static_cast<const float>(finalWidth) * request->getQualityFactor();
+		float reducedHeight = static_cast<const float>(finalHeight) * request->getQualityFactor();
+		if (reducedWidth < 1) reducedWidth = 1;
+		if (reducedHeight < 1) reducedHeight = 1;
+		const unsigned long int degradedWidth = static_cast<unsigned long int>(reducedWidth);
+		const unsigned long int degradedHeight = static_cast<unsigned long int>(reducedHeight);
+
+		tissuestack::imaging::NativePixelPipeline::composeSampling(columns, degradedWidth, finalWidth);
+		tissuestack::imaging::NativePixelPipeline::composeSampling(rows, degradedHeight, finalHeight);
+		tissuestack::imaging::NativePixelPipeline::composeSampling(columns, finalWidth, degradedWidth);
+		tissuestack::imaging::NativePixelPipeline::composeSampling(rows, finalHeight, degradedHeight);
+	}
+
+	if (request->getScaleFactor() != static_cast<const float>(1.0))
+	{
+		tissuestack::imaging::NativePixelPipeline::composeSampling(columns, anisotropicWidth, finalWidth);
+		tissuestack::imaging::NativePixelPipeline::composeSampling(rows, anisotropicHeight, finalHeight);
+	}
+
+	if (this->countBackwardCompatibilityFlips(image, actualDimension) % 2 == 1)
+		tissuestack::imaging::NativePixelPipeline::composeFlip(rows, anisotropicHeight);
+
+	if (width != anisotropicWidth || height != anisotropicHeight)
+	{
+		tissuestack::imaging::NativePixelPipeline::composeSampling(columns, width, anisotropicWidth);
+		tissuestack::imaging::NativePixelPipeline::composeSampling(rows, height, anisotropicHeight);
+	}
+
+	// timeout/shutdown check
+	if (request->hasExpired())
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackObsoleteRequestException,
+			"Old Image Request!");
+
+	// contrast and color map fused into one table
+	const std::shared_ptr<const tissuestack::imaging::FusedLookupTable> lookupTable =
+		tissuestack::imaging::TissueStackLookupTableCache::instance()->findOrBuildLookupTable(
+			request->getColorMapName(),
+			request->getContrastMinimum(),
+			request->getContrastMaximum(),
+			image->getImageDataMinumum(),
+			image->getImageDataMaximum());
+	const bool colorMapped = lookupTable->color_mapped;
+	const bool rgbSource = image->getType() == tissuestack::imaging::RAW_TYPE::RGB_24BIT;
+	const bool rgbOutput =
+		rgbSource || colorMapped ||
+		!(request->getContrastMinimum() == 0 && request->getContrastMaximum() == 255);
+
+	const unsigned long long int tileSize =
+		static_cast<unsigned long long int>(tileWidth) * tileHeight * (rgbOutput ? 3 : 1);
+	unsigned char * tile = new unsigned char[tileSize + tissuestack::imaging::NativePixelPipeline::RENDER_PADDING];
+	if (rgbSource)
+		tissuestack::imaging::NativePixelPipeline::renderRgb(
+			data,
+			width,
+			rows,
+			columns,
+			lookupTable->contrast,
+			colorMapped ? lookupTable->rgb : nullptr,
+			tile);
+	else
+		tissuestack::imaging::NativePixelPipeline::render(
+			data,
+			static_cast<unsigned long long int>(width) * height,
+			width,
+			rows,
+			columns,
+			lookupTable->rgb,
+			rgbOutput,
+			tile);
+
+	// graphics magick is only needed for the encoding from here on
+	ExceptionInfo exception;
+	GetExceptionInfo(&exception);
+	Image * img = ConstituteImage(
+		tileWidth,
+		tileHeight,
+		rgbOutput ? "RGB" : "I",
+		CharPixel,
+		tile, &exception);
+	delete [] tile;
+
+	if (img == NULL)
+	{
+		CatchException(&exception);
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Could not constitute Image!");
+	}
+
+	return img;
+}
@@ -20,7 +20,10 @@
 #include "tissuestack.h"
 #include <stdio.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include <array>
+#include <list>
+#include <future>
 #include <fstream>
 
 // DICOM STUFF
@@ -245,6 +248,62 @@ namespace tissuestack
 				static TissueStackColorMapStore * _instance;
 	 	};
 
+		// contrast and color map fused into tables indexed by 8 bit source values
+		typedef struct
+		{
+			unsigned char contrast[256]; // per channel contrast adjustment
+			unsigned int rgb[256];		// contrast followed by color map, RGB packed into the lower 3 bytes
+			bool color_mapped;
+		} FusedLookupTable;
+
+		class TissueStackLookupTableCache final
+		{
+			public:
+				TissueStackLookupTableCache & operator=(const TissueStackLookupTableCache&) = delete;
+				TissueStackLookupTableCache(const TissueStackLookupTableCache&) = delete;
+				static TissueStackLookupTableCache * instance();
+				static const bool doesInstanceExist();
+				void purgeInstance();
+
+				// built lazily on a miss, throws if the color map does not exist
+				std::shared_ptr<const FusedLookupTable> findOrBuildLookupTable(
+					const std::string & color_map_name,
+					const unsigned short contrast_min,
+					const unsigned short contrast_max,
+					const unsigned short dataset_min,
+					const unsigned short dataset_max);
+				void invalidateColorMap(const std::string & color_map_name);
+
+				const unsigned long long int getNumberOfHits() const;
+				const unsigned long long int getNumberOfMisses() const;
+				const unsigned long long int getNumberOfEvictions() const;
+				const std::string getStatisticsAsJson() const;
+			private:
+				typedef struct
+				{
+					std::string key;
+					std::string color_map_name;
+					std::shared_ptr<const FusedLookupTable> table;
+				} CachedLookupTable;
+
+				TissueStackLookupTableCache();
+				static const std::shared_ptr<const FusedLookupTable> buildLookupTable(
+					const std::string & color_map_name,
+					const unsigned short contrast_min,
+					const unsigned short contrast_max,
+					const unsigned short dataset_min,
+					const unsigned short dataset_max);
+				std::mutex _cache_mutex;
+				std::list<CachedLookupTable> _lru; // most recently used first
+				std::unordered_map<std::string, std::list<CachedLookupTable>::iterator> _index;
+				unsigned long long int _generation = 0;
+				unsigned long int _capacity = 0;
+				std::atomic<unsigned long long int> _hits;
+				std::atomic<unsigned long long int> _misses;
+				std::atomic<unsigned long long int> _evictions;
+				static TissueStackLookupTableCache * _instance;
+		};
+
 		class TissueStackDataDimension final
 		{
 			public:
@@ -413,15 +472,25 @@ namespace tissuestack
 				const unsigned long long int getFileSizeInBytes() const;
 				const RAW_TYPE getType() const;
 				const RAW_FILE_VERSION getRawVersion() const;
+				void mapIntoMemory();
+				const bool isMappedIntoMemory() const;
+				const bool isWithinMappedMemory(const unsigned char * data) const;
+				const unsigned char * getMappedSlice(
+					const TissueStackDataDimension * dimension,
+					const unsigned long int slice) const;
 			private:
 				void setRawType(int type);
 				void setRawVersion(int version);
+				void unmapFromMemory();
+				inline void adviseMappedDimension(const TissueStackDataDimension * dimension) const;
 				friend class TissueStackImageData;
 				explicit TissueStackRawData(const std::string & filename);
 				void parseHeader(const std::string & header);
 				unsigned int _totalHeaderLength = 0;
 				RAW_TYPE	_raw_type = RAW_TYPE::UCHAR_8_BIT;
 				RAW_FILE_VERSION _raw_version = RAW_FILE_VERSION::LEGACY;
+				const unsigned char * _mapped_data = nullptr;
+				unsigned long long int _mapped_size = 0;
 		};
 
 		class TissueStackDataBaseData final : public TissueStackImageData
@@ -483,6 +552,7 @@ namespace tissuestack
 				unsigned long int _number_of_images_in_series_or_acquisition = 0;
 				bool _isTemp = false;
 				std::string _patient_position = "HFS";
+				std::unique_ptr<DcmFileFormat> _dicom_file;
 
 
 
@@ -543,6 +613,8 @@ namespace tissuestack
 				std::string _series_number = "";
 				DICOM_TYPE _type;
 				DICOM_PLANAR_ORIENTATION _planar_orientation = DICOM_PLANAR_ORIENTATION::UNDETERMINED;
+				static std::mutex _dcmtk_codecs_mutex;
+				static unsigned int _dcmtk_codecs_users;
 		};
 
 		class TissueStackNiftiData final : public TissueStackImageData
@@ -552,16 +624,27 @@ namespace tissuestack
 				const bool isRaw() const;
 				const bool isColor() const;
 				const nifti_image * getNiftiHandle() const;
+				// the global min/max are determined by a scan on first use unless set beforehand
 				const double getMin() const;
 				const double getMax() const;
+				const bool hasGlobalMinMax() const;
+				void setGlobalMinMax(const double min, const double max) const;
 			private:
-				void setGlobalMinMax();
+				void determineGlobalMinMax() const;
+				template <typename ValueType>
+				inline void findMinMax(
+					const void * values,
+					const unsigned long long int size,
+					double & min,
+					double & max) const;
 				friend class TissueStackImageData;
 				TissueStackNiftiData(const std::string & filename);
 				bool _is_color = false;
 				nifti_image * _volume;
-				double _min = INFINITY;
-				double _max = -INFINITY;
+				mutable std::mutex _min_max_mutex;
+				mutable bool _has_min_max = false;
+				mutable double _min = INFINITY;
+				mutable double _max = -INFINITY;
 		};
 
 		class TissueStackMincData final : public TissueStackImageData
@@ -622,10 +705,73 @@ namespace tissuestack
 		    	static const std::string getDataSetStoreDirectory();
 			private:
 		    	TissueStackDataSetStore();
+		    	inline void mapRawDataIntoMemory(const TissueStackDataSet * dataSet) const;
+		    	inline void retireDataSet(const TissueStackDataSet * dataSet);
 		    	std::unordered_map<std::string, const TissueStackDataSet *> _data_sets;
+		    	// removed/replaced data sets (and their RAW mapping) stay alive for requests still reading them
+		    	std::list<std::pair<unsigned long long int, const TissueStackDataSet *> > _retired_data_sets;
+		    	std::mutex _retired_data_sets_mutex;
+		    	static const unsigned long long int RETIREMENT_IN_MILLIS;
 				static TissueStackDataSetStore * _instance;
 	 	};
 
+		class NativePixelPipeline final
+		{
+			public:
+				NativePixelPipeline & operator=(const NativePixelPipeline&) = delete;
+				NativePixelPipeline(const NativePixelPipeline&) = delete;
+
+				// composes a nearest neighbour resampling (same pixel centre mapping as SampleImage)
+				// into an index map that holds source coordinates for every output coordinate
+				static void composeSampling(
+					std::vector<unsigned long int> & index_map,
+					const unsigned long int source_length,
+					const unsigned long int target_length);
+				static void composeFlip(
+					std::vector<unsigned long int> & index_map,
+					const unsigned long int length);
+				// out[y][x] = lookup_table[source[rows[y] * source_width + columns[x]]]
+				// the lookup table holds RGB packed into the lower 3 bytes of each entry,
+				// the destination needs RENDER_PADDING bytes of slack at its end
+				static const unsigned short RENDER_PADDING;
+				static void render(
+					const unsigned char * source,
+					const unsigned long long int source_length,
+					const unsigned long int source_width,
+					const std::vector<unsigned long int> & rows,
+					const std::vector<unsigned long int> & columns,
+					const unsigned int * lookup_table,
+					const bool rgb_output,
+					unsigned char * destination);
+				// rgb sources: with a color lookup table the red channel is mapped through it,
+				// otherwise every channel is mapped through the channel lookup table
+				static void renderRgb(
+					const unsigned char * source,
+					const unsigned long int source_width,
+					const std::vector<unsigned long int> & rows,
+					const std::vector<unsigned long int> & columns,
+					const unsigned char * channel_lookup_table,
+					const unsigned int * color_lookup_table,
+					unsigned char * destination);
+				static const bool isAvx2Supported();
+			private:
+				NativePixelPipeline();
+				static void renderRow(
+					const unsigned char * source_row,
+					const unsigned int * columns,
+					const unsigned long int width,
+					const unsigned int * lookup_table,
+					const bool rgb_output,
+					unsigned char * destination);
+				static void renderRowAvx2(
+					const unsigned char * source_row,
+					const unsigned int * columns,
+					const unsigned long int width,
+					const unsigned int * lookup_table,
+					const bool rgb_output,
+					unsigned char * destination);
+		};
+
 		class UncachedImageExtraction final
 		{
 			public:
@@ -660,10 +806,24 @@ namespace tissuestack
 					unsigned long int & height,
 					const float scaleFactor) const;
 
+				Image * resizeForPreTiling(
+					const Image * img,
+					const unsigned long int width,
+					const unsigned long int height) const;
+
 				const unsigned char * extractImageOnly(
 					const TissueStackRawData * image,
 					const tissuestack::networking::TissueStackImageRequest * request) const;
 
+				const unsigned char * extractSliceOnly(
+					const TissueStackRawData * image,
+					const tissuestack::imaging::TissueStackDataDimension * actualDimension,
+					const unsigned int sliceNumber) const;
+
+				void releaseImageOnly(
+					const TissueStackRawData * image,
+					const unsigned char * data) const;
+
 				Image * applyPostExtractionTasks(
 					Image * img,
 					const TissueStackRawData * image,
@@ -684,8 +844,19 @@ namespace tissuestack
 					const unsigned char fromBitRange,
 					const unsigned char toBitRange,
 					const unsigned long long value) const;
+
+				const bool supportsNativeProcessing(const TissueStackRawData * image) const;
+
+				Image * processImageNatively(
+					const TissueStackRawData * image,
+					const tissuestack::networking::TissueStackImageRequest * request,
+					const unsigned char * data) const;
 			private:
-				inline unsigned char * readRawSlice(
+				inline const unsigned short countBackwardCompatibilityFlips(
+					const tissuestack::imaging::TissueStackRawData * image,
+					const tissuestack::imaging::TissueStackDataDimension * actualDimension) const;
+
+				inline const unsigned char * readRawSlice(
 					const tissuestack::imaging::TissueStackRawData * image,
 					const tissuestack::imaging::TissueStackDataDimension * actualDimension,
 					const unsigned int sliceNumber) const;
@@ -747,42 +918,19 @@ namespace tissuestack
 				SliceCacheEntry & operator=(const SliceCacheEntry&) = delete;
 				SliceCacheEntry(const SliceCacheEntry&) = delete;
 				~SliceCacheEntry();
-				SliceCacheEntry(const unsigned char * cache_data);
+				SliceCacheEntry(const unsigned char * cache_data, const unsigned long long int size);
 
-				const unsigned char * getCacheData();
-				const unsigned long long int getAccessCount() const;
-				const unsigned long long int getTimeStampForLastAccess() const;
+				const unsigned char * getCacheData() const;
+				const unsigned long long int getSize() const;
 			private:
 				const unsigned char * _cache_data;
-				unsigned long long int _timestamp_accessed;
-				unsigned long long int _access_count;
-		};
-
-		class DataSetSliceCache final
-		{
-			public:
-				DataSetSliceCache & operator=(const SliceCacheEntry&) = delete;
-				DataSetSliceCache(const SliceCacheEntry&) = delete;
-				~DataSetSliceCache();
-				DataSetSliceCache(const TissueStackRawData * image);
-
-				SliceCacheEntry * getSlice(const unsigned long int slice) const;
-				const bool setSlice(const unsigned long int slice, SliceCacheEntry *  cache_data);
-				const bool isSliceCached(const unsigned long int slice) const;
-				void eraseSlice(const unsigned long int slice);
-				const unsigned long int getNumberOfCachedSlices() const;
-				const long int getMostRecentCacheFailure() const;
-				void setMostRecentCacheFailure(const long int slice);
-			private:
-				unsigned long int _numberOfCachedSlices = 0;
-				long int _mostRecentCacheFailure = -1;
-				SliceCacheEntry ** _cache = nullptr;
+				const unsigned long long int _size;
 		};
 
 		class TissueStackSliceCache final
 		{
 			public:
-				static const unsigned long long int MINIMUM_FREE_RAM_IN_BYTES;
+				static const unsigned short NUMBER_OF_SHARDS;
 				TissueStackSliceCache & operator=(const TissueStackSliceCache&) = delete;
 				TissueStackSliceCache(const TissueStackSliceCache&) = delete;
 				~TissueStackSliceCache();
@@ -791,29 +939,255 @@ namespace tissuestack
 				static const bool doesInstanceExist();
 				void purgeInstance();
 
-				const bool isBeingCleanedUp() const;
 				void cleanUpCache();
-				const bool addCacheEntry(
-					const std::string dataset, const unsigned long int slice, const unsigned char * data);
-				const unsigned char * findCacheEntry(
+				void evictDataSet(const std::string dataset);
+				std::shared_ptr<const SliceCacheEntry> findCacheEntry(
 					const std::string dataset, const unsigned long int slice);
+				// on a miss only the first caller runs the loader, concurrent callers wait for its result
+				std::shared_ptr<const SliceCacheEntry> findOrLoadCacheEntry(
+					const std::string dataset, const unsigned long int slice,
+					const std::function<std::shared_ptr<const SliceCacheEntry> ()> & loader);
+
+				const unsigned long long int getCapacityInBytes() const;
+				const unsigned long long int getSizeInBytes() const;
+				const unsigned long long int getNumberOfHits() const;
+				const unsigned long long int getNumberOfMisses() const;
+				const unsigned long long int getNumberOfEvictions() const;
+				const unsigned long long int getNumberOfCoalescedMisses() const;
+				const std::string getStatisticsAsJson() const;
 
 			private:
-				static const unsigned long long int SECOND_IN_MILLIS;
-				static const unsigned long long int MINUTE_IN_MILLIS;
-				static const unsigned long long int HOUR_IN_MILLIS;
-				static const unsigned long long int DAY_IN_MILLIS;
-				static const unsigned long long int WEEK_IN_MILLIS;
-				static const unsigned long long int MONTH_IN_MILLIS;
+				static const unsigned long long int IDLE_TIME_IN_MILLIS;
+
+				typedef struct
+				{
+					std::string key;
+					std::string dataset;
+					std::shared_ptr<const SliceCacheEntry> entry;
+					unsigned long long int timestamp_accessed;
+				} CachedSlice;
+
+				typedef struct
+				{
+					std::mutex mutex;
+					std::list<CachedSlice> lru; // most recently used first
+					std::unordered_map<std::string, std::list<CachedSlice>::iterator> index;
+					std::unordered_map<std::string, std::shared_future<std::shared_ptr<const SliceCacheEntry> > > loading;
+					unsigned long long int size;
+				} CacheShard;
 
 				TissueStackSliceCache();
-				bool _is_being_cleaned;
-				bool _is_empty;
-				std::mutex _cache_mutex;
-				std::unordered_map<std::string, DataSetSliceCache * > _cache;
+				inline CacheShard & findShard(const std::string & key) const;
+				inline void evictLeastRecentlyUsed(CacheShard & shard, const unsigned long long int room_needed);
+				inline void insertIntoShard(
+					CacheShard & shard, const std::string & key, const std::string & dataset,
+					const std::shared_ptr<const SliceCacheEntry> & entry);
+				CacheShard * _shards = nullptr;
+				unsigned long long int _capacity_per_shard = 0;
+				std::atomic<unsigned long long int> _size;
+				std::atomic<unsigned long long int> _hits;
+				std::atomic<unsigned long long int> _misses;
+				std::atomic<unsigned long long int> _evictions;
+				std::atomic<unsigned long long int> _coalesced_misses;
 				static TissueStackSliceCache * _instance;
 		};
 
+		// an encoded image response, ready to be written out. formats that are not compressed already
+		// carry a gzipped variant as well (with its own entity tag) for clients that accept it
+		typedef struct
+		{
+			std::string content_type;
+			std::string entity_tag;
+			std::string body;
+			std::string gzipped_entity_tag;
+			std::string gzipped_body;
+		} RenderedTile;
+
+		class TissueStackTileCache final
+		{
+			public:
+				TissueStackTileCache & operator=(const TissueStackTileCache&) = delete;
+				TissueStackTileCache(const TissueStackTileCache&) = delete;
+				static TissueStackTileCache * instance();
+				static const bool doesInstanceExist();
+				void purgeInstance();
+
+				static const std::string composeCacheKey(
+					const std::string & dataset,
+					const tissuestack::networking::TissueStackImageRequest * request);
+				std::shared_ptr<const RenderedTile> findTile(const std::string & key);
+				// to be read before rendering: tiles rendered across an invalidation are not admitted
+				const unsigned long long int getGeneration();
+				void addTile(
+					const std::string & key,
+					const std::string & dataset,
+					const std::string & color_map_name,
+					const std::shared_ptr<const RenderedTile> & tile,
+					const unsigned long long int generation);
+				void evictDataSet(const std::string & dataset);
+				void evictColorMap(const std::string & color_map_name);
+
+				const unsigned long long int getCapacityInBytes() const;
+				const unsigned long long int getSizeInBytes() const;
+				const unsigned long long int getNumberOfHits() const;
+				const unsigned long long int getNumberOfMisses() const;
+				const unsigned long long int getNumberOfEvictions() const;
+				const unsigned long long int getNumberOfNotModifiedResponses() const;
+				void countNotModifiedResponse();
+				const std::string getStatisticsAsJson() const;
+			private:
+				typedef struct
+				{
+					std::string key;
+					std::string dataset;
+					std::string color_map_name;
+					std::shared_ptr<const RenderedTile> tile;
+				} CachedTile;
+
+				TissueStackTileCache();
+				inline void evictIf(const std::function<bool (const CachedTile & cached_tile)> & predicate);
+				std::mutex _cache_mutex;
+				std::list<CachedTile> _lru; // most recently used first
+				std::unordered_map<std::string, std::list<CachedTile>::iterator> _index;
+				unsigned long long int _capacity = 0;
+				unsigned long long int _size = 0;
+				unsigned long long int _generation = 0;
+				std::atomic<unsigned long long int> _hits;
+				std::atomic<unsigned long long int> _misses;
+				std::atomic<unsigned long long int> _evictions;
+				std::atomic<unsigned long long int> _not_modified;
+				static TissueStackTileCache * _instance;
+		};
+
+		// pre-rendered tiles of one zoom level and dimension (and color map/format), packed into a single file:
+		// <archive>.tiles holds the encoded images back to back, <archive>.tiles.idx a header (magic, tile size)
+		// followed by fixed size entries (slice, x, y, offset, length) appended once the image data has been written.
+		// later entries for the same tile supersede earlier ones, previews use x = y = PREVIEW
+		class TissueStackTileArchive final
+		{
+			public:
+				static const unsigned int PREVIEW = 0xFFFFFFFF;
+				static const std::string DATA_SUFFIX;
+				static const std::string INDEX_SUFFIX;
+
+				TissueStackTileArchive & operator=(const TissueStackTileArchive&) = delete;
+				TissueStackTileArchive(const TissueStackTileArchive&) = delete;
+				explicit TissueStackTileArchive(
+					const std::string & archive_path,
+					const bool for_writing = false,
+					const unsigned int square_length = 0);
+				~TissueStackTileArchive();
+
+				// <tile_dir>/<zoom>/<dimension>[_<color map>].<format>, without suffix
+				static const std::string composeArchivePath(
+					const std::string & tile_dir,
+					const unsigned short zoom_level,
+					const std::string & dimension_name,
+					const std::string & color_map,
+					const std::string & format);
+
+				void appendTile(
+					const unsigned int slice_number,
+					const unsigned int x,
+					const unsigned int y,
+					const void * data,
+					const unsigned long long int length);
+				// lock free, meant for read-only archives
+				const bool findTile(
+					const unsigned int slice_number,
+					const unsigned int x,
+					const unsigned int y,
+					unsigned long long int & offset,
+					unsigned long long int & length) const;
+				const int getDataDescriptor() const;
+				const std::string getArchivePath() const;
+				const unsigned long long int getNumberOfTiles() const;
+				const unsigned int getSquareLength() const;
+				// a read-only archive that is still being written to needs reopening to see the new tiles
+				const bool hasBeenAppendedTo() const;
+			private:
+				static const char MAGIC[8];
+				typedef struct
+				{
+					char magic[8];
+					unsigned int square_length;
+					unsigned int reserved;
+				} IndexHeader;
+				typedef struct
+				{
+					unsigned int slice_number;
+					unsigned int x;
+					unsigned int y;
+					unsigned int reserved;
+					unsigned long long int offset;
+					unsigned long long int length;
+				} IndexEntry;
+				typedef struct
+				{
+					std::size_t operator()(const std::array<unsigned int, 3> & key) const
+					{
+						return (static_cast<std::size_t>(key[0]) * 1000003) ^ (static_cast<std::size_t>(key[1]) << 20) ^ key[2];
+					}
+				} TileKeyHash;
+				inline void loadIndex();
+				const std::string _archive_path;
+				const bool _for_writing;
+				int _data_fd = -1;
+				int _index_fd = -1;
+				unsigned int _square_length = 0;
+				unsigned long long int _data_size = 0;
+				unsigned long long int _index_size = 0;
+				std::mutex _write_mutex;
+				std::unordered_map<std::array<unsigned int, 3>,
+					std::pair<unsigned long long int, unsigned long long int>, TileKeyHash> _index;
+		};
+
+		// serves image requests that match tiles pre-rendered for a tiled data set straight from disk
+		class TissueStackPreTiledTileStore final
+		{
+			public:
+				TissueStackPreTiledTileStore & operator=(const TissueStackPreTiledTileStore&) = delete;
+				TissueStackPreTiledTileStore(const TissueStackPreTiledTileStore&) = delete;
+				static TissueStackPreTiledTileStore * instance();
+				static const bool doesInstanceExist();
+				void purgeInstance();
+
+				// false if there is no pre-rendered tile for the request, the caller renders it then
+				const bool serveTile(
+					const tissuestack::imaging::TissueStackImageData * image_data,
+					const tissuestack::networking::TissueStackImageRequest * request,
+					const int file_descriptor);
+
+				const unsigned long long int getNumberOfHits() const;
+				const unsigned long long int getNumberOfMisses() const;
+				const unsigned long long int getNumberOfNotModifiedResponses() const;
+				const std::string getStatisticsAsJson() const;
+			private:
+				static const unsigned int RECHECK_ARCHIVE_INTERVAL_IN_MILLIS = 30000;
+				static const unsigned int LEGACY_SQUARE_LENGTH = 256;
+				typedef struct
+				{
+					std::shared_ptr<const TissueStackTileArchive> archive;
+					unsigned long long int inode;
+					unsigned long long int checked_at;
+				} OpenArchive;
+
+				TissueStackPreTiledTileStore();
+				inline const int findZoomLevel(
+					const tissuestack::imaging::TissueStackImageData * image_data,
+					const float scale_factor) const;
+				inline std::shared_ptr<const TissueStackTileArchive> findArchive(
+					const std::string & archive_path,
+					unsigned long long int & inode);
+				std::string _tile_directory;
+				std::mutex _archives_mutex;
+				std::unordered_map<std::string, OpenArchive> _archives;
+				std::atomic<unsigned long long int> _hits;
+				std::atomic<unsigned long long int> _misses;
+				std::atomic<unsigned long long int> _not_modified;
+				static TissueStackPreTiledTileStore * _instance;
+		};
+
 		class NoCacheAdapter final
 		{
 			public:
@@ -833,6 +1207,11 @@ namespace tissuestack
 						const tissuestack::imaging::TissueStackRawData * image,
 						const tissuestack::networking::TissueStackImageRequest * request) const;
 
+				Image * extractAndProcessImage(
+					const tissuestack::common::ProcessingStrategy * processing_strategy,
+					const TissueStackRawData * image,
+					const tissuestack::networking::TissueStackImageRequest * request) const;
+
 				const std::array<unsigned long long int, 3> performQuery(
 					const tissuestack::common::ProcessingStrategy * processing_strategy,
 					const tissuestack::imaging::TissueStackRawData * image,
@@ -861,15 +1240,14 @@ namespace tissuestack
 						const tissuestack::imaging::TissueStackRawData * image,
 						const tissuestack::networking::TissueStackImageRequest * request) const;
 
-				const unsigned char * findCacheHit(
+				Image * extractAndProcessImage(
+					const tissuestack::common::ProcessingStrategy * processing_strategy,
 					const TissueStackRawData * image,
 					const tissuestack::networking::TissueStackImageRequest * request) const;
 
-				void addToCache(
-					const tissuestack::common::ProcessingStrategy * processing_strategy,
+				std::shared_ptr<const tissuestack::imaging::SliceCacheEntry> findOrLoadSlice(
 					const TissueStackRawData * image,
-					const tissuestack::networking::TissueStackImageRequest * request,
-					const unsigned char * data) const;
+					const tissuestack::networking::TissueStackImageRequest * request) const;
 
 				const std::array<unsigned long long int, 3> performQuery(
 					const tissuestack::common::ProcessingStrategy * processing_strategy,
@@ -992,7 +1370,7 @@ namespace tissuestack
 
 					const std::string httpResponseHeader =
 						tissuestack::utils::Misc::composeHttpResponse(
-							"200 OK", "text/json", response.str());
+							"200 OK", "text/json", response.str(), request->isKeepAlive());
 					write(file_descriptor, httpResponseHeader.c_str(), httpResponseHeader.length());
 				}
 
@@ -1035,28 +1413,76 @@ namespace tissuestack
 									"The length of the image square has to range in betwenn 0 and 1280");
 					}
 
-					// perform extraction
-					Image * img =
-						const_cast<Image *>(
-						this->_caching_strategy->extractImage(
+					std::string formatLowerCase =  request->getOutputImageFormat();
+					std::transform(formatLowerCase.begin(), formatLowerCase.end(), formatLowerCase.begin(), tolower);
+
+					// pre-tiled data sets: send the tile from disk if it has been rendered already
+					if (tissuestack::imaging::TissueStackPreTiledTileStore::instance()->serveTile(
+							imageData, request, file_descriptor))
+						return;
+
+					// identical tiles are requested over and over again => serve them from the response cache
+					tissuestack::imaging::TissueStackTileCache * tileCache =
+						tissuestack::imaging::TissueStackTileCache::instance();
+					const std::string cacheKey =
+						tissuestack::imaging::TissueStackTileCache::composeCacheKey(imageData->getFileName(), request);
+
+					std::shared_ptr<const tissuestack::imaging::RenderedTile> tile = tileCache->findTile(cacheKey);
+					if (!tile)
+					{
+						const unsigned long long int generation = tileCache->getGeneration();
+						tile =
+							this->renderTile(
 								processing_strategy,
 								static_cast<const tissuestack::imaging::TissueStackRawData *>(imageData),
-								request));
+								request,
+								formatLowerCase);
+						tileCache->addTile(
+							cacheKey, imageData->getFileName(), request->getColorMapName(), tile, generation);
+					}
 
-					// timeout/shutdown check
-					if (request->hasExpired() || processing_strategy->isStopFlagRaised())
+					// content negotiation: png/jpeg go out as they are, anything else gzipped if the client accepts it
+					const bool compressible = !tile->gzipped_body.empty();
+					const bool gzipped =
+						compressible &&
+						tissuestack::utils::Misc::acceptsGzipEncoding(request->getRequestHeader("Accept-Encoding"));
+					const std::string & body = gzipped ? tile->gzipped_body : tile->body;
+					const std::string & entityTag = gzipped ? tile->gzipped_entity_tag : tile->entity_tag;
+
+					// conditional request: the client has the very same bytes already
+					if (tissuestack::utils::Misc::matchesEntityTag(
+							request->getRequestHeader("If-None-Match"), entityTag))
 					{
-						DestroyImage(img);
-						THROW_TS_EXCEPTION(tissuestack::common::TissueStackObsoleteRequestException,
-							"Old Image Request!");
+						tileCache->countNotModifiedResponse();
+						const std::string notModified =
+							tissuestack::utils::Misc::composeHttpResponseHeader(
+								"304 Not Modified", tile->content_type, 0, request->isKeepAlive(), false, entityTag, compressible);
+						tissuestack::utils::Misc::writeHttpResponse(file_descriptor, notModified);
+						return;
 					}
 
-					// apply post processing
-					img =
-						this->_caching_strategy->applyPostExtractionTasks(
-						img,
-						static_cast<const tissuestack::imaging::TissueStackRawData *>(imageData),
-						request);
+					// header and image in one go
+					const std::string httpResponseHeader =
+						tissuestack::utils::Misc::composeHttpResponseHeader(
+							"200 OK", tile->content_type, body.length(), request->isKeepAlive(), gzipped, entityTag, compressible);
+					if (!tissuestack::utils::Misc::writeHttpResponse(file_descriptor, httpResponseHeader, body))
+						THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+							"Failed to write image response!");
+				};
+
+			private:
+				std::shared_ptr<const tissuestack::imaging::RenderedTile> renderTile(
+					const tissuestack::common::ProcessingStrategy * processing_strategy,
+					const tissuestack::imaging::TissueStackRawData * image,
+					const tissuestack::networking::TissueStackImageRequest * request,
+					const std::string & format)
+				{
+					// perform extraction and post processing
+					Image * img =
+						this->_caching_strategy->extractAndProcessImage(
+							processing_strategy,
+							image,
+							request);
 					if (img == NULL)
 						THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 							"Could not apply post extraction tasks to image");
@@ -1070,68 +1496,57 @@ namespace tissuestack
 					}
 
 					// this is the part were we start to serialize the output of our finished image work
-					std::string formatLowerCase =  request->getOutputImageFormat();
-					std::transform(formatLowerCase.begin(), formatLowerCase.end(), formatLowerCase.begin(), tolower);
-					strcpy(img->magick, formatLowerCase.c_str());
-					std::string image_format("image/");
-
-					// add the header beforehand
-					const std::string httpResponseHeader =
-							 tissuestack::utils::Misc::composeHttpResponse(
-									 "200 OK",
-									 image_format + formatLowerCase,
-									 "",
-									 true
-					);
+					strcpy(img->magick, format.c_str());
 
 					ExceptionInfo exception;
 					ImageInfo	*imgInfo = NULL;
 					GetExceptionInfo(&exception);
 					imgInfo = CloneImageInfo((ImageInfo *)NULL);
 					if (imgInfo == NULL)
+					{
+						DestroyImage(img);
 						THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 								"Could not create ImageInfo!");
-
-					write(file_descriptor, httpResponseHeader.c_str(), httpResponseHeader.length());
-
-					/*
-						FILE * handle = fdopen(file_descriptor, "w");
-						imgInfo->file = handle;
-
-						if (WriteImage(imgInfo, img) == MagickFail)
-						{
-							CatchException(&img->exception);
-							tissuestack::logging::TissueStackLogger::instance()->error(
-								"Failed to write out image: %s\n", img->exception.reason);
-						}
-					*/
+					}
 
 					size_t length = 0;
 					unsigned char * memImg =
 						static_cast<unsigned char *>(ImageToBlob(imgInfo, img, &length, &img->exception));
-					if (img) DestroyImage(img);
-					if (imgInfo) DestroyImageInfo(imgInfo);
+					if (length==0)
+						CatchException(&img->exception);
+					DestroyImage(img);
+					DestroyImageInfo(imgInfo);
 
 					if (length==0)
 					{
-						CatchException(&img->exception);
+						if (memImg) free(memImg);
 						THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 							"Failed to write image to memory!");
 					}
 
-					bool failedToGZip = !tissuestack::utils::Misc::streamGzippedDataToDescriptor(
-						memImg, length, file_descriptor);
-					if (memImg) free(memImg);
+					tissuestack::imaging::RenderedTile * tile = new tissuestack::imaging::RenderedTile();
+					tile->content_type = std::string("image/") + format;
+					tile->body.assign(reinterpret_cast<const char *>(memImg), length);
+					tile->entity_tag = tissuestack::utils::Misc::computeEntityTag(tile->body);
+
+					// entropy coded formats gain next to nothing from gzip, don't burn cpu on them
+					bool failedToGZip = false;
+					if (!tissuestack::utils::Misc::isCompressedContentType(tile->content_type))
+					{
+						failedToGZip = !tissuestack::utils::Misc::gzipData(memImg, length, tile->gzipped_body);
+						tile->gzipped_entity_tag = tissuestack::utils::Misc::computeEntityTag(tile->gzipped_body);
+					}
+					free(memImg);
 					if (failedToGZip)
+					{
+						delete tile;
 						THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 							"Failed to gzip image response!");
-					/*
-						fflush(handle);
-						if (handle) fclose(handle);
-					*/
-				};
+					}
+
+					return std::shared_ptr<const tissuestack::imaging::RenderedTile>(tile);
+				}
 
-			private:
 			 	std::mutex _dataset_addition_mutex;
 				CachingStrategy * _caching_strategy = nullptr;
 		};
@@ -1142,6 +1557,7 @@ namespace tissuestack
 				RawConverter & operator=(const RawConverter&) = delete;
 				RawConverter(const RawConverter&) = delete;
 				RawConverter();
+				~RawConverter();
 
 				void convert(
 					const tissuestack::common::ProcessingStrategy * processing_strategy,
@@ -1149,15 +1565,45 @@ namespace tissuestack
 					const std::string dimension = "",
 					const bool writeHeader = true);
 			private:
+				typedef struct
+				{
+					const tissuestack::imaging::TissueStackDataDimension * dimension;
+					unsigned short order;
+					unsigned long long int slice_number;
+				} ConversionUnit;
+
+				// a contiguous stretch of a reoriented slice that one slab contributes to
+				typedef struct
+				{
+					unsigned long long int first; // index into the pixels of the band
+					unsigned long long int pixel; // position within the reoriented slice
+					unsigned long long int length;
+				} PixelRun;
+
+				// the pixels of a reoriented slice that come from the slab currently in memory
+				typedef struct
+				{
+					std::vector<unsigned int> pixels;
+					std::vector<PixelRun> runs;
+				} SlabBand;
+
 				inline void convertSlice(
 					const tissuestack::imaging::TissueStackMincData * minc,
 					const mihandle_t & minc_handle,
+					std::mutex & read_mutex,
 					const unsigned long int slice_number,
-					const short dimension_number) const;
+					const short dimension_number,
+					const unsigned long long int offset) const;
 				inline void convertSlice(
 					const tissuestack::imaging::TissueStackNiftiData * nifti,
 					const unsigned long int slice_number,
-					const short dimension_number) const;
+					const short dimension_number,
+					const unsigned long long int offset) const;
+				inline void closeOutFile();
+				inline void writeSlice(
+					const unsigned char * data,
+					const unsigned long long int length,
+					const unsigned long long int offset) const;
 
 				inline void loopOverDimensions(
 						const tissuestack::common::ProcessingStrategy * processing_strategy,
@@ -1165,25 +1611,73 @@ namespace tissuestack
 						const std::string & dimension,
 						bool & resumed) const;
 
+				inline const bool transposeVolume(
+						const tissuestack::common::ProcessingStrategy * processing_strategy,
+						const tissuestack::services::TissueStackConversionTask * converter_task,
+						const unsigned long long int memory_budget,
+						bool & resumed) const;
+
+				inline void readSlab(
+						const tissuestack::imaging::TissueStackImageData * image_data,
+						const mihandle_t & minc_handle,
+						const unsigned long long int first_slice,
+						const unsigned long long int number_of_slices,
+						unsigned char * slab) const;
+
+				inline const bool computeReorientation(
+						const tissuestack::imaging::TissueStackImageData * image_data,
+						const tissuestack::imaging::TissueStackDataDimension * dim,
+						std::vector<unsigned int> & source_pixels) const;
+
 				void convertDicom(
 						const tissuestack::common::ProcessingStrategy * processing_strategy,
 						const tissuestack::services::TissueStackConversionTask * converter_task,
 						bool & resumed) const;
 
+				// consecutive dicom images of a 3D reconstruction, held in memory
+				// so that the other two planes can be written in bulk
+				typedef struct
+				{
+					unsigned int first_index;
+					unsigned int number_of_images;
+					unsigned long int width;
+					unsigned long int height;
+					unsigned char * data; // image after image, rgb
+				} DicomSlab;
+
+				// decoded rgb images of consecutive dicom files
+				typedef std::vector<std::unique_ptr<const unsigned char[]>> DecodedDicomImages;
+
+				inline const tissuestack::imaging::DicomFileWrapper * findDicom(
+						const tissuestack::imaging::TissueStackDicomData * dicom_data,
+						const unsigned int dicom_index) const;
+
+				inline void decodeDicomImages(
+						const tissuestack::common::ProcessingStrategy * processing_strategy,
+						const tissuestack::services::TissueStackConversionTask * converter_task,
+						const unsigned int first_index,
+						const unsigned int number_of_images,
+						const unsigned short number_of_threads,
+						DecodedDicomImages & images) const;
+
 				inline const bool convertDicom0(
 						const tissuestack::common::ProcessingStrategy * processing_strategy,
 						const tissuestack::services::TissueStackConversionTask * converter_task,
 						const unsigned int dicom_index,
-						const char dicomDimension = '\0') const;
+						const unsigned long long int offset,
+						const unsigned char * data_out,
+						DicomSlab * slab = nullptr) const;
 
-				inline void reconstructSliceFromDicom(
+				inline void reconstructSlicesFromDicom(
 						const tissuestack::common::ProcessingStrategy * processing_strategy,
 						const tissuestack::services::TissueStackConversionTask * converter_task,
-						const unsigned int dicom_index,
-						const unsigned long int dicom_width,
-						const unsigned long int dicom_height,
-						const unsigned long int dicom_slices,
-						const unsigned char * dicom_data) const;
+						const DicomSlab & slab,
+						const unsigned long int dicom_slices) const;
+
+				inline const bool advanceProgress(
+						const tissuestack::common::ProcessingStrategy * processing_strategy,
+						const tissuestack::services::TissueStackConversionTask * converter_task,
+						const unsigned long long int slices) const;
 
 				inline void iteratOverPixelsAndConvert(
 					void * in,
@@ -1195,6 +1689,30 @@ namespace tissuestack
 					const bool isRgb,
 					const unsigned short rgb_channel) const;
 
+				// the rescaling of values to 0..255 is done in blocks of this many values
+				static const unsigned int RESCALE_BLOCK_SIZE = 256;
+
+				template <typename ValueType, typename ComputeType>
+				inline void rescaleToUnsignedChar(
+					const ValueType * in,
+					unsigned char * out,
+					const unsigned long long int size,
+					const double min,
+					const double max,
+					const bool isRgb,
+					const unsigned short rgb_channel) const;
+
+				template <typename ValueType>
+				inline void rescaleToUnsignedChar(
+					const ValueType * in,
+					unsigned char * out,
+					const unsigned long long int size,
+					const double min,
+					const double max,
+					const bool isRgb,
+					const unsigned short rgb_channel,
+					const bool single_precision) const;
+
 				inline unsigned long long mapUnsignedValue(
 					const unsigned char fromBitRange,
 					const unsigned char toBitRange,
@@ -1218,6 +1736,10 @@ namespace tissuestack
 				inline const bool hasBeenCancelledOrShutDown(
 					const tissuestack::common::ProcessingStrategy * processing_strategy,
 					const tissuestack::services::TissueStackConversionTask * converter_task) const;
+				// the same check without erasing the partial output, safe to call from the workers
+				inline const bool isCancelledOrShutDown(
+					const tissuestack::common::ProcessingStrategy * processing_strategy,
+					const tissuestack::services::TissueStackConversionTask * converter_task) const;
 
 				int _file_descriptor = -1;
 
@@ -1238,10 +1760,43 @@ namespace tissuestack
 					const tissuestack::common::ProcessingStrategy * processing_strategy,
 					const tissuestack::services::TissueStackTilingTask * pretiling_task) const;
 
+				typedef struct
+				{
+					std::string dimension_name;
+					const tissuestack::imaging::TissueStackDataDimension * dimension;
+					unsigned int slice_number;
+				} TilingUnit;
+
+				// the archives of one tiling run, opened lazily and shared by all workers.
+				// null if tiles are to be written as individual files
+				typedef struct
+				{
+					std::mutex mutex;
+					unsigned int square_length;
+					std::unordered_map<std::string, std::unique_ptr<TissueStackTileArchive>> archives;
+				} TileArchives;
+
 				inline void loopOverDimensions(
 						const tissuestack::common::ProcessingStrategy * processing_strategy,
 						const tissuestack::services::TissueStackTilingTask * pretiling_task) const;
 
+				// tiles all zoom levels of one slice, false if tiling was cancelled/shut down
+				inline const bool tileSlice(
+						const tissuestack::common::ProcessingStrategy * processing_strategy,
+						const tissuestack::services::TissueStackTilingTask * pretiling_task,
+						TileArchives * archives,
+						const TilingUnit & unit) const;
+
+				inline void tileZoomLevel(
+						const tissuestack::services::TissueStackTilingTask * pretiling_task,
+						TileArchives * archives,
+						const Image * img,
+						const unsigned int sliceNumber,
+						const std::string & dimension_name,
+						const unsigned short zoom,
+						const unsigned long int width,
+						const unsigned long int height) const;
+
 				inline void writeImageToFile(
 					Image * img,
 					const std::string & tile_dir,
@@ -1252,6 +1807,18 @@ namespace tissuestack
 					const unsigned int x = 0,
 					const unsigned int y = 0) const;
 
+				inline TissueStackTileArchive * findOrOpenArchive(
+					TileArchives * archives,
+					const std::string & archive_path) const;
+
+				inline void writeImageToArchive(
+					Image * img,
+					TissueStackTileArchive * archive,
+					const unsigned int slice_number,
+					const std::string & format,
+					const unsigned int x,
+					const unsigned int y) const;
+
 				UncachedImageExtraction * _extractor = nullptr;
 		};
 	}
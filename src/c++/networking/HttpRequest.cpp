@@ -80,6 +80,10 @@ tissuestack::networking::HttpRequest::HttpRequest(const RawHttpRequest * const r
 	// parse query string and stuff every parameter into the map!
 	this->processsQueryString();
 
+	// some of the headers matter to us as well (e.g. conditional requests)
+	if (!this->isFileUpload())
+		this->processHeaders(raw_content);
+
 	// we have passed all preliminary checks => assign us the new type
 	this->setType(tissuestack::common::Request::Type::HTTP);
 
@@ -203,6 +207,54 @@ const std::string tissuestack::networking::HttpRequest::getParameter(std::string
 	return std::string("");
 }
 
+void tissuestack::networking::HttpRequest::processHeaders(const std::string & raw_content)
+{
+	const size_t endOfHeaders = raw_content.find("\r\n\r\n");
+	size_t cursor = raw_content.find("\r\n");
+
+	while (cursor != std::string::npos && cursor < endOfHeaders)
+	{
+		cursor += 2;
+		size_t endOfLine = raw_content.find("\r\n", cursor);
+		if (endOfLine == std::string::npos)
+			endOfLine = raw_content.length();
+
+		const size_t colon = raw_content.find(':', cursor);
+		if (colon != std::string::npos && colon < endOfLine)
+		{
+			// header names are case insensitive, we store them upper case like the parameters
+			std::string name = raw_content.substr(cursor, colon - cursor);
+			std::transform(name.begin(), name.end(), name.begin(), toupper);
+
+			size_t valueStart = colon + 1;
+			while (valueStart < endOfLine && (raw_content[valueStart] == ' ' || raw_content[valueStart] == '\t'))
+				valueStart++;
+			size_t valueEnd = endOfLine;
+			while (valueEnd > valueStart && (raw_content[valueEnd-1] == ' ' || raw_content[valueEnd-1] == '\t'))
+				valueEnd--;
+
+			this->_headers[name] = raw_content.substr(valueStart, valueEnd - valueStart);
+		}
+		cursor = endOfLine < raw_content.length() ? endOfLine : std::string::npos;
+	}
+}
+
+const std::string tissuestack::networking::HttpRequest::getHeader(std::string name) const
+{
+	std::transform(name.begin(), name.end(), name.begin(), toupper);
+
+	auto header = this->_headers.find(name);
+	if (header == this->_headers.end())
+		return std::string("");
+
+	return header->second;
+}
+
+std::unordered_map<std::string, std::string> tissuestack::networking::HttpRequest::getHeaderMap() const
+{
+	return this->_headers;
+}
+
 void tissuestack::networking::HttpRequest::dumpParametersIntoDebugLog() const
 {
 	std::ostringstream in;
@@ -355,3 +355,19 @@ const unsigned int tissuestack::networking::TissueStackImageRequest::getYCoordin
 	return this->_y_coordinate;
 }
 
+void tissuestack::networking::TissueStackImageRequest::setRequestHeaders(
+	const std::unordered_map<std::string, std::string> & headers)
+{
+	this->_request_headers = headers;
+}
+
+const std::string tissuestack::networking::TissueStackImageRequest::getRequestHeader(std::string name) const
+{
+	std::transform(name.begin(), name.end(), name.begin(), toupper);
+
+	auto header = this->_request_headers.find(name);
+	if (header == this->_request_headers.end())
+		return std::string("");
+
+	return header->second;
+}
@@ -55,10 +55,16 @@ const tissuestack::common::Request * const tissuestack::networking::TissueStackR
 
 	// instantiate the appropriate request class
 	tissuestack::common::Request * return_request = nullptr;
-	if (tissuestack::networking::TissueStackImageRequest::SERVICE1.compare(service) == 0)
-		return_request = new tissuestack::networking::TissueStackImageRequest(parameters, false);
-	else if (tissuestack::networking::TissueStackImageRequest::SERVICE2.compare(service) == 0)
-		return_request = new tissuestack::networking::TissueStackImageRequest(parameters, true);
+	if (tissuestack::networking::TissueStackImageRequest::SERVICE1.compare(service) == 0 ||
+			tissuestack::networking::TissueStackImageRequest::SERVICE2.compare(service) == 0)
+	{
+		tissuestack::networking::TissueStackImageRequest * imageRequest =
+			new tissuestack::networking::TissueStackImageRequest(
+				parameters, tissuestack::networking::TissueStackImageRequest::SERVICE2.compare(service) == 0);
+		// image responses are conditional and content negotiated
+		imageRequest->setRequestHeaders(httpRequest->getHeaderMap());
+		return_request = imageRequest;
+	}
 	else if (tissuestack::networking::TissueStackQueryRequest::SERVICE.compare(service) == 0)
 		return_request = new tissuestack::networking::TissueStackQueryRequest(parameters);
 	else if (tissuestack::networking::TissueStackServicesRequest::SERVICE.compare(service) == 0)
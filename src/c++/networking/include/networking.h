@@ -59,15 +59,19 @@ namespace tissuestack
     		const std::string getContent() const;
     		const std::string getFileUploadStart() const;
     		std::unordered_map<std::string, std::string> getParameterMap() const;
+    		const std::string getHeader(std::string name) const;
+    		std::unordered_map<std::string, std::string> getHeaderMap() const;
     		const bool isObsolete() const;
     		const bool isFileUpload() const;
     	private:
     		inline void addQueryParameter(std::string & key, std::string value);
+    		void processHeaders(const std::string & raw_content);
     		inline void partiallyURIDecodeString(std::string& potentially_uri_encoded_string);
     		void processsQueryString();
     		inline int skipNextCharacterCheck(int& lengthOfQueryString, int & cursor, int & nPos, std::string & key);
     		inline void subProcessQueryString(int& lengthOfQueryString, int & cursor, int & nPos, std::string & key);
     		std::unordered_map<std::string, std::string> _parameters;
+    		std::unordered_map<std::string, std::string> _headers;
     		std::string _query_string = "";
     		static std::unordered_map<std::string,std::string> MinimalURIDecodingTable;
     		bool _isFileUpload = false;
@@ -102,6 +106,8 @@ namespace tissuestack
 			const bool showOnlyPortionOfImage() const;
 			const bool isPreview() const;
 			const bool hasExpired() const;
+			void setRequestHeaders(const std::unordered_map<std::string, std::string> & headers);
+			const std::string getRequestHeader(std::string name) const;
 		protected:
 			TissueStackImageRequest();
 			void setDataSetFromRequestParameters(const std::unordered_map<std::string, std::string> & request_parameters);
@@ -128,6 +134,7 @@ namespace tissuestack
 			unsigned short _contrast_max = 255;
 			unsigned long long int _request_id = 0;
 			unsigned long long int _request_timestamp = 0;
+			std::unordered_map<std::string, std::string> _request_headers;
     };
 
     class TissueStackQueryRequest final : public TissueStackImageRequest
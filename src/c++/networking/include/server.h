@@ -37,14 +37,254 @@ namespace tissuestack
   namespace networking
   {
   	  static const unsigned short MAX_CONNECTIONS = 1024;
+  	  static const unsigned int MAX_REQUEST_HEADER_SIZE = 65536;
   	  template <typename ProcessorImplementation> class Server;
 
 	  template <typename ProcessorImplementation>
   	  class ServerSocketSelector final
   	  {
   	  	  private:
+    		typedef struct
+    		{
+    			std::string buffer;
+    			unsigned int requests_served;
+    			time_t last_activity;
+    			bool busy;
+    		} ClientConnection;
+
     		const tissuestack::networking::Server<ProcessorImplementation> * _server;
     		tissuestack::execution::TissueStackOnlineExecutor * _executor = nullptr;
+    		int _epoll_controller = -1;
+    		unsigned int _keep_alive_timeout = 15;
+    		unsigned int _keep_alive_max_requests = 100;
+    		std::unordered_map<int, ClientConnection> _connections;
+    		std::mutex _connections_mutex;
+
+    		static const bool isFileUpload(const std::string & raw_content)
+    		{
+    			return raw_content.find("POST") == 0 &&
+					raw_content.find("service=services") != std::string::npos &&
+					raw_content.find("sub_service=admin") != std::string::npos &&
+					raw_content.find("action=upload") != std::string::npos;
+    		};
+
+    		static const std::string findHeaderValue(const std::string & lower_case_headers, const std::string & header)
+    		{
+    			size_t pos = lower_case_headers.find("\r\n" + header + ":");
+    			if (pos == std::string::npos)
+    				return "";
+
+    			pos += header.length() + 3;
+    			const size_t end = lower_case_headers.find("\r\n", pos);
+    			std::string value = lower_case_headers.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    			value.erase(0, value.find_first_not_of(" \t"));
+    			value.erase(value.find_last_not_of(" \t") + 1);
+
+    			return value;
+    		};
+
+    		static const bool isPersistentRequest(const std::string & request)
+    		{
+    			std::string headers = request.substr(0, request.find("\r\n\r\n"));
+    			std::transform(headers.begin(), headers.end(), headers.begin(), tolower);
+
+    			const std::string connection = findHeaderValue(headers, "connection");
+    			if (connection.compare("close") == 0)
+    				return false;
+    			if (connection.compare("keep-alive") == 0)
+    				return true;
+
+    			// HTTP/1.1 is persistent by default, HTTP/1.0 is not
+    			const size_t endOfRequestLine = headers.find("\r\n");
+    			return headers.rfind("http/1.1", endOfRequestLine) != std::string::npos;
+    		};
+
+    		static const bool extractNextRequest(std::string & buffer, std::string & request)
+    		{
+    			// requests are framed by CRLFCRLF plus whatever the Content-Length announces
+    			const size_t endOfHeaders = buffer.find("\r\n\r\n");
+    			if (endOfHeaders == std::string::npos)
+    				return false;
+
+    			std::string headers = buffer.substr(0, endOfHeaders);
+    			std::transform(headers.begin(), headers.end(), headers.begin(), tolower);
+    			const unsigned long long int contentLength =
+    				strtoull(findHeaderValue(headers, "content-length").c_str(), NULL, 10);
+
+    			const unsigned long long int requestLength = endOfHeaders + 4 + contentLength;
+    			if (buffer.length() < requestLength)
+    				return false;
+
+    			request = buffer.substr(0, requestLength);
+    			buffer.erase(0, requestLength);
+
+    			return true;
+    		};
+
+    		void addConnection(int fd)
+    		{
+    			std::lock_guard<std::mutex> lock(this->_connections_mutex);
+
+    			this->_connections[fd] = { "", 0, time(NULL), false };
+
+    			struct epoll_event ev;
+    			ev.data.fd = fd;
+    			ev.events = EPOLLIN | EPOLLONESHOT; // read, one request batch at a time
+    			if (epoll_ctl(this->_epoll_controller, EPOLL_CTL_ADD, fd, &ev) == -1)
+    			{
+    				this->_connections.erase(fd);
+    				close(fd);
+    				THROW_TS_EXCEPTION(tissuestack::common::TissueStackServerException,
+    					"Failed to add client to epoll list!");
+    			}
+    		};
+
+    		void closeConnection(int fd)
+    		{
+    			std::lock_guard<std::mutex> lock(this->_connections_mutex);
+
+    			// erase before close: the descriptor number may be handed out again by accept
+    			this->_connections.erase(fd);
+    			epoll_ctl(this->_epoll_controller, EPOLL_CTL_DEL, fd, NULL);
+    			close(fd);
+    		};
+
+    		void releaseConnection(int fd, const bool keep_alive)
+    		{
+    			if (!keep_alive || this->_server->isStopping())
+    			{
+    				this->closeConnection(fd);
+    				return;
+    			}
+
+    			std::lock_guard<std::mutex> lock(this->_connections_mutex);
+
+    			auto connection = this->_connections.find(fd);
+    			if (connection == this->_connections.end())
+    				return;
+    			connection->second.busy = false;
+    			connection->second.last_activity = time(NULL);
+
+    			// back into the epoll set, pending pipelined data triggers right away
+    			struct epoll_event ev;
+    			ev.data.fd = fd;
+    			ev.events = EPOLLIN | EPOLLONESHOT;
+    			if (epoll_ctl(this->_epoll_controller, EPOLL_CTL_MOD, fd, &ev) == -1)
+    			{
+    				this->_connections.erase(fd);
+    				close(fd);
+    			}
+    		};
+
+    		void closeIdleConnections()
+    		{
+    			std::lock_guard<std::mutex> lock(this->_connections_mutex);
+
+    			const time_t now = time(NULL);
+    			for (auto connection = this->_connections.begin(); connection != this->_connections.end();)
+    			{
+    				if (!connection->second.busy &&
+    					(now - connection->second.last_activity) >= static_cast<time_t>(this->_keep_alive_timeout))
+    				{
+    					epoll_ctl(this->_epoll_controller, EPOLL_CTL_DEL, connection->first, NULL);
+    					close(connection->first);
+    					connection = this->_connections.erase(connection);
+    				} else
+    					++connection;
+    			}
+    		};
+
+    		void closeAllConnections()
+    		{
+    			std::lock_guard<std::mutex> lock(this->_connections_mutex);
+
+    			for (auto connection : this->_connections)
+    				if (!connection.second.busy)
+    					close(connection.first);
+    			this->_connections.clear();
+    		};
+
+    		void readFromConnection(int fd)
+    		{
+    			char data_buffer[tissuestack::common::SOCKET_READ_BUFFER_SIZE];
+    			bool peerHasClosed = false;
+    			std::vector<std::string> requests;
+    			bool closeAfterwards = false;
+
+    			{
+    				std::lock_guard<std::mutex> lock(this->_connections_mutex);
+
+    				auto entry = this->_connections.find(fd);
+    				if (entry == this->_connections.end())
+    					return;
+    				ClientConnection & connection = entry->second;
+
+    				// read till we have EAGAIN
+    				while (true)
+    				{
+    					ssize_t bytesReceived = recv(fd, data_buffer, sizeof(data_buffer), 0);
+    					if (bytesReceived > 0)
+    					{
+    						connection.buffer.append(data_buffer, bytesReceived);
+    						// file uploads read the remainder of the stream themselves
+    						if (isFileUpload(connection.buffer) &&
+    							connection.buffer.find("\r\n") != std::string::npos)
+    							break;
+    						continue;
+    					}
+    					if (bytesReceived == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+    						peerHasClosed = true;
+    					if (bytesReceived < 0 && errno == EINTR)
+    						continue;
+    					break;
+    				}
+    				connection.last_activity = time(NULL);
+
+    				if (isFileUpload(connection.buffer) &&
+    					connection.buffer.find("\r\n") != std::string::npos)
+    				{
+    					requests.push_back(connection.buffer);
+    					connection.buffer.clear();
+    					closeAfterwards = true;
+    				} else
+    				{
+    					std::string request;
+    					while (extractNextRequest(connection.buffer, request))
+    						requests.push_back(request);
+
+    					// honour the cap on requests per connection
+    					const unsigned int remaining =
+    						this->_keep_alive_max_requests - connection.requests_served;
+    					if (requests.size() >= remaining)
+    					{
+    						requests.resize(remaining);
+    						closeAfterwards = true;
+    					}
+    					if (peerHasClosed)
+    						closeAfterwards = true;
+    				}
+    				connection.requests_served += requests.size();
+    				connection.busy = !requests.empty();
+    			}
+
+    			if (requests.empty())
+    			{
+    				// incomplete request: wait for more unless the peer left or sends garbage
+    				bool giveUp = peerHasClosed;
+    				if (!giveUp)
+    				{
+    					std::lock_guard<std::mutex> lock(this->_connections_mutex);
+    					giveUp = this->_connections[fd].buffer.length() > tissuestack::networking::MAX_REQUEST_HEADER_SIZE;
+    				}
+    				if (giveUp)
+    					this->closeConnection(fd);
+    				else
+    					this->releaseConnection(fd, true);
+    				return;
+    			}
+
+    			this->dispatchRequests(fd, requests, closeAfterwards);
+    		};
 
   		public:
     		ServerSocketSelector(const tissuestack::networking::Server<ProcessorImplementation> * server) :
@@ -54,6 +294,13 @@ namespace tissuestack
   						"ServerSocket was either handed a null instance of a server object or the server is stopping/not running anyway!");
 
   				this->_executor = tissuestack::execution::TissueStackOnlineExecutor::instance();
+
+  				const unsigned int timeout =
+  					strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("keep_alive_timeout").c_str(), NULL, 10);
+  				if (timeout > 0) this->_keep_alive_timeout = timeout;
+  				const unsigned int maxRequests =
+  					strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("keep_alive_max_requests").c_str(), NULL, 10);
+  				if (maxRequests > 0) this->_keep_alive_max_requests = maxRequests;
   			};
 
     		~ServerSocketSelector()
@@ -62,21 +309,35 @@ namespace tissuestack
     				delete this->_executor;
     		};
 
-    		void dispatchRequest(int request_descriptor, const std::string request_data)
+    		void dispatchRequests(int request_descriptor, const std::vector<std::string> requests, const bool close_afterwards)
     		{
     			const std::function<void (const tissuestack::common::ProcessingStrategy * _this)> * f = new
     					std::function<void (const tissuestack::common::ProcessingStrategy * _this)>(
-    				  [this, request_data, request_descriptor] (const tissuestack::common::ProcessingStrategy * _this)
+    				  [this, requests, request_descriptor, close_afterwards] (const tissuestack::common::ProcessingStrategy * _this)
     				  {
+    					bool keepAlive = !close_afterwards;
     					try
     					{
-    						this->_executor->execute(_this, request_data, request_descriptor);
+    						// pipelined requests are answered in the order they came in
+    						for (unsigned int i = 0; i < requests.size(); i++)
+    						{
+    							// decided up front so that the response can announce it
+    							const bool keepConnection =
+    								isPersistentRequest(requests[i]) &&
+    								!(close_afterwards && i == requests.size() - 1) &&
+    								!this->_server->isStopping();
+    							keepAlive =
+    								this->_executor->execute(_this, requests[i], request_descriptor, keepConnection);
+    							if (!keepAlive)
+    								break;
+    						}
     					}  catch (std::exception& bad)
     					{
     						// close connection and log error
-    						close(request_descriptor);
+    						keepAlive = false;
     						tissuestack::logging::TissueStackLogger::instance()->error("Something bad happened: %s\n", bad.what());
     					}
+    					this->releaseConnection(request_descriptor, keepAlive);
     				  });
     			this->_server->_processor->process(f);
       		};
@@ -84,8 +345,8 @@ namespace tissuestack
   			void startEventLoop()
   			{
 				// create the epoll 'controller'
-				int epollController = epoll_create(1);
-				if(epollController == -1)
+				this->_epoll_controller = epoll_create(1);
+				if(this->_epoll_controller == -1)
   					THROW_TS_EXCEPTION(tissuestack::common::TissueStackServerException,
   						"Failed to start EPOLLing!");
 
@@ -93,102 +354,72 @@ namespace tissuestack
 				epollEvent.data.fd = this->_server->getServerSocket(); // our server socket
 				epollEvent.events = EPOLLIN; // for READS only
 
-				if (epoll_ctl (epollController, EPOLL_CTL_ADD, epollEvent.data.fd, &epollEvent) == -1)
+				if (epoll_ctl (this->_epoll_controller, EPOLL_CTL_ADD, epollEvent.data.fd, &epollEvent) == -1)
   					THROW_TS_EXCEPTION(tissuestack::common::TissueStackServerException,
   						"Failed to start EPOLLing!");
 
 				struct epoll_event clientEvents[tissuestack::networking::MAX_CONNECTIONS];
+				time_t lastIdleCheck = time(NULL);
 
 				// loop for events until we stop the server
 				while(this->_server->isRunning() && !this->_server->isStopping())
 				{
+					// wake up once a second at least to time out idle connections
 					int numEvents =
 						epoll_wait(
-							epollController,
+							this->_epoll_controller,
 							clientEvents,
 							tissuestack::networking::MAX_CONNECTIONS,
-							-1);
+							1000);
 
 					// loop over event client triggered events ...
 					for (int i = 0; i < numEvents; i++)
 					{
-						// something went wrong when epolling ...
-						if ((clientEvents[i].events & EPOLLERR) ||
-								(clientEvents[i].events & EPOLLHUP) ||
-								(!(clientEvents[i].events & EPOLLIN)))
-							continue;
-
 						// we have a new client connecting
 						if (clientEvents[i].data.fd == this->_server->getServerSocket())
 						{
+							if (!(clientEvents[i].events & EPOLLIN))
+								continue;
+
 							struct sockaddr_in new_client;
 							unsigned int addrlen = sizeof(new_client);
 
 							// accept new client
 							int new_fd = accept(this->_server->getServerSocket(), (struct sockaddr *) &new_client, &addrlen);
-							if (!tissuestack::utils::System::makeSocketNonBlocking(new_fd))
-								THROW_TS_EXCEPTION(tissuestack::common::TissueStackServerException, "Failed to make server socket non-blocking!");
 
 							// check accept status
 							if (new_fd  == -1 )  // NOK
 							{
-								if (!this->_server->isStopping())
+								if (!this->_server->isStopping() && errno != EAGAIN && errno != EWOULDBLOCK)
 									tissuestack::logging::TissueStackLogger::instance()->error("Failed to accept client connection!\n");
-							} else
-							{
-								struct epoll_event ev;
-								ev.data.fd = new_fd;
-								ev.events = EPOLLIN; //  read
-								if (epoll_ctl(epollController, EPOLL_CTL_ADD, new_fd, &ev) == -1)
-									THROW_TS_EXCEPTION(tissuestack::common::TissueStackServerException,
-										"Failed to add client to epoll list!");
 								continue;
 							}
+
+							if (!tissuestack::utils::System::makeSocketNonBlocking(new_fd))
+								THROW_TS_EXCEPTION(tissuestack::common::TissueStackServerException, "Failed to make server socket non-blocking!");
+							this->addConnection(new_fd);
 						}	else // else: we have data to be read from one of the connecting clients
 						{
-							// do an initial read with a pre-defined buffer size
-							int fd = clientEvents[i].data.fd;
-							char data_buffer[tissuestack::common::SOCKET_READ_BUFFER_SIZE];
-							ssize_t bytesReceived = recv(fd, data_buffer, sizeof(data_buffer), 0);
-							std::string raw_content = "";
-							std::ostringstream dataInputStream;
-
-							if (bytesReceived > 0)
+							// something went wrong or the client hung up without anything left to read
+							if ((clientEvents[i].events & EPOLLERR) ||
+								((clientEvents[i].events & EPOLLHUP) && !(clientEvents[i].events & EPOLLIN)))
 							{
-
-								raw_content = std::string(data_buffer, bytesReceived);
-								dataInputStream << raw_content;
-								// double check whether we got that first line
-								while (raw_content.find("\r\n") == std::string::npos)
-								{
-									// read again until we do...
-									bytesReceived = recv(fd, data_buffer, sizeof(data_buffer), 0);
-									raw_content = std::string(data_buffer, bytesReceived);
-									dataInputStream << raw_content;
-								}
-								raw_content = dataInputStream.str();
-								// we need to explicitly remove the file uploads from sending more events ...
-								if (raw_content.find("POST") == 0 &&
-									raw_content.find("service=services") != std::string::npos &&
-									raw_content.find("sub_service=admin") != std::string::npos &&
-									raw_content.find("action=upload") != std::string::npos)
-									epoll_ctl (epollController, EPOLL_CTL_DEL, fd, NULL);
-								else
-								{
-									// read till we have EAGAIN
-									while ((bytesReceived = recv(fd, data_buffer, sizeof(data_buffer), 0)) > 0)
-									{
-										raw_content = std::string(data_buffer, bytesReceived);
-										dataInputStream << raw_content;
-									}
-									raw_content = dataInputStream.str();
-								}
-								this->dispatchRequest(fd, raw_content);
+								this->closeConnection(clientEvents[i].data.fd);
+								continue;
 							}
+
+							this->readFromConnection(clientEvents[i].data.fd);
 						}
 					} // end event loop
+
+					if (time(NULL) - lastIdleCheck >= 1)
+					{
+						this->closeIdleConnections();
+						lastIdleCheck = time(NULL);
+					}
 				} // end polling loop
-			close(epollController); // close polling controller
+			this->closeAllConnections();
+			close(this->_epoll_controller); // close polling controller
   		};
   	};
 
@@ -63,6 +63,8 @@ void tissuestack::services::ColorMapService::streamResponse(
 		sJson = tissuestack::common::NO_RESULTS_JSON;
 
 	const std::string response =
-			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json", sJson);
-	write(file_descriptor, response.c_str(), response.length());
+			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json", sJson, request->isKeepAlive());
+	if (!tissuestack::utils::Misc::writeHttpResponse(file_descriptor, response))
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Failed to write service response!");
 }
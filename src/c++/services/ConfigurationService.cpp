@@ -15,6 +15,7 @@
  * along with TissueStack.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "networking.h"
+#include "execution.h"
 #include "imaging.h"
 #include "database.h"
 #include "services.h"
@@ -30,6 +31,7 @@ tissuestack::services::ConfigurationService::ConfigurationService() {
 	this->addMandatoryParametersForRequest("SUPPORTS_IMAGE_SERVICE", std::vector<std::string>{});
 	this->addMandatoryParametersForRequest("QUERY", std::vector<std::string>{"KEY"});
 	this->addMandatoryParametersForRequest("CHANGE", std::vector<std::string>{"SESSION", "KEY", "VALUE"});
+	this->addMandatoryParametersForRequest("STATISTICS", std::vector<std::string>{});
 };
 
 tissuestack::services::ConfigurationService::~ConfigurationService() {};
@@ -47,6 +49,12 @@ void tissuestack::services::ConfigurationService::streamResponse(
 {
 	const std::string action = request->getRequestParameter("ACTION", true);
 
+	if (action.compare("STATISTICS") == 0)
+	{
+		this->streamStatistics(processing_strategy, request, file_descriptor);
+		return;
+	}
+
 	std::vector<const tissuestack::database::Configuration *> conf;
 	if (action.compare("ALL") == 0)
 		conf =
@@ -100,6 +108,44 @@ void tissuestack::services::ConfigurationService::streamResponse(
 		json << tissuestack::common::NO_RESULTS_JSON;
 
 	const std::string response =
-			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json", json.str());
-	write(file_descriptor, response.c_str(), response.length());
+			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json", json.str(), request->isKeepAlive());
+	if (!tissuestack::utils::Misc::writeHttpResponse(file_descriptor, response))
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Failed to write service response!");
+}
+
+void tissuestack::services::ConfigurationService::streamStatistics(
+		const tissuestack::common::ProcessingStrategy * processing_strategy,
+		const tissuestack::networking::TissueStackServicesRequest * request,
+		const int file_descriptor) const
+{
+	std::ostringstream json;
+	json << "{ \"response\": { ";
+
+	const tissuestack::execution::WorkStealingThreadPool * threadPool =
+		dynamic_cast<const tissuestack::execution::WorkStealingThreadPool *>(processing_strategy);
+	json << "\"thread_pool\": " << (threadPool == nullptr ? "null" : threadPool->getStatisticsAsJson());
+	json << ", \"slice_cache\": " <<
+		(tissuestack::imaging::TissueStackSliceCache::doesInstanceExist() ?
+			tissuestack::imaging::TissueStackSliceCache::instance()->getStatisticsAsJson() : "null");
+	json << ", \"lookup_tables\": " <<
+		(tissuestack::imaging::TissueStackLookupTableCache::doesInstanceExist() ?
+			tissuestack::imaging::TissueStackLookupTableCache::instance()->getStatisticsAsJson() : "null");
+	json << ", \"tile_cache\": " <<
+		(tissuestack::imaging::TissueStackTileCache::doesInstanceExist() ?
+			tissuestack::imaging::TissueStackTileCache::instance()->getStatisticsAsJson() : "null");
+	json << ", \"pre_tiled_tiles\": " <<
+		(tissuestack::imaging::TissueStackPreTiledTileStore::doesInstanceExist() ?
+			tissuestack::imaging::TissueStackPreTiledTileStore::instance()->getStatisticsAsJson() : "null");
+	json << ", \"database_pool\": " <<
+		(tissuestack::database::TissueStackPostgresConnector::doesInstanceExist() ?
+			tissuestack::database::TissueStackPostgresConnector::instance()->getStatisticsAsJson() : "null");
+
+	json << " } }";
+
+	const std::string response =
+			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json", json.str(), request->isKeepAlive());
+	if (!tissuestack::utils::Misc::writeHttpResponse(file_descriptor, response))
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Failed to write service response!");
 }
@@ -72,8 +72,10 @@ void tissuestack::services::DataSetConfigurationService::streamResponse(
 	{
 		const std::string response =
 			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json",
-				tissuestack::common::NO_RESULTS_JSON);
-		write(file_descriptor, response.c_str(), response.length());
+				tissuestack::common::NO_RESULTS_JSON, request->isKeepAlive());
+		if (!tissuestack::utils::Misc::writeHttpResponse(file_descriptor, response))
+			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+				"Failed to write service response!");
 		return;
 	}
 
@@ -92,6 +94,8 @@ void tissuestack::services::DataSetConfigurationService::streamResponse(
 	json << "] }";
 
 	const std::string response =
-			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json", json.str());
-	write(file_descriptor, response.c_str(), response.length());
+			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json", json.str(), request->isKeepAlive());
+	if (!tissuestack::utils::Misc::writeHttpResponse(file_descriptor, response))
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Failed to write service response!");
 }
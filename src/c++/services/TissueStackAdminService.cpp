@@ -29,6 +29,7 @@ tissuestack::services::TissueStackAdminService::TissueStackAdminService() {
 		std::vector<std::string>{ "FILE"});
 	this->addMandatoryParametersForRequest("PROGRESS",
 		std::vector<std::string>{ "TASK_ID"});
+	this->addMandatoryParametersForRequest("PROGRESS_STREAM", std::vector<std::string>{});
 	/* need session */
 	this->addMandatoryParametersForRequest("UPLOAD",
 		std::vector<std::string>{ "SESSION"});
@@ -63,6 +64,13 @@ void tissuestack::services::TissueStackAdminService::streamResponse(
 {
 	const std::string action = request->getRequestParameter("ACTION", true);
 
+	// progress streams write their response as they go
+	if (action.compare("PROGRESS_STREAM") == 0)
+	{
+		this->handleProgressStreamRequest(processing_strategy, request, file_descriptor);
+		return;
+	}
+
 	std::string json = tissuestack::common::NO_RESULTS_JSON;
 
 	// do the requests that need no session first
@@ -107,8 +115,10 @@ void tissuestack::services::TissueStackAdminService::streamResponse(
 	}
 
 	const std::string response =
-			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json", json);
-	write(file_descriptor, response.c_str(), response.length());
+			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json", json, request->isKeepAlive());
+	if (!tissuestack::utils::Misc::writeHttpResponse(file_descriptor, response))
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Failed to write service response!");
 }
 
 const std::string tissuestack::services::TissueStackAdminService::handleDataSetDeletionRequest(
@@ -295,6 +305,8 @@ const std::string tissuestack::services::TissueStackAdminService::handleUploadRe
 		// we have been cancelled, delete the incomplete file
 		unlink((dir + "/" + fileName).c_str());
 		unlink((dir + "/." + fileName + ".upload").c_str());
+		tissuestack::services::TissueStackProgressNotifier::instance()->publishUploadProgress(
+			fileName, -1, tissuestack::services::TissueStackTaskStatus::CANCELLED);
 		return "{ \"response\": \"Upload of file '" + fileName + "' cancelled!\"}";
 	};
 
@@ -311,6 +323,8 @@ int tissuestack::services::TissueStackAdminService::createUploadFiles(
 	if (fd <= 0)
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 			"Could not write temporary upload progress file!");
+	tissuestack::services::TissueStackProgressNotifier::instance()->publishUploadProgress(
+		file_name, 0, tissuestack::services::TissueStackTaskStatus::IN_PROCESS);
 	const std::string progress = std::string("0/") + std::to_string(supposedFileSize) + "\n";
 	if (write(fd, progress.c_str(), progress.size()) < 0)
 		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
@@ -812,12 +826,167 @@ const std::string tissuestack::services::TissueStackAdminService::handleProgress
 		std::to_string(hit->getStatus()) + "}}";
 }
 
+void tissuestack::services::TissueStackAdminService::handleProgressStreamRequest(
+	const tissuestack::common::ProcessingStrategy * processing_strategy,
+	const tissuestack::networking::TissueStackServicesRequest * request,
+	const int fd) const
+{
+	// task ids and upload file names come comma separated
+	std::vector<tissuestack::services::TissueStackAdminService::StreamedProgress> streamed;
+	for (const std::string & task_id :
+			tissuestack::utils::Misc::tokenizeString(request->getRequestParameter("TASK_ID", true), ','))
+		streamed.push_back({ task_id, false, false, false, 0 });
+	for (const std::string & file_name :
+			tissuestack::utils::Misc::tokenizeString(request->getRequestParameter("FILE"), ','))
+		streamed.push_back({ file_name, true, false, false, 0 });
+
+	if (streamed.empty())
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Progress stream needs a TASK_ID and/or FILE!");
+
+	if (!tissuestack::services::TissueStackProgressNotifier::instance()->openStream())
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Too many progress streams! Please poll for PROGRESS/UPLOAD_PROGRESS instead.");
+
+	bool isComplete = false;
+	if (tissuestack::utils::Misc::writeHttpResponse(
+			fd, tissuestack::utils::Misc::composeHttpStreamHeader("text/event-stream", request->isKeepAlive())))
+	{
+		// from here on the response is under way: whatever goes wrong only ends the stream
+		try
+		{
+			isComplete = this->streamProgress(processing_strategy, fd, streamed);
+		} catch (std::exception & bad)
+		{
+			tissuestack::logging::TissueStackLogger::instance()->error(
+				"Progress stream ended prematurely: %s\n", bad.what());
+		}
+
+		// clients are told whether there is anything left to come back for
+		if (tissuestack::utils::Misc::writeHttpChunk(
+				fd, std::string("event: end\ndata: {\"complete\": ") + (isComplete ? "true" : "false") + "}\n\n"))
+			tissuestack::utils::Misc::writeHttpChunk(fd, "");
+	}
+
+	tissuestack::services::TissueStackProgressNotifier::instance()->closeStream();
+}
+
+inline const bool tissuestack::services::TissueStackAdminService::streamProgress(
+	const tissuestack::common::ProcessingStrategy * processing_strategy,
+	const int fd,
+	std::vector<tissuestack::services::TissueStackAdminService::StreamedProgress> & streamed) const
+{
+	tissuestack::services::TissueStackProgressNotifier * notifier =
+		tissuestack::services::TissueStackProgressNotifier::instance();
+
+	const unsigned long int timeout =
+		strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("progress_stream_timeout").c_str(), NULL, 10);
+	const std::chrono::steady_clock::time_point endOfStream =
+		std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+	std::chrono::steady_clock::time_point lastWrite = std::chrono::steady_clock::now();
+	unsigned long long int generation = 0;
+
+	// reconnecting clients should not hammer us
+	if (!tissuestack::utils::Misc::writeHttpChunk(fd, "retry: 5000\n\n"))
+		return false;
+
+	while (!processing_strategy->isStopFlagRaised())
+	{
+		std::string events = "";
+		bool isComplete = true;
+		for (tissuestack::services::TissueStackAdminService::StreamedProgress & progress : streamed)
+		{
+			if (progress.is_done)
+				continue;
+			events += this->composeProgressEvent(progress);
+			if (!progress.is_done)
+				isComplete = false;
+		}
+
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (events.empty() &&
+				now - lastWrite >= std::chrono::seconds(
+					tissuestack::services::TissueStackAdminService::PROGRESS_STREAM_HEARTBEAT_IN_SECONDS))
+			events = ": keep-alive\n\n"; // a comment, it keeps proxies from timing us out
+		if (!events.empty())
+		{
+			// a write that fails means the client has gone
+			if (!tissuestack::utils::Misc::writeHttpChunk(fd, events))
+				return false;
+			lastWrite = now;
+		}
+
+		if (isComplete)
+			return true;
+		if (now >= endOfStream)
+			return false;
+
+		// deltas are sent a few times a second at most, whatever comes in between is merged
+		if (!events.empty())
+			std::this_thread::sleep_for(std::chrono::milliseconds(
+				tissuestack::services::TissueStackAdminService::PROGRESS_STREAM_INTERVAL_IN_MILLIS));
+		generation = notifier->waitForProgress(
+			generation, tissuestack::services::TissueStackAdminService::PROGRESS_STREAM_WAIT_IN_MILLIS);
+	}
+
+	return false;
+}
+
+inline const std::string tissuestack::services::TissueStackAdminService::composeProgressEvent(
+	tissuestack::services::TissueStackAdminService::StreamedProgress & streamed) const
+{
+	const std::string key =
+		std::string(streamed.is_upload ? "\"file\": \"" : "\"task_id\": \"") +
+		tissuestack::utils::Misc::maskQuotesInJson(streamed.key) + "\"";
+
+	tissuestack::services::TissueStackProgressNotifier::ProgressUpdate update;
+	const bool hasBeenPublished =
+		streamed.is_upload ?
+			tissuestack::services::TissueStackProgressNotifier::instance()->findUploadProgress(streamed.key, update) :
+			tissuestack::services::TissueStackProgressNotifier::instance()->findTaskProgress(streamed.key, update);
+
+	if (!hasBeenPublished)
+	{
+		// an upload may not have got going yet
+		if (streamed.is_upload || streamed.has_been_reported)
+			return "";
+
+		// a task that has not made progress since we started or has been done for a while
+		tissuestack::services::TissueStackTaskSummary summary;
+		streamed.has_been_reported = true;
+		if (!tissuestack::services::TissueStackTaskQueue::instance()->findTaskSummary(streamed.key, summary))
+		{
+			streamed.is_done = true;
+			return "event: error\ndata: {" + key + ", \"error\": \"Task does not exist!\"}\n\n";
+		}
+		update.progress = summary.progress;
+		update.status = summary.status;
+		update.generation = 0;
+	} else if (streamed.has_been_reported && update.generation <= streamed.generation)
+		return "";
+
+	streamed.has_been_reported = true;
+	streamed.generation = update.generation;
+	streamed.is_done = tissuestack::services::TissueStackProgressNotifier::isFinalStatus(update.status);
+
+	return "event: progress\ndata: {" + key +
+		", \"progress\": " + std::to_string(update.progress) +
+		", \"status\": " + std::to_string(update.status) + "}\n\n";
+}
+
 inline void tissuestack::services::TissueStackAdminService::writeUploadProgress(
 		const std::string filename,
 		const unsigned long long int partial,
 		const unsigned long long int total
 	) const
 {
+	tissuestack::services::TissueStackProgressNotifier::instance()->publishUploadProgress(
+		filename,
+		total == 0 ? 0 : (static_cast<float>(partial) / static_cast<float>(total)) * static_cast<float>(100),
+		partial >= total ?
+			tissuestack::services::TissueStackTaskStatus::FINISHED :
+			tissuestack::services::TissueStackTaskStatus::IN_PROCESS);
+
 	{
 		int fd =
 			open((tissuestack::services::TissueStackAdminService::getUploadDirectory() + "/." + filename + ".upload" ).c_str(),
@@ -0,0 +1,191 @@
+/*
+ * This file is part of TissueStack.
+ *
+ * TissueStack is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TissueStack is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TissueStack.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "networking.h"
+#include "imaging.h"
+#include "database.h"
+#include "services.h"
+
+tissuestack::services::TissueStackProgressNotifier::TissueStackProgressNotifier()
+{
+	const unsigned long int maxStreams =
+		strtoul(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("progress_streams_max").c_str(), NULL, 10);
+	this->_max_streams = static_cast<unsigned short>(std::min<unsigned long int>(maxStreams, 1000));
+}
+
+tissuestack::services::TissueStackProgressNotifier::~TissueStackProgressNotifier() {}
+
+const bool tissuestack::services::TissueStackProgressNotifier::doesInstanceExist()
+{
+	return (tissuestack::services::TissueStackProgressNotifier::_instance != nullptr);
+}
+
+void tissuestack::services::TissueStackProgressNotifier::purgeInstance()
+{
+	if (tissuestack::services::TissueStackProgressNotifier::_instance)
+	{
+		delete tissuestack::services::TissueStackProgressNotifier::_instance;
+		tissuestack::services::TissueStackProgressNotifier::_instance = nullptr;
+	}
+}
+
+tissuestack::services::TissueStackProgressNotifier * tissuestack::services::TissueStackProgressNotifier::instance()
+{
+	if (tissuestack::services::TissueStackProgressNotifier::_instance == nullptr)
+		tissuestack::services::TissueStackProgressNotifier::_instance =
+			new tissuestack::services::TissueStackProgressNotifier();
+
+	return tissuestack::services::TissueStackProgressNotifier::_instance;
+}
+
+const bool tissuestack::services::TissueStackProgressNotifier::isFinalStatus(
+	const tissuestack::services::TissueStackTaskStatus status)
+{
+	return status == tissuestack::services::TissueStackTaskStatus::FINISHED ||
+		status == tissuestack::services::TissueStackTaskStatus::CANCELLED ||
+		status == tissuestack::services::TissueStackTaskStatus::ERRONEOUS;
+}
+
+void tissuestack::services::TissueStackProgressNotifier::publishTaskProgress(
+	const std::string & task_id,
+	const float progress,
+	const tissuestack::services::TissueStackTaskStatus status)
+{
+	this->publish(this->_task_progress, false, task_id, progress, status);
+}
+
+void tissuestack::services::TissueStackProgressNotifier::publishUploadProgress(
+	const std::string & file_name,
+	const float progress,
+	const tissuestack::services::TissueStackTaskStatus status)
+{
+	this->publish(this->_upload_progress, true, file_name, progress, status);
+}
+
+inline void tissuestack::services::TissueStackProgressNotifier::publish(
+	ProgressUpdates & updates,
+	const bool is_upload,
+	const std::string & key,
+	const float progress,
+	const tissuestack::services::TissueStackTaskStatus status)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->_progress_mutex);
+
+		tissuestack::services::TissueStackProgressNotifier::ProgressUpdate & update = updates[key];
+		this->_generation++;
+		update.progress = progress;
+		update.status = status;
+		update.generation = this->_generation;
+
+		if (tissuestack::services::TissueStackProgressNotifier::isFinalStatus(status))
+		{
+			const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			this->forgetFinishedProgress(now);
+			this->_finished_progress.push_back({ now, is_upload, key, update.generation });
+		}
+	}
+
+	this->_progress_published.notify_all();
+}
+
+inline void tissuestack::services::TissueStackProgressNotifier::forgetFinishedProgress(
+	const std::chrono::steady_clock::time_point & now)
+{
+	const std::chrono::steady_clock::time_point cutOff =
+		now - std::chrono::seconds(
+			tissuestack::services::TissueStackProgressNotifier::FINISHED_PROGRESS_RETENTION_IN_SECONDS);
+
+	while (!this->_finished_progress.empty() &&
+			this->_finished_progress.front().finished_at < cutOff)
+	{
+		const FinishedProgress & finished = this->_finished_progress.front();
+		ProgressUpdates & updates =
+			finished.is_upload ? this->_upload_progress : this->_task_progress;
+
+		// an upload of the same name might have started over since
+		const ProgressUpdates::iterator hit = updates.find(finished.key);
+		if (hit != updates.end() && hit->second.generation == finished.generation)
+			updates.erase(hit);
+
+		this->_finished_progress.pop_front();
+	}
+}
+
+const bool tissuestack::services::TissueStackProgressNotifier::findTaskProgress(
+	const std::string & task_id,
+	tissuestack::services::TissueStackProgressNotifier::ProgressUpdate & update)
+{
+	std::lock_guard<std::mutex> lock(this->_progress_mutex);
+
+	const ProgressUpdates::const_iterator hit = this->_task_progress.find(task_id);
+	if (hit == this->_task_progress.end())
+		return false;
+
+	update = hit->second;
+	return true;
+}
+
+const bool tissuestack::services::TissueStackProgressNotifier::findUploadProgress(
+	const std::string & file_name,
+	tissuestack::services::TissueStackProgressNotifier::ProgressUpdate & update)
+{
+	std::lock_guard<std::mutex> lock(this->_progress_mutex);
+
+	const ProgressUpdates::const_iterator hit = this->_upload_progress.find(file_name);
+	if (hit == this->_upload_progress.end())
+		return false;
+
+	update = hit->second;
+	return true;
+}
+
+const unsigned long long int tissuestack::services::TissueStackProgressNotifier::waitForProgress(
+	const unsigned long long int generation,
+	const unsigned int wait_in_millis)
+{
+	std::unique_lock<std::mutex> lock(this->_progress_mutex);
+
+	// the generation tells a stream whether anything was published since it last looked
+	this->_progress_published.wait_for(
+		lock,
+		std::chrono::milliseconds(wait_in_millis),
+		[this, generation] { return this->_generation != generation; });
+
+	return this->_generation;
+}
+
+const bool tissuestack::services::TissueStackProgressNotifier::openStream()
+{
+	std::lock_guard<std::mutex> lock(this->_progress_mutex);
+
+	// every stream holds on to a request thread
+	if (this->_open_streams >= this->_max_streams)
+		return false;
+
+	this->_open_streams++;
+	return true;
+}
+
+void tissuestack::services::TissueStackProgressNotifier::closeStream()
+{
+	std::lock_guard<std::mutex> lock(this->_progress_mutex);
+
+	if (this->_open_streams > 0)
+		this->_open_streams--;
+}
+
+tissuestack::services::TissueStackProgressNotifier * tissuestack::services::TissueStackProgressNotifier::_instance = nullptr;
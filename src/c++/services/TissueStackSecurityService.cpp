@@ -115,8 +115,10 @@ void tissuestack::services::TissueStackSecurityService::streamResponse(
 	}
 
 	const std::string response =
-			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json", json.str());
-	write(file_descriptor, response.c_str(), response.length());
+			tissuestack::utils::Misc::composeHttpResponse("200 OK", "application/json", json.str(), request->isKeepAlive());
+	if (!tissuestack::utils::Misc::writeHttpResponse(file_descriptor, response))
+		THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
+			"Failed to write service response!");
 }
 
 const bool tissuestack::services::TissueStackSecurityService::isAdminPassword(const std::string & password) const
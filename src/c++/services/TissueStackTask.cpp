@@ -139,6 +139,14 @@ const bool tissuestack::services::TissueStackTask::incrementSlicesDone()
 	return false;
 }
 
+void tissuestack::services::TissueStackTask::publishProgress() const
+{
+	// only the server streams progress, offline conversions and tilings have nobody listening
+	if (tissuestack::services::TissueStackProgressNotifier::doesInstanceExist())
+		tissuestack::services::TissueStackProgressNotifier::instance()->publishTaskProgress(
+			this->_id, this->getProgress(), this->_status);
+}
+
 const std::string tissuestack::services::TissueStackTask::getInputFileName() const
 {
 	return this->_input_file;
@@ -20,7 +20,14 @@
 #include "database.h"
 #include "services.h"
 
-tissuestack::services::TissueStackTaskQueue::TissueStackTaskQueue()
+tissuestack::services::TissueStackTaskQueue::TissueStackTaskQueue() :
+	_task_file_generation(0),
+	_journal_flush_slices(
+		strtoull(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("task_progress_flush_slices").c_str(), NULL, 10)),
+	_journal_flush_interval(
+		strtoull(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("task_progress_flush_interval").c_str(), NULL, 10)),
+	_task_history_size(
+		strtoull(tissuestack::TissueStackConfigurationParameters::instance()->getParameter("task_history_size").c_str(), NULL, 10))
 {
 
 	const std::string dir =	tissuestack::services::TissueStackTaskQueue::getTasksDirectory();
@@ -29,13 +36,16 @@ tissuestack::services::TissueStackTaskQueue::TissueStackTaskQueue()
 			THROW_TS_EXCEPTION(tissuestack::common::TissueStackApplicationException,
 				"Could not create tasks directory!");
 
+	// the tasks that have gone already are read once, from then on the history is kept up to date in memory
+	this->loadTaskHistory();
+
 	// read in all task files listed in the queue file
 	const std::vector<std::string> tasksIds = this->getTasksFromQueueFile();
 
 	// walk through the list and build the task objects based on the task file content
 	// this makes sure that we don't modify the tasks while we are populating
 	{
-		std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+		std::lock_guard<tissuestack::utils::ReadWriteLock> lock(this->_tasks_lock);
 		for (auto id : tasksIds)
 			this->buildTaskFromIndividualTaskFile(id);
 	}
@@ -61,19 +71,23 @@ void tissuestack::services::TissueStackTaskQueue::purgeInstance()
 
 		// this makes sure that we don't modify the tasks while we are doing this traversal
 		{
-			std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+			std::lock_guard<tissuestack::utils::ReadWriteLock> lock(this->_tasks_lock);
 
 			// walk through entries, persist their state and clean them up
-			for (auto task : this->_tasks)
+			for (auto registered : this->_tasks)
 			{
-				if (task == nullptr)
+				if (registered.second.task == nullptr)
 					continue;
 
-				this->writeBackToIndividualTasksFile(task);
-				delete task;
+				this->writeBackToIndividualTasksFile(registered.second.task);
+				delete registered.second.task;
 			}
 			this->_tasks.clear();
+			this->_tasks_by_file.clear();
+			this->_ready_tasks.clear();
+			this->_running_tasks.clear();
 		}
+		this->notifyExecutors();
 
 		delete tissuestack::services::TissueStackTaskQueue::_instance;
 		tissuestack::services::TissueStackTaskQueue::_instance = nullptr;
@@ -92,43 +106,250 @@ void tissuestack::services::TissueStackTaskQueue::persistTaskProgress(const std:
 {
 	const tissuestack::services::TissueStackTask * hit =
 		this->findTaskById(task_id);
-	if (hit == nullptr)
+	if (hit == nullptr ||
+			hit->getStatus() == tissuestack::services::TissueStackTaskStatus::CANCELLED ||
+			hit->getStatus() == tissuestack::services::TissueStackTaskStatus::FINISHED ||
+			hit->getStatus() == tissuestack::services::TissueStackTaskStatus::ERRONEOUS)
 		return;
 
-	std::lock_guard<std::mutex> lock(this->_tasks_mutex);
-	this->writeBackToIndividualTasksFile(hit);
+	// streamed once per progress step, not for every slice counted in it
+	hit->publishProgress();
+
+	const unsigned long long int slicesDone = hit->getSlicesDone();
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> lock(this->_journal_mutex);
+
+	std::unordered_map<std::string, ProgressJournal>::iterator journal =
+		this->_progress_journals.find(task_id);
+	if (journal == this->_progress_journals.end())
+	{
+		ProgressJournal newJournal;
+		newJournal.file_descriptor = -1;
+		newJournal.slices_persisted = 0;
+		journal = this->_progress_journals.insert(std::make_pair(task_id, newJournal)).first;
+	}
+
+	// group commit: progress is appended once enough slices have been done or enough time has passed
+	if (journal->second.file_descriptor >= 0 &&
+			slicesDone < journal->second.slices_persisted + this->_journal_flush_slices &&
+			now - journal->second.persisted_at < std::chrono::milliseconds(this->_journal_flush_interval))
+		return;
+
+	if (journal->second.file_descriptor < 0)
+		journal->second.file_descriptor =
+			open(tissuestack::services::TissueStackTaskQueue::getProgressJournalFile(task_id).c_str(),
+				O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if (journal->second.file_descriptor < 0)
+	{
+		tissuestack::logging::TissueStackLogger::instance()->error(
+			"Could not open progress journal of task %s\n", task_id.c_str());
+		return;
+	}
+
+	// one line per record, a record cut short by a crash is ignored on replay
+	const std::string record = std::to_string(slicesDone) + "\n";
+	if (write(journal->second.file_descriptor, record.c_str(), record.size()) != static_cast<ssize_t>(record.size()))
+		tissuestack::logging::TissueStackLogger::instance()->error(
+			"Could not append to progress journal of task %s\n", task_id.c_str());
+
+	journal->second.slices_persisted = slicesDone;
+	journal->second.persisted_at = now;
 }
 
-inline void tissuestack::services::TissueStackTaskQueue::eraseTask(const std::string & task_id)
+void tissuestack::services::TissueStackTaskQueue::persistTask(const std::string & task_id)
 {
-	unsigned int i = 0;
-	for (auto task : this->_tasks)
+	TaskFileSnapshot snapshot;
 	{
-		if (task->getId().compare(task_id) == 0)
-		{
-			delete task;
+		std::lock_guard<tissuestack::utils::ReadWriteLock> lock(this->_tasks_lock);
+
+		const std::unordered_map<std::string, RegisteredTask>::const_iterator hit =
+			this->_tasks.find(task_id);
+		if (hit == this->_tasks.end())
+			return;
+
+		// unzipping gives the task a new input file
+		this->indexTaskFiles(hit->second.task);
+		snapshot = this->snapshotTaskFile(hit->second.task);
+	}
+
+	// readers of the task registry do not wait for the disk
+	this->writeTaskFile(snapshot);
+}
+
+const std::string tissuestack::services::TissueStackTaskQueue::getProgressJournalFile(const std::string & task_id)
+{
+	return tissuestack::services::TissueStackTaskQueue::getTasksDirectory() + "/" + task_id + ".journal";
+}
+
+inline const unsigned long long int tissuestack::services::TissueStackTaskQueue::replayProgressJournal(
+	const std::string & task_id,
+	const unsigned long long int slices_done) const
+{
+	std::ifstream journal(
+		tissuestack::services::TissueStackTaskQueue::getProgressJournalFile(task_id).c_str(), std::ifstream::in);
+	if (!journal.is_open())
+		return slices_done;
+
+	unsigned long long int progress = slices_done;
+	std::string record;
+	while (std::getline(journal, record))
+	{
+		if (journal.eof()) // no line ending: the record was cut short
 			break;
-		}
+		if (!tissuestack::utils::Misc::isNumber(record))
+			continue;
 
-		i++;
+		const unsigned long long int recordedProgress = strtoull(record.c_str(), NULL, 10);
+		if (recordedProgress > progress)
+			progress = recordedProgress;
 	}
-	if (i < this->_tasks.size())
-		this->_tasks.erase(this->_tasks.begin()+i);
+	journal.close();
+
+	return progress;
 }
 
-inline void tissuestack::services::TissueStackTaskQueue::writeBackToIndividualTasksFile(const tissuestack::services::TissueStackTask * task)
+inline void tissuestack::services::TissueStackTaskQueue::discardProgressJournal(const std::string & task_id)
 {
-	if (task == nullptr) return;
+	std::lock_guard<std::mutex> lock(this->_journal_mutex);
 
-	const std::string taskFile = tissuestack::services::TissueStackTaskQueue::getTasksDirectory() + "/" + task->getId();
-	int fd = open(taskFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
-	if (fd <= 0)
+	std::unordered_map<std::string, ProgressJournal>::iterator journal =
+		this->_progress_journals.find(task_id);
+	if (journal != this->_progress_journals.end())
 	{
-		tissuestack::logging::TissueStackLogger::instance()->error(
-			"Could not persist individual task file %s\n", task->getId().c_str());
-		return;
+		if (journal->second.file_descriptor >= 0)
+			close(journal->second.file_descriptor);
+		this->_progress_journals.erase(journal);
+	}
+
+	unlink(tissuestack::services::TissueStackTaskQueue::getProgressJournalFile(task_id).c_str());
+}
+
+bool tissuestack::services::TissueStackTaskQueue::ReadyTaskOrder::operator()(
+	const ReadyTask & one, const ReadyTask & other) const
+{
+	if (one.priority != other.priority)
+		return one.priority > other.priority;
+	if (one.work_left != other.work_left)
+		return one.work_left < other.work_left;
+
+	return one.sequence < other.sequence;
+}
+
+inline const std::string tissuestack::services::TissueStackTaskQueue::getInputFile(
+	const tissuestack::services::TissueStackTask * task)
+{
+	return task->getInputImageData() == nullptr ?
+		task->getInputFileName() :
+		task->getInputImageData()->getFileName();
+}
+
+inline void tissuestack::services::TissueStackTaskQueue::registerTask(const tissuestack::services::TissueStackTask * task)
+{
+	RegisteredTask registered;
+	registered.task = task;
+	registered.sequence = this->_next_sequence++;
+	registered.is_ready = false;
+
+	RegisteredTask & added =
+		this->_tasks.insert(std::make_pair(task->getId(), registered)).first->second;
+	this->indexTaskFiles(task);
+	if (task->getStatus() == tissuestack::services::TissueStackTaskStatus::QUEUED ||
+			task->getStatus() == tissuestack::services::TissueStackTaskStatus::UNZIPPING)
+		this->enqueueReadyTask(added);
+}
+
+inline void tissuestack::services::TissueStackTaskQueue::indexTaskFiles(const tissuestack::services::TissueStackTask * task)
+{
+	// a task is found by its (zipped or unzipped) input file and, for a conversion, its output file
+	std::vector<std::string> files = { task->getInputFileName(), getInputFile(task) };
+	if (task->getType() == tissuestack::services::TissueStackTaskType::CONVERSION)
+		files.push_back(static_cast<const tissuestack::services::TissueStackConversionTask *>(task)->getOutFile());
+
+	for (auto f : files)
+	{
+		bool isIndexed = false;
+		const auto range = this->_tasks_by_file.equal_range(f);
+		for (auto entry = range.first; entry != range.second && !isIndexed; entry++)
+			isIndexed = entry->second == task;
+		if (!isIndexed)
+			this->_tasks_by_file.insert(std::make_pair(f, task));
 	}
+}
+
+inline void tissuestack::services::TissueStackTaskQueue::unindexTaskFiles(const tissuestack::services::TissueStackTask * task)
+{
+	std::vector<std::string> files = { task->getInputFileName(), getInputFile(task) };
+	if (task->getType() == tissuestack::services::TissueStackTaskType::CONVERSION)
+		files.push_back(static_cast<const tissuestack::services::TissueStackConversionTask *>(task)->getOutFile());
+
+	for (auto f : files)
+	{
+		auto range = this->_tasks_by_file.equal_range(f);
+		while (range.first != range.second)
+			if (range.first->second == task)
+				range.first = this->_tasks_by_file.erase(range.first);
+			else
+				range.first++;
+	}
+}
+
+inline void tissuestack::services::TissueStackTaskQueue::enqueueReadyTask(RegisteredTask & registered_task)
+{
+	if (registered_task.is_ready)
+		return;
+
+	const bool isConversion =
+		registered_task.task->getType() == tissuestack::services::TissueStackTaskType::CONVERSION;
+
+	ReadyTask ready;
+	ready.priority =
+		strtol(tissuestack::TissueStackConfigurationParameters::instance()->getParameter(
+			isConversion ? "conversion_task_priority" : "tiling_task_priority").c_str(), NULL, 10);
+	// zipped data does not know its total yet, so it queues behind everything that does
+	ready.work_left =
+		registered_task.task->getTotalSlices() == 0 ? std::numeric_limits<unsigned long long int>::max() :
+			(registered_task.task->getTotalSlices() > registered_task.task->getSlicesDone() ?
+				registered_task.task->getTotalSlices() - registered_task.task->getSlicesDone() : 0);
+	ready.sequence = registered_task.sequence;
+	ready.task = registered_task.task;
+
+	registered_task.ready_position = this->_ready_tasks.insert(ready).first;
+	registered_task.is_ready = true;
+}
+
+inline void tissuestack::services::TissueStackTaskQueue::dequeueReadyTask(RegisteredTask & registered_task)
+{
+	if (!registered_task.is_ready)
+		return;
+
+	this->_ready_tasks.erase(registered_task.ready_position);
+	registered_task.is_ready = false;
+}
+
+inline void tissuestack::services::TissueStackTaskQueue::eraseTask(const std::string & task_id)
+{
+	std::unordered_map<std::string, RegisteredTask>::iterator hit =
+		this->_tasks.find(task_id);
+	if (hit == this->_tasks.end())
+		return;
+
+	this->dequeueReadyTask(hit->second);
+	this->unindexTaskFiles(hit->second.task);
+	delete hit->second.task;
+	this->_tasks.erase(hit);
+}
+
+inline void tissuestack::services::TissueStackTaskQueue::writeBackToIndividualTasksFile(const tissuestack::services::TissueStackTask * task)
+{
+	if (task == nullptr) return;
+
+	this->writeTaskFile(this->snapshotTaskFile(task));
+}
 
+inline const tissuestack::services::TissueStackTaskQueue::TaskFileSnapshot tissuestack::services::TissueStackTaskQueue::snapshotTaskFile(
+	const tissuestack::services::TissueStackTask * task)
+{
 	std::ostringstream taskFileContents;
 	if (task->getInputImageData() == nullptr)
 		taskFileContents << task->getInputFileName() << std::endl; // line 1 in_file
@@ -149,19 +370,74 @@ inline void tissuestack::services::TissueStackTaskQueue::writeBackToIndividualTa
 	taskFileContents << task->getSlicesDone() << std::endl; // line 4 progress
 	taskFileContents << task->getTotalSlices() << std::endl; // line 5 total work
 
-	const std::string contents = taskFileContents.str();
+	// line 6 => the global min/max of a nifti conversion so that a resume does not need to scan again
+	if (task->getType() == tissuestack::services::TissueStackTaskType::CONVERSION &&
+		task->getInputImageData() != nullptr &&
+		task->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::NIFTI)
+	{
+		const tissuestack::imaging::TissueStackNiftiData * nifti =
+			static_cast<const tissuestack::imaging::TissueStackNiftiData *>(task->getInputImageData());
+		if (nifti->hasGlobalMinMax())
+		{
+			char minMax[64];
+			snprintf(minMax, sizeof(minMax), "%.17g:%.17g", nifti->getMin(), nifti->getMax());
+			taskFileContents << minMax << std::endl;
+		}
+	}
+
+	return { task->getId(), taskFileContents.str(), task->getStatus(), ++this->_task_file_generation };
+}
+
+inline void tissuestack::services::TissueStackTaskQueue::writeTaskFile(
+	const tissuestack::services::TissueStackTaskQueue::TaskFileSnapshot & snapshot)
+{
+	// this makes sure that the same task file is not written simultaneously
+	std::lock_guard<std::mutex> lock(this->_task_files_mutex);
+
+	unsigned long long int & lastWritten = this->_task_file_generations[snapshot.task_id];
+	if (snapshot.generation < lastWritten)
+		return;
+	lastWritten = snapshot.generation;
+
+	// the task file is written next to the old one and renamed over it so that a crash cannot truncate it
+	const std::string taskFile = tissuestack::services::TissueStackTaskQueue::getTasksDirectory() + "/" + snapshot.task_id;
+	const std::string tempTaskFile = taskFile + ".tmp";
+	int fd = open(tempTaskFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd <= 0)
+	{
+		tissuestack::logging::TissueStackLogger::instance()->error(
+			"Could not persist individual task file %s\n", snapshot.task_id.c_str());
+		return;
+	}
+
 	// write to file
-	if (write(fd, contents.c_str(), contents.size()) < 0)
+	if (write(fd, snapshot.contents.c_str(), snapshot.contents.size()) != static_cast<ssize_t>(snapshot.contents.size()) ||
+			fsync(fd) != 0)
+	{
 		tissuestack::logging::TissueStackLogger::instance()->error(
-			"Could not write into individual task file %s\n", task->getId().c_str());
+			"Could not write into individual task file %s\n", snapshot.task_id.c_str());
+		close(fd);
+		unlink(tempTaskFile.c_str());
+		return;
+	}
 	close(fd);
+	if (rename(tempTaskFile.c_str(), taskFile.c_str()) != 0)
+	{
+		tissuestack::logging::TissueStackLogger::instance()->error(
+			"Could not replace individual task file %s\n", snapshot.task_id.c_str());
+		unlink(tempTaskFile.c_str());
+		return;
+	}
+
+	// the task file has caught up with the progress journal
+	this->discardProgressJournal(snapshot.task_id);
 
 	// rename if we are done or cancelled
-	if (task->getStatus() == tissuestack::services::TissueStackTaskStatus::CANCELLED)
+	if (snapshot.status == tissuestack::services::TissueStackTaskStatus::CANCELLED)
 		rename(taskFile.c_str(), (taskFile + ".cancelled").c_str());
-	else if (task->getStatus() == tissuestack::services::TissueStackTaskStatus::FINISHED)
+	else if (snapshot.status == tissuestack::services::TissueStackTaskStatus::FINISHED)
 		rename(taskFile.c_str(), (taskFile + ".done").c_str());
-	else if (task->getStatus() == tissuestack::services::TissueStackTaskStatus::ERRONEOUS)
+	else if (snapshot.status == tissuestack::services::TissueStackTaskStatus::ERRONEOUS)
 		rename(taskFile.c_str(), (taskFile + ".error").c_str());
 }
 
@@ -199,14 +475,24 @@ inline void tissuestack::services::TissueStackTaskQueue::flagTask(
 {
 	if (hit == nullptr) return;
 
+	TaskFileSnapshot snapshot;
 	{
-		std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+		std::lock_guard<tissuestack::utils::ReadWriteLock> lock(this->_tasks_lock);
+
+		std::unordered_map<std::string, RegisteredTask>::iterator registered =
+			this->_tasks.find(hit->getId());
+		if (registered == this->_tasks.end())
+			return;
 
 		const_cast<tissuestack::services::TissueStackTask *>(hit)->setStatus(status);
-		this->writeBackToIndividualTasksFile(hit);
+		snapshot = this->snapshotTaskFile(hit);
+		hit->publishProgress();
+		this->dequeueReadyTask(registered->second);
+		this->rememberTask(tissuestack::services::TissueStackTaskQueue::summarizeTask(hit));
 		if (erase_task) this->eraseTask(hit->getId());
 	}
 
+	this->writeTaskFile(snapshot);
 	this->writeTasksToQueueFile();
 }
 
@@ -218,6 +504,8 @@ inline void tissuestack::services::TissueStackTaskQueue::flagUnaddedTask(
 
 	const_cast<tissuestack::services::TissueStackTask *>(hit)->setStatus(status);
 	this->writeBackToIndividualTasksFile(hit);
+	hit->publishProgress();
+	this->rememberTask(tissuestack::services::TissueStackTaskQueue::summarizeTask(hit));
 	delete hit;
 }
 
@@ -227,14 +515,20 @@ void tissuestack::services::TissueStackTaskQueue::writeTasksToQueueFile()
 	std::ostringstream taskFileContents;
 	// this makes sure that we don't modify the tasks while we are doing this traversal
 	{
-		std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+		tissuestack::utils::SharedLock lock(this->_tasks_lock);
+
+		// in the order they were queued
+		std::vector<std::pair<unsigned long long int, std::string>> activeTasks;
+		for (auto registered : this->_tasks)
+			if (registered.second.task->getStatus() == tissuestack::services::TissueStackTaskStatus::QUEUED ||
+					registered.second.task->getStatus() == tissuestack::services::TissueStackTaskStatus::UNZIPPING ||
+					registered.second.task->getStatus() == tissuestack::services::TissueStackTaskStatus::IN_PROCESS)
+				activeTasks.push_back(std::make_pair(registered.second.sequence, registered.first));
+		std::sort(activeTasks.begin(), activeTasks.end());
 
 		taskFileContents << "";
-		for (auto task : this->_tasks)
-			if (task->getStatus() == tissuestack::services::TissueStackTaskStatus::QUEUED ||
-					task->getStatus() == tissuestack::services::TissueStackTaskStatus::UNZIPPING ||
-					task->getStatus() == tissuestack::services::TissueStackTaskStatus::IN_PROCESS)
-				taskFileContents << task->getId() << std::endl;
+		for (auto task : activeTasks)
+			taskFileContents << task.second << std::endl;
 	}
 
 	// this makes sure that we don't overwrite our queue file simultaneously
@@ -274,22 +568,19 @@ void tissuestack::services::TissueStackTaskQueue::writeTasksToQueueFile()
 const bool tissuestack::services::TissueStackTaskQueue::doesTaskExistForDataSet(
 	const std::string & name, const bool is_being_tiled_check, const bool is_being_converted_check)
 {
-	if (this->_tasks.empty() || name.empty()) return false;
+	if (name.empty()) return false;
 
-	// this makes sure that we don't modify the tasks while we are doing this traversal
-	std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+	tissuestack::utils::SharedLock lock(this->_tasks_lock);
 
 	unsigned int totalTasksForDataSet = 0;
 	unsigned int busyTasksForDataSet = 0;
 
-	for (auto t : this->_tasks)
+	const auto range = this->_tasks_by_file.equal_range(name);
+	for (auto entry = range.first; entry != range.second; entry++)
 	{
-		const std::string input_data_file_name =
-			t->getInputImageData() == nullptr ?
-				t->getInputFileName() :
-				t->getInputImageData()->getFileName();
+		const tissuestack::services::TissueStackTask * t = entry->second;
 
-		if (input_data_file_name.compare(name) == 0)
+		if (tissuestack::services::TissueStackTaskQueue::getInputFile(t).compare(name) == 0)
 		{
 			totalTasksForDataSet++;
 
@@ -330,22 +621,16 @@ const bool tissuestack::services::TissueStackTaskQueue::isBeingTiled(
 	if (check_t == nullptr)
 		return false;
 
-	const std::string in_file =
-		check_t->getInputImageData() == nullptr ?
-				check_t->getInputFileName() :
-				check_t->getInputImageData()->getFileName();
+	const std::string in_file = tissuestack::services::TissueStackTaskQueue::getInputFile(check_t);
 	if (in_file.empty() || !tissuestack::utils::System::fileExists(in_file)) return false;
 
-	// this makes sure that we don't modify the tasks while we are doing this traversal
-	std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+	tissuestack::utils::SharedLock lock(this->_tasks_lock);
 
-	for (auto t : this->_tasks)
+	const auto range = this->_tasks_by_file.equal_range(in_file);
+	for (auto entry = range.first; entry != range.second; entry++)
 	{
-		const std::string input_data_file_name =
-				t->getInputImageData() == nullptr ?
-					t->getInputFileName() :
-					t->getInputImageData()->getFileName();
-		if (input_data_file_name.compare(in_file) == 0
+		const tissuestack::services::TissueStackTask * t = entry->second;
+		if (tissuestack::services::TissueStackTaskQueue::getInputFile(t).compare(in_file) == 0
 				&& t->getType() == tissuestack::services::TissueStackTaskType::TILING
 				&& (t->getStatus() == tissuestack::services::TissueStackTaskStatus::QUEUED ||
 						t->getStatus() == tissuestack::services::TissueStackTaskStatus::IN_PROCESS)
@@ -380,77 +665,364 @@ void tissuestack::services::TissueStackTaskQueue::addTask(const tissuestack::ser
 			return;
 		}
 
+	TaskFileSnapshot snapshot;
 	{
-		// this makes sure that we don't modify the tasks while we are doing this traversal
-		std::lock_guard<std::mutex> lock(this->_tasks_mutex);
-		this->_tasks.push_back(task);
-
-		// add the task to the queue and write its individual task file
-		this->writeBackToIndividualTasksFile(task);
+		// this makes sure that we don't modify the tasks while we are adding
+		std::lock_guard<tissuestack::utils::ReadWriteLock> lock(this->_tasks_lock);
+		this->registerTask(task);
+		snapshot = this->snapshotTaskFile(task);
 	}
 
-	// now update the queue file
+	// write its individual task file, then update the queue file
+	this->writeTaskFile(snapshot);
 	this->writeTasksToQueueFile();
+
+	// wake up an idle executor slot
+	this->notifyExecutors();
 }
 
 const tissuestack::services::TissueStackTask * tissuestack::services::TissueStackTaskQueue::findTaskById(const std::string & id)
 {
-	std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+	tissuestack::utils::SharedLock lock(this->_tasks_lock);
 
-	for (auto t : this->_tasks)
-		if (t->getId().compare(id) == 0)
-			return t;
+	const std::unordered_map<std::string, RegisteredTask>::const_iterator hit =
+		this->_tasks.find(id);
 
-	return nullptr;
+	return hit == this->_tasks.end() ? nullptr : hit->second.task;
 }
 
-const tissuestack::services::TissueStackTask * tissuestack::services::TissueStackTaskQueue::getNextTask(const bool set_processing_flag)
+const bool tissuestack::services::TissueStackTaskQueue::hasQueuedTasks()
 {
-	std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+	tissuestack::utils::SharedLock lock(this->_tasks_lock);
 
-	if (this->_tasks.empty()) return nullptr;
+	return !this->_ready_tasks.empty();
+}
 
-	unsigned int t;
-	for (t=0;t<this->_tasks.size();t++) // fast forward past anything that is not queued
+const bool tissuestack::services::TissueStackTaskQueue::findTaskSummary(
+	const std::string & task_id, tissuestack::services::TissueStackTaskSummary & summary)
+{
 	{
-		if (this->_tasks[t]->getStatus() == tissuestack::services::TissueStackTaskStatus::QUEUED ||
-				this->_tasks[t]->getStatus() == tissuestack::services::TissueStackTaskStatus::UNZIPPING)
-			break;
-		t++;
+		tissuestack::utils::SharedLock lock(this->_tasks_lock);
+
+		const std::unordered_map<std::string, RegisteredTask>::const_iterator hit =
+			this->_tasks.find(task_id);
+		if (hit != this->_tasks.end())
+		{
+			summary = tissuestack::services::TissueStackTaskQueue::summarizeTask(hit->second.task);
+			return true;
+		}
 	}
 
-	if (t >= this->_tasks.size())
-		return nullptr; // we found no candidates
+	tissuestack::utils::SharedLock lock(this->_history_lock);
+
+	const std::map<unsigned long long int, tissuestack::services::TissueStackTaskSummary>::const_iterator hit =
+		this->_task_history.find(strtoull(task_id.c_str(), NULL, 10));
+	if (hit == this->_task_history.end())
+		return false;
+
+	summary = hit->second;
+	return true;
+}
+
+const std::vector<tissuestack::services::TissueStackTaskSummary> tissuestack::services::TissueStackTaskQueue::listTaskSummaries(
+	const tissuestack::services::TissueStackTaskType type,
+	const std::string & status,
+	const unsigned long long int offset,
+	const unsigned long long int limit,
+	unsigned long long int & total)
+{
+	// the tasks we still have whose end has not made it into the history yet, newest first
+	std::vector<std::pair<unsigned long long int, tissuestack::services::TissueStackTaskSummary>> queued;
+	{
+		tissuestack::utils::SharedLock lock(this->_tasks_lock);
+		for (auto registered : this->_tasks)
+		{
+			const tissuestack::services::TissueStackTask * t = registered.second.task;
+			if (t->getType() != type ||
+					t->getStatus() == tissuestack::services::TissueStackTaskStatus::FINISHED ||
+					t->getStatus() == tissuestack::services::TissueStackTaskStatus::CANCELLED ||
+					t->getStatus() == tissuestack::services::TissueStackTaskStatus::ERRONEOUS ||
+					!tissuestack::services::TissueStackTaskQueue::matchesStatusFilter(t->getStatus(), status))
+				continue;
+
+			queued.push_back(
+				std::make_pair(
+					strtoull(registered.first.c_str(), NULL, 10),
+					tissuestack::services::TissueStackTaskQueue::summarizeTask(t)));
+		}
+	}
+	std::sort(queued.begin(), queued.end(),
+		[] (const std::pair<unsigned long long int, tissuestack::services::TissueStackTaskSummary> & one,
+			const std::pair<unsigned long long int, tissuestack::services::TissueStackTaskSummary> & other)
+		{
+			return one.first > other.first;
+		});
+
+	// merge them with the history, newest first, and keep the requested page
+	std::vector<tissuestack::services::TissueStackTaskSummary> page;
+	total = 0;
+
+	tissuestack::utils::SharedLock lock(this->_history_lock);
+
+	std::vector<std::pair<unsigned long long int, tissuestack::services::TissueStackTaskSummary>>::const_iterator q =
+		queued.begin();
+	std::map<unsigned long long int, tissuestack::services::TissueStackTaskSummary>::const_reverse_iterator h =
+		this->_task_history.rbegin();
+	while (q != queued.end() || h != this->_task_history.rend())
+	{
+		const tissuestack::services::TissueStackTaskSummary * next = nullptr;
+		if (h == this->_task_history.rend() || (q != queued.end() && q->first > h->first))
+		{
+			next = &q->second;
+			q++;
+		} else
+		{
+			if (h->second.type == type &&
+					tissuestack::services::TissueStackTaskQueue::matchesStatusFilter(h->second.status, status))
+				next = &h->second;
+			h++;
+		}
+		if (next == nullptr)
+			continue;
+
+		if (total >= offset && (limit == 0 || total < offset + limit))
+			page.push_back(*next);
+		total++;
+	}
+
+	return page;
+}
+
+inline const tissuestack::services::TissueStackTaskSummary tissuestack::services::TissueStackTaskQueue::summarizeTask(
+	const tissuestack::services::TissueStackTask * task)
+{
+	tissuestack::services::TissueStackTaskSummary summary;
+	summary.id = task->getId();
+	summary.file_name = tissuestack::services::TissueStackTaskQueue::getInputFile(task);
+	summary.type = task->getType();
+	summary.status = task->getStatus();
+	summary.progress = task->getProgress();
+	summary.is_queued = true;
+
+	return summary;
+}
+
+inline const bool tissuestack::services::TissueStackTaskQueue::matchesStatusFilter(
+	const tissuestack::services::TissueStackTaskStatus status, const std::string & status_filter)
+{
+	if (status_filter.compare("ALL") == 0)
+		return true;
+	if (status_filter.compare("DONE") == 0)
+		return status == tissuestack::services::TissueStackTaskStatus::FINISHED;
+	if (status_filter.compare("CANCELLED") == 0)
+		return status == tissuestack::services::TissueStackTaskStatus::CANCELLED;
+	if (status_filter.compare("ERROR") == 0)
+		return status == tissuestack::services::TissueStackTaskStatus::ERRONEOUS;
+	if (status_filter.compare("ACTIVE") == 0)
+		return status == tissuestack::services::TissueStackTaskStatus::QUEUED ||
+			status == tissuestack::services::TissueStackTaskStatus::IN_PROCESS ||
+			status == tissuestack::services::TissueStackTaskStatus::UNZIPPING;
+
+	return false;
+}
+
+inline void tissuestack::services::TissueStackTaskQueue::rememberTask(
+	const tissuestack::services::TissueStackTaskSummary & summary)
+{
+	if (this->_task_history_size == 0)
+		return;
+
+	tissuestack::services::TissueStackTaskSummary remembered = summary;
+	remembered.is_queued = false;
+
+	std::lock_guard<tissuestack::utils::ReadWriteLock> lock(this->_history_lock);
+
+	this->_task_history[strtoull(summary.id.c_str(), NULL, 10)] = remembered;
+	while (this->_task_history.size() > this->_task_history_size)
+		this->_task_history.erase(this->_task_history.begin());
+}
+
+inline void tissuestack::services::TissueStackTaskQueue::loadTaskHistory()
+{
+	if (this->_task_history_size == 0)
+		return;
 
-	if (set_processing_flag &&
-		this->_tasks[t]->getStatus() != tissuestack::services::TissueStackTaskStatus::UNZIPPING)
-		const_cast<tissuestack::services::TissueStackTask *>(this->_tasks[t])->setStatus(
+	// task ids are creation times: going by the file names, only the most recent task files are read
+	std::map<unsigned long long int, std::pair<std::string, tissuestack::services::TissueStackTaskStatus>> taskFiles;
+	for (auto f : tissuestack::utils::System::getFilesInDirectory(
+			tissuestack::services::TissueStackTaskQueue::getTasksDirectory()))
+	{
+		const std::size_t slashPos = f.find_last_of("/");
+		const std::size_t dotPos = f.find(".", slashPos == std::string::npos ? 0 : slashPos);
+		if (dotPos == std::string::npos)
+			continue;
+
+		const std::string ending = f.substr(dotPos);
+		tissuestack::services::TissueStackTaskStatus status;
+		if (ending.compare(".done") == 0)
+			status = tissuestack::services::TissueStackTaskStatus::FINISHED;
+		else if (ending.compare(".error") == 0)
+			status = tissuestack::services::TissueStackTaskStatus::ERRONEOUS;
+		else if (ending.compare(".cancelled") == 0)
+			status = tissuestack::services::TissueStackTaskStatus::CANCELLED;
+		else
+			continue;
+
+		const std::string id =
+			f.substr(slashPos == std::string::npos ? 0 : slashPos + 1, dotPos - (slashPos == std::string::npos ? 0 : slashPos + 1));
+		if (!tissuestack::utils::Misc::isNumber(id))
+			continue;
+
+		taskFiles[strtoull(id.c_str(), NULL, 10)] = std::make_pair(f, status);
+		if (taskFiles.size() > this->_task_history_size)
+			taskFiles.erase(taskFiles.begin());
+	}
+
+	for (auto taskFile : taskFiles)
+	{
+		// see buildTaskFromIndividualTaskFile for the layout, we need lines 1, 2, 4 and 5
+		const std::vector<std::string> lines =
+			tissuestack::utils::System::readTextFileLineByLine(taskFile.second.first);
+		if (lines.size() < 5)
+			continue;
+
+		const unsigned short type = static_cast<unsigned short>(atoi(lines[1].c_str()));
+		if (type != tissuestack::services::TissueStackTaskType::CONVERSION &&
+				type != tissuestack::services::TissueStackTaskType::TILING)
+			continue;
+
+		const unsigned long long int sliceProgress = strtoull(lines[3].c_str(), NULL, 10);
+		const unsigned long long int totalSlices = strtoull(lines[4].c_str(), NULL, 10);
+
+		tissuestack::services::TissueStackTaskSummary summary;
+		summary.id = std::to_string(taskFile.first);
+		summary.file_name = tissuestack::utils::Misc::eraseCharacterFromString(lines[0], '\n');
+		summary.type = static_cast<tissuestack::services::TissueStackTaskType>(type);
+		summary.status = taskFile.second.second;
+		summary.progress = (totalSlices == 0 || sliceProgress > totalSlices) ? 0 :
+			(static_cast<float>(sliceProgress) / static_cast<float>(totalSlices)) * static_cast<float>(100);
+		this->rememberTask(summary);
+	}
+}
+
+const tissuestack::services::TissueStackTask * tissuestack::services::TissueStackTaskQueue::claimNextTask(
+	const unsigned short max_conversions,
+	const unsigned short max_tilings,
+	const unsigned int wait_in_millis)
+{
+	unsigned long long int generation = 0;
+	{
+		std::lock_guard<std::mutex> lock(this->_ready_mutex);
+		generation = this->_ready_generation;
+	}
+
+	const tissuestack::services::TissueStackTask * next =
+		this->claimNextCandidate(max_conversions, max_tilings);
+	if (next != nullptr) return next;
+
+	// sleep until a task is added or a slot is released, the timeout lets the caller check for shutdown
+	{
+		std::unique_lock<std::mutex> lock(this->_ready_mutex);
+		this->_task_available.wait_for(
+			lock,
+			std::chrono::milliseconds(wait_in_millis),
+			[this, generation] () { return this->_ready_generation != generation; });
+	}
+
+	return this->claimNextCandidate(max_conversions, max_tilings);
+}
+
+void tissuestack::services::TissueStackTaskQueue::releaseTask(const std::string & task_id)
+{
+	{
+		std::lock_guard<tissuestack::utils::ReadWriteLock> lock(this->_tasks_lock);
+		this->_running_tasks.erase(task_id);
+	}
+
+	// a slot has become available
+	this->notifyExecutors();
+}
+
+inline void tissuestack::services::TissueStackTaskQueue::notifyExecutors()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->_ready_mutex);
+		this->_ready_generation++;
+	}
+	this->_task_available.notify_all();
+}
+
+inline const tissuestack::services::TissueStackTask * tissuestack::services::TissueStackTaskQueue::claimNextCandidate(
+	const unsigned short max_conversions,
+	const unsigned short max_tilings)
+{
+	// idle slots only ever look
+	{
+		tissuestack::utils::SharedLock lock(this->_tasks_lock);
+		if (this->_ready_tasks.empty())
+			return nullptr;
+	}
+
+	std::lock_guard<tissuestack::utils::ReadWriteLock> lock(this->_tasks_lock);
+
+	const tissuestack::services::TissueStackTask * next =
+		this->findNextCandidate(max_conversions, max_tilings);
+	if (next == nullptr) return nullptr;
+
+	this->dequeueReadyTask(this->_tasks[next->getId()]);
+	this->_running_tasks[next->getId()] = next->getType();
+	if (next->getStatus() != tissuestack::services::TissueStackTaskStatus::UNZIPPING)
+		const_cast<tissuestack::services::TissueStackTask *>(next)->setStatus(
 			tissuestack::services::TissueStackTaskStatus::IN_PROCESS);
+	next->publishProgress();
 
-	return this->_tasks[t];
+	return next;
+}
+
+inline const tissuestack::services::TissueStackTask * tissuestack::services::TissueStackTaskQueue::findNextCandidate(
+	const unsigned short max_conversions,
+	const unsigned short max_tilings) const
+{
+	unsigned short runningConversions = 0;
+	unsigned short runningTilings = 0;
+	for (auto r : this->_running_tasks)
+		if (r.second == tissuestack::services::TissueStackTaskType::CONVERSION)
+			runningConversions++;
+		else
+			runningTilings++;
+
+	const bool canConvert = runningConversions < max_conversions;
+	const bool canTile = runningTilings < max_tilings;
+	if (!canConvert && !canTile) return nullptr;
+
+	// the ready queue is in order already, take the first one we have a slot for
+	for (auto ready : this->_ready_tasks)
+	{
+		const bool isConversion = ready.task->getType() == tissuestack::services::TissueStackTaskType::CONVERSION;
+		if ((isConversion && canConvert) || (!isConversion && canTile))
+			return ready.task;
+	}
+
+	return nullptr;
 }
 
 const bool tissuestack::services::TissueStackTaskQueue::isBeingConverted(const std::string in_file)
 {
 	if (in_file.empty() || !tissuestack::utils::System::fileExists(in_file)) return false;
 
-	// this makes sure that we don't modify the tasks while we are doing this traversal
-	std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+	tissuestack::utils::SharedLock lock(this->_tasks_lock);
 
-	for (auto t : this->_tasks)
+	const auto range = this->_tasks_by_file.equal_range(in_file);
+	for (auto entry = range.first; entry != range.second; entry++)
 	{
+		const tissuestack::services::TissueStackTask * t = entry->second;
 		if (t->getType() != tissuestack::services::TissueStackTaskType::CONVERSION)
 			continue;
 
 		const tissuestack::services::TissueStackConversionTask * conv_task =
 			static_cast<const tissuestack::services::TissueStackConversionTask *>(t);
 
-		const std::string input_data_file_name =
-				t->getInputImageData() == nullptr ?
-					t->getInputFileName() :
-					t->getInputImageData()->getFileName();
-
-		if ((input_data_file_name.compare(in_file) == 0 ||
+		if ((tissuestack::services::TissueStackTaskQueue::getInputFile(t).compare(in_file) == 0 ||
 				conv_task->getOutFile().compare(in_file) == 0)
 				&& (conv_task->getStatus() == tissuestack::services::TissueStackTaskStatus::QUEUED ||
 					conv_task->getStatus() == tissuestack::services::TissueStackTaskStatus::UNZIPPING ||
@@ -483,13 +1055,18 @@ inline void tissuestack::services::TissueStackTaskQueue::buildTaskFromIndividual
 	 *		given the params above and the order of work/dimensions
 	 * 5. line:
 	 *		'total slice number' as determined by the params above
+	 * 6. line (optional):
+	 *		for a nifti conversion: the global 'min:max' once it has been determined
 	 *
 	 * All of the information is needed and if missing we'll make a note of that in the error log
+	 *
+	 * Progress made while running is appended to <task id>.journal, one slice number per line,
+	 * and supersedes line 4 if it is further along
 	 */
-	if (lines.size() != 5)
+	if (lines.size() != 5 && lines.size() != 6)
 	{
 		tissuestack::logging::TissueStackLogger::instance()->error(
-				"Task File %s does not have 5 lines!\n", task_id.c_str());
+				"Task File %s does not have 5 or 6 lines!\n", task_id.c_str());
 		return;
 	}
 
@@ -500,6 +1077,10 @@ inline void tissuestack::services::TissueStackTaskQueue::buildTaskFromIndividual
 
 	unsigned long long int sliceProgress = 0;
 	unsigned long long int totalSlices = 0;
+	std::vector<std::string> minMax;
+	const bool hasProgressJournal =
+		tissuestack::utils::System::fileExists(
+			tissuestack::services::TissueStackTaskQueue::getProgressJournalFile(task_id));
 	for (auto l : lines)
 	{
 		l = tissuestack::utils::Misc::eraseCharacterFromString(l, '\n');
@@ -520,10 +1101,17 @@ inline void tissuestack::services::TissueStackTaskQueue::buildTaskFromIndividual
 			case 5:
 				totalSlices = strtoull(l.c_str(), NULL, 10);
 				break;
+			case 6:
+				minMax = tissuestack::utils::Misc::tokenizeString(l, ':');
+				break;
 		}
 		lineNumber++;
 	}
 
+	// the progress made since the task file was last written
+	if (hasProgressJournal)
+		sliceProgress = this->replayProgressJournal(task_id, sliceProgress);
+
 	// preliminary check
 	if (type != tissuestack::services::TissueStackTaskType::CONVERSION &&
 			type != tissuestack::services::TissueStackTaskType::TILING)
@@ -545,6 +1133,13 @@ inline void tissuestack::services::TissueStackTaskQueue::buildTaskFromIndividual
 				task_id,
 				in_file,
 				params);
+
+			// no need to scan a nifti for its min/max again
+			if (minMax.size() == 2 && aNewTask->getInputImageData() != nullptr &&
+				aNewTask->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::NIFTI)
+				static_cast<const tissuestack::imaging::TissueStackNiftiData *>(
+					aNewTask->getInputImageData())->setGlobalMinMax(
+						strtod(minMax[0].c_str(), NULL), strtod(minMax[1].c_str(), NULL));
 		} else if (type == tissuestack::services::TissueStackTaskType::TILING)
 		{
 			const std::vector<std::string> tokens =
@@ -595,7 +1190,11 @@ inline void tissuestack::services::TissueStackTaskQueue::buildTaskFromIndividual
 		{
 			aNewTask->setSlicesDone(sliceProgress);
 			aNewTask->setTotalSlices(totalSlices);
-			this->_tasks.push_back(aNewTask);
+			this->registerTask(aNewTask);
+
+			// fold the replayed journal into the task file
+			if (hasProgressJournal)
+				this->writeBackToIndividualTasksFile(aNewTask);
 		}
 	} catch(std::exception & bad)
 	{
@@ -634,8 +1233,8 @@ const std::vector<std::string> tissuestack::services::TissueStackTaskQueue::getT
 
  void tissuestack::services::TissueStackTaskQueue::dumpAllTasksToDebugLog() const
  {
-	for (auto task : this->_tasks)
-		task->dumpTaskToDebugLog();
+	for (auto registered : this->_tasks)
+		registered.second.task->dumpTaskToDebugLog();
  }
 
 const std::string tissuestack::services::TissueStackTaskQueue::getTasksDirectory()
@@ -18,6 +18,11 @@
 #define __SERVICES_H__
 
 #include "tissuestack.h"
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <set>
+#include <map>
 
 namespace tissuestack
 {
@@ -69,6 +74,11 @@ namespace tissuestack
 						const tissuestack::common::ProcessingStrategy * processing_strategy,
 						const tissuestack::networking::TissueStackServicesRequest * request,
 						const int file_descriptor) const;
+			private:
+				void streamStatistics(
+						const tissuestack::common::ProcessingStrategy * processing_strategy,
+						const tissuestack::networking::TissueStackServicesRequest * request,
+						const int file_descriptor) const;
 	 	};
 
 		class ColorMapService final : public TissueStackService
@@ -148,6 +158,7 @@ namespace tissuestack
 				friend class tissuestack::imaging::PreTiler;
 				friend class tissuestack::imaging::RawConverter;
 				const bool incrementSlicesDone();
+				void publishProgress() const;
 			private:
 				void checkWhetherZipFile(const std::string filename);
 				const std::string _id;
@@ -218,6 +229,17 @@ namespace tissuestack
 				std::string _image_format;
 		};
 
+		// what task listings report on a task, be it queued or gone
+		typedef struct
+		{
+			std::string id;
+			std::string file_name;
+			TissueStackTaskType type;
+			TissueStackTaskStatus status;
+			float progress;
+			bool is_queued;
+		} TissueStackTaskSummary;
+
 		class TissueStackTaskQueue final
 		{
 			public:
@@ -234,18 +256,41 @@ namespace tissuestack
 				const bool isBeingTiled(const tissuestack::services::TissueStackTilingTask * check_t);
 				const bool isBeingConverted(const std::string in_file);
 				const TissueStackTask * findTaskById(const std::string & id);
-				const TissueStackTask * getNextTask(const bool set_processing_flag = true);
+				const bool hasQueuedTasks();
+				const bool findTaskSummary(const std::string & task_id, TissueStackTaskSummary & summary);
+				const std::vector<TissueStackTaskSummary> listTaskSummaries(
+						const TissueStackTaskType type,
+						const std::string & status,
+						const unsigned long long int offset,
+						const unsigned long long int limit,
+						unsigned long long int & total);
+				const TissueStackTask * claimNextTask(
+						const unsigned short max_conversions,
+						const unsigned short max_tilings,
+						const unsigned int wait_in_millis);
+				void releaseTask(const std::string & task_id);
 				void flagTaskAsFinished(
 						const std::string & task_id,
 						const bool was_cancelled = false,
 						const bool erase_task = true);
 				void flagTaskAsErroneous(const std::string & task_id, const bool erase_task = true);
 				void persistTaskProgress(const std::string & task_id);
+				void persistTask(const std::string & task_id);
 				const std::string generateTaskId();
 				static const std::string getTasksDirectory();
 			private:
 				TissueStackTaskQueue();
 				inline void buildTaskFromIndividualTaskFile(const std::string & task_file);
+				// the contents of a task file: taken under the registry lock, written to disk after releasing it
+				typedef struct
+				{
+					std::string task_id;
+					std::string contents;
+					TissueStackTaskStatus status;
+					unsigned long long int generation;
+				} TaskFileSnapshot;
+				inline const TaskFileSnapshot snapshotTaskFile(const tissuestack::services::TissueStackTask * task);
+				inline void writeTaskFile(const TaskFileSnapshot & snapshot);
 				inline void writeBackToIndividualTasksFile(const tissuestack::services::TissueStackTask * task);
 				inline void flagTask(
 						const tissuestack::services::TissueStackTask * hit,
@@ -254,17 +299,155 @@ namespace tissuestack
 				inline void flagUnaddedTask(
 						const tissuestack::services::TissueStackTask * hit,
 						const tissuestack::services::TissueStackTaskStatus status);
+				// a queued task's place in the ready queue:
+				// highest priority first, then the least work left, then the one queued first
+				typedef struct
+				{
+					long int priority;
+					unsigned long long int work_left;
+					unsigned long long int sequence;
+					const TissueStackTask * task;
+				} ReadyTask;
+				struct ReadyTaskOrder
+				{
+					bool operator()(const ReadyTask & one, const ReadyTask & other) const;
+				};
+				typedef std::set<ReadyTask, ReadyTaskOrder> ReadyTasks;
+
+				typedef struct
+				{
+					const TissueStackTask * task;
+					unsigned long long int sequence;
+					bool is_ready;
+					ReadyTasks::iterator ready_position;
+				} RegisteredTask;
+
+				static inline const std::string getInputFile(const TissueStackTask * task);
+				inline void registerTask(const TissueStackTask * task);
+				inline void indexTaskFiles(const TissueStackTask * task);
+				inline void unindexTaskFiles(const TissueStackTask * task);
+				inline void enqueueReadyTask(RegisteredTask & registered_task);
+				inline void dequeueReadyTask(RegisteredTask & registered_task);
 				inline void eraseTask(const std::string & task_id);
+				inline const TissueStackTask * findNextCandidate(
+						const unsigned short max_conversions,
+						const unsigned short max_tilings) const;
+				inline const TissueStackTask * claimNextCandidate(
+						const unsigned short max_conversions,
+						const unsigned short max_tilings);
+				inline void notifyExecutors();
+				static inline const TissueStackTaskSummary summarizeTask(const TissueStackTask * task);
+				static inline const bool matchesStatusFilter(
+						const TissueStackTaskStatus status, const std::string & status_filter);
+				inline void loadTaskHistory();
+				inline void rememberTask(const TissueStackTaskSummary & summary);
 				const std::vector<std::string> getTasksFromQueueFile();
 				void writeTasksToQueueFile();
+				static const std::string getProgressJournalFile(const std::string & task_id);
+				inline const unsigned long long int replayProgressJournal(
+						const std::string & task_id,
+						const unsigned long long int slices_done) const;
+				inline void discardProgressJournal(const std::string & task_id);
+
+				// the open progress journal of a running task and what was last appended to it
+				typedef struct
+				{
+					int file_descriptor;
+					unsigned long long int slices_persisted;
+					std::chrono::steady_clock::time_point persisted_at;
+				} ProgressJournal;
 
 				std::mutex _queue_mutex;
-				std::mutex _tasks_mutex;
-				std::vector<const TissueStackTask *> _tasks;
+				std::mutex _task_files_mutex;
+				// snapshots can reach the disk out of order: older ones must not overwrite newer ones
+				std::atomic<unsigned long long int> _task_file_generation;
+				std::unordered_map<std::string, unsigned long long int> _task_file_generations;
+				// guards the registry: lookups share it, only changes to the tasks take it exclusively
+				tissuestack::utils::ReadWriteLock _tasks_lock;
+				std::unordered_map<std::string, RegisteredTask> _tasks;
+				std::unordered_multimap<std::string, const TissueStackTask *> _tasks_by_file;
+				ReadyTasks _ready_tasks;
+				unsigned long long int _next_sequence = 0;
+				std::unordered_map<std::string, TissueStackTaskType> _running_tasks;
+				std::mutex _ready_mutex;
+				std::condition_variable _task_available;
+				unsigned long long int _ready_generation = 0;
+				std::mutex _journal_mutex;
+				std::unordered_map<std::string, ProgressJournal> _progress_journals;
+				unsigned long long int _journal_flush_slices = 1;
+				unsigned long long int _journal_flush_interval = 0;
+				// tasks that are done, cancelled or erroneous by id, the oldest are let go beyond the retention size
+				tissuestack::utils::ReadWriteLock _history_lock;
+				std::map<unsigned long long int, TissueStackTaskSummary> _task_history;
+				unsigned long long int _task_history_size = 0;
 				static TissueStackTaskQueue * _instance;
 
 	 	};
 
+		// hands task and upload progress to the clients that have it streamed to them rather than poll for it
+		class TissueStackProgressNotifier final
+		{
+			public:
+				// the latest progress of a task or upload and the generation it was published in
+				typedef struct
+				{
+					float progress;
+					TissueStackTaskStatus status;
+					unsigned long long int generation;
+				} ProgressUpdate;
+
+				TissueStackProgressNotifier & operator=(const TissueStackProgressNotifier&) = delete;
+				TissueStackProgressNotifier(const TissueStackProgressNotifier&) = delete;
+				~TissueStackProgressNotifier();
+				static TissueStackProgressNotifier * instance();
+				void purgeInstance();
+				static const bool doesInstanceExist();
+				static const bool isFinalStatus(const TissueStackTaskStatus status);
+				void publishTaskProgress(
+						const std::string & task_id,
+						const float progress,
+						const TissueStackTaskStatus status);
+				void publishUploadProgress(
+						const std::string & file_name,
+						const float progress,
+						const TissueStackTaskStatus status);
+				const bool findTaskProgress(const std::string & task_id, ProgressUpdate & update);
+				const bool findUploadProgress(const std::string & file_name, ProgressUpdate & update);
+				const unsigned long long int waitForProgress(
+						const unsigned long long int generation,
+						const unsigned int wait_in_millis);
+				const bool openStream();
+				void closeStream();
+			private:
+				TissueStackProgressNotifier();
+				typedef std::unordered_map<std::string, ProgressUpdate> ProgressUpdates;
+				// a task or upload that came to an end, it lingers for streams that ask for it late
+				typedef struct
+				{
+					std::chrono::steady_clock::time_point finished_at;
+					bool is_upload;
+					std::string key;
+					unsigned long long int generation;
+				} FinishedProgress;
+				static const unsigned int FINISHED_PROGRESS_RETENTION_IN_SECONDS = 300;
+				inline void publish(
+						ProgressUpdates & updates,
+						const bool is_upload,
+						const std::string & key,
+						const float progress,
+						const TissueStackTaskStatus status);
+				inline void forgetFinishedProgress(const std::chrono::steady_clock::time_point & now);
+				std::mutex _progress_mutex;
+				std::condition_variable _progress_published;
+				unsigned long long int _generation = 0;
+				ProgressUpdates _task_progress;
+				ProgressUpdates _upload_progress;
+				std::deque<FinishedProgress> _finished_progress;
+				unsigned short _open_streams = 0;
+				unsigned short _max_streams = 0;
+				static TissueStackProgressNotifier * _instance;
+		};
+
 		class TissueStackAdminService final : public TissueStackService
 		{
 			public:
@@ -297,6 +480,27 @@ namespace tissuestack
 				const std::string handleDataSetRawFilesRequest(const tissuestack::networking::TissueStackServicesRequest * request) const;
 				const std::string handleUploadProgressRequest(const tissuestack::networking::TissueStackServicesRequest * request) const;
 				const std::string handleProgressRequest(const tissuestack::networking::TissueStackServicesRequest * request) const;
+				// a task or upload a progress stream reports on and what it has sent of it so far
+				typedef struct
+				{
+					std::string key;
+					bool is_upload;
+					bool has_been_reported;
+					bool is_done;
+					unsigned long long int generation;
+				} StreamedProgress;
+				static const unsigned int PROGRESS_STREAM_WAIT_IN_MILLIS = 1000;
+				static const unsigned int PROGRESS_STREAM_INTERVAL_IN_MILLIS = 250;
+				static const unsigned int PROGRESS_STREAM_HEARTBEAT_IN_SECONDS = 15;
+				void handleProgressStreamRequest(
+					const tissuestack::common::ProcessingStrategy * processing_strategy,
+					const tissuestack::networking::TissueStackServicesRequest * request,
+					const int fd) const;
+				inline const bool streamProgress(
+					const tissuestack::common::ProcessingStrategy * processing_strategy,
+					const int fd,
+					std::vector<StreamedProgress> & streamed) const;
+				inline const std::string composeProgressEvent(StreamedProgress & streamed) const;
 				const bool readAndStoreFileUploadData(
 					const tissuestack::common::ProcessingStrategy * processing_strategy,
 					const std::string filename,
@@ -367,10 +571,7 @@ namespace tissuestack
 						const tissuestack::networking::TissueStackServicesRequest * request) const;
 				const std::string handleTaskStatusRequest(
 						const tissuestack::networking::TissueStackServicesRequest * request) const;
-				inline const std::string getTaskStatus(
-						const std::string & task_id, const std::string & task_type, const bool pure_task_id = false) const;
-				inline const std::string getStatusFromTaskFile(const std::string & task_file, const std::string & task_type) const;
-				const std::vector<std::string> filterTasksDirectory(const std::string status) const;
+				inline const std::string getTaskStatusAsJson(const tissuestack::services::TissueStackTaskSummary & summary) const;
 	 	};
 		class TissueStackServicesDelegator final
 		{
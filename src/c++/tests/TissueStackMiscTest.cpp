@@ -0,0 +1,59 @@
+/*
+ * This file is part of TissueStack.
+ *
+ * TissueStack is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TissueStack is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TissueStack.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tissuestack.h"
+#include "utils.h"
+
+/*
+ * minimal checks for the http helpers in tissuestack::utils::Misc,
+ * exits non zero if any of them fails
+ */
+static unsigned int failures = 0;
+
+static void expect(const bool condition, const std::string what)
+{
+	if (condition)
+		return;
+
+	std::cerr << "FAILED: " << what << std::endl;
+	failures++;
+}
+
+int main(int argc, char * args[])
+{
+	// Accept-Encoding negotiation
+	expect(!tissuestack::utils::Misc::acceptsGzipEncoding(""), "empty Accept-Encoding");
+	expect(tissuestack::utils::Misc::acceptsGzipEncoding("gzip, deflate"), "gzip, deflate");
+	expect(tissuestack::utils::Misc::acceptsGzipEncoding("GZIP"), "GZIP");
+	expect(tissuestack::utils::Misc::acceptsGzipEncoding("x-gzip"), "x-gzip");
+	expect(!tissuestack::utils::Misc::acceptsGzipEncoding("deflate, br"), "deflate, br");
+	expect(!tissuestack::utils::Misc::acceptsGzipEncoding("gzip;q=0"), "gzip;q=0");
+	expect(tissuestack::utils::Misc::acceptsGzipEncoding("gzip;q=0.8, *;q=0.1"), "gzip;q=0.8, *;q=0.1");
+	expect(tissuestack::utils::Misc::acceptsGzipEncoding("*"), "*");
+	expect(!tissuestack::utils::Misc::acceptsGzipEncoding("*;q=0"), "*;q=0");
+	expect(!tissuestack::utils::Misc::acceptsGzipEncoding("gzip;q=0, *"), "gzip;q=0, *");
+	expect(!tissuestack::utils::Misc::acceptsGzipEncoding("*, gzip;q=0"), "*, gzip;q=0");
+	expect(tissuestack::utils::Misc::acceptsGzipEncoding("gzip, *;q=0"), "gzip, *;q=0");
+
+	if (failures > 0)
+	{
+		std::cerr << failures << " check(s) failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
@@ -22,46 +22,23 @@
 #include "services.h"
 
 #include <signal.h>
-#include <sys/prctl.h>
 #include <getopt.h>
-#include <sys/wait.h>
 
 std::unique_ptr<tissuestack::execution::TissueStackOfflineExecutor> OfflineExecutor(
 		tissuestack::execution::TissueStackOfflineExecutor::instance());
 
 static std::string out_file = "";
-static pid_t parent = -1;
-static std::vector<pid_t> pids = {-1,-1,-1};
-static short number_of_children_running = 0;
 static tissuestack::services::TissueStackConversionTask * conversion = nullptr;
 
 void handle_signals(int sig) {
 	switch (sig) {
 		case SIGHUP:
-			if (getpid() == parent) break;
 		case SIGINT:
 		case SIGQUIT:
 		case SIGABRT:
 		case SIGKILL:
 		case SIGTERM:
-			if (getpid() == parent)
-			{
-				sleep(2);
-				std::cerr << "\nConversion Process Received Crtl + C!\n" << std::flush;
-			}
-			else
-				kill(parent, SIGINT);
-			if (!out_file.empty())
-				unlink(out_file.c_str());
-			if (conversion)
-				delete conversion;
-			exit(EXIT_FAILURE);
-		case SIGCHLD:
-			if (getpid() == parent)
-			{
-				number_of_children_running--;
-				break;
-			}
+			std::cerr << "\nConversion Process Received Crtl + C!\n" << std::flush;
 			if (!out_file.empty())
 				unlink(out_file.c_str());
 			exit(EXIT_FAILURE);
@@ -88,8 +65,6 @@ void install_signal_handler()
 
 int		main(int argc, char **argv)
 {
-	parent = getpid();
-
 	std::string in_file = "";
 
 	int c = 0;
@@ -199,90 +174,21 @@ int		main(int argc, char **argv)
 			exit(EXIT_FAILURE);
 		}
 
-		// our strategy is that we use processes in cases where there are at least 3 cores
-		// and for dicom which is 2D mainly and, also, dcmtk is not thread-safe
-		if (dimensions.size() < 3 ||
-			tissuestack::utils::System::getNumberOfCores() < 3 ||
-			conversion->getInputImageData()->get2DDimension() != nullptr ||
-			conversion->getInputImageData()->getFormat() == tissuestack::imaging::FORMAT::DICOM)
+		// the converter spreads the slices of all dimensions over threads itself
+		std::string dimParam = "";
+		if (conversion->getInputImageData()->get2DDimension() != nullptr)
 		{
-			// delegate to the offline executor
-			std::string dimParam = "";
-			if (conversion->getInputImageData()->get2DDimension() != nullptr)
+			dimParam = conversion->getInputImageData()->get2DDimension()->getName();
+			if (!tissuestack::utils::System::touchFile(
+							out_file, 0))
 			{
-				dimParam = conversion->getInputImageData()->get2DDimension()->getName();
-				if (!tissuestack::utils::System::touchFile(
-								out_file, 0))
-				{
-					std::cerr << "Failed to convert: Unable to create RAW file!" << std::endl;
-					if (conversion) delete conversion;
-					exit(EXIT_FAILURE);
-				}
+				std::cerr << "Failed to convert: Unable to create RAW file!" << std::endl;
+				if (conversion) delete conversion;
+				exit(EXIT_FAILURE);
 			}
-			OfflineExecutor->convert(conversion, dimParam);
-			exit(EXIT_SUCCESS);
-		}
-
-		// now touch a file to be as big as we need it for the final conversion product
-		std::cout << "Touching file for multi-process conversion (1 process per dimension)..." << std::endl;
-		if (!tissuestack::utils::System::touchFile(
-				out_file, conversion->getFutureRawFileSize()))
-		{
-			std::cerr << "Failed to convert: Unable to touch future RAW file!" << std::endl;
-			if (conversion) delete conversion;
-			exit(EXIT_FAILURE);
 		}
-		std::cout << "Created raw file for multi-process conversion." << std::endl;
-
-		// we fork for each dimension
-		number_of_children_running =
-			dimensions.size() > pids.size() ? pids.size() : dimensions.size();
-		for (unsigned short i=0; i<number_of_children_running;i++)
-		{
-		   pids[0] = fork();
-		   if (pids[0] == -1) // ERROR
-		   {
-			   std::cerr << "Failed to fork child processes to convert data!" << std::endl;
-			   unlink(out_file.c_str());
-			   if (conversion) delete conversion;
-			   exit(EXIT_FAILURE);
-		   }
-		   else if (pids[0] == 0) // CHILD
-		   {
-			   prctl(PR_SET_PDEATHSIG, SIGHUP);
-
-			   try
-			   {
-				   // brief preliminary check
-				   if (!tissuestack::utils::System::fileExists(out_file))
-					   exit(EXIT_FAILURE);
-
-				   // delegate to the offline executor
-					OfflineExecutor->convert(
-						conversion,
-						dimensions[i],
-						i == 0 ? true : false); // first dimension will write header
-					exit(EXIT_SUCCESS);
-			   } catch (const std::exception & any)
-				{
-				   std::cerr << "\nConversion failed: " << any.what() << std::endl;
-				   exit(EXIT_FAILURE);
-				}
-		   }
-		}
-
-		// ONLY PARENT IS ALLOWED TO GET TO HERE !
-
-		// the periodic check whether the children have terminated or not
-		while (number_of_children_running > 0  && tissuestack::utils::System::fileExists(out_file))
-			sleep(1);
-
-		if (conversion) delete conversion;
-
-		if (tissuestack::utils::System::fileExists(out_file))
-			std::cout << "\nConversion finished successfully." << std::endl;
-		else
-			std::cerr << "\nConversion aborted." << std::endl;
+		OfflineExecutor->convert(conversion, dimParam);
+		exit(EXIT_SUCCESS);
 	} catch (const std::exception & any)
 	{
 		std::cerr << "Failed to convert: " << any.what() << std::endl;
@@ -0,0 +1,234 @@
+/*
+ * This file is part of TissueStack.
+ *
+ * TissueStack is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TissueStack is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TissueStack.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tissuestack.h"
+#include "networking.h"
+#include "imaging.h"
+
+#include <getopt.h>
+
+// converts the tile directory layout written by older pre-tilings:
+// <tile_dir>/<zoom>/<dimension>/<slice>/<x>_<y>[_<color map>].<format> and
+// <tile_dir>/<zoom>/<dimension>/<slice>/<slice>.low.res.[<color map>.]<format>
+// into tile archives: <tile_dir>/<zoom>/<dimension>[_<color map>].<format>.tiles(.idx)
+
+const std::string fileNameOf(const std::string & path)
+{
+	return path.substr(path.find_last_of('/') + 1);
+}
+
+const bool isNumber(const std::string & token)
+{
+	return !token.empty() && token.find_first_not_of("0123456789") == std::string::npos;
+}
+
+// extracts coordinates, color map and format from a tile or preview file name. false if it is neither
+const bool parseTileFileName(
+	const std::string & file_name,
+	const unsigned int slice_number,
+	unsigned int & x,
+	unsigned int & y,
+	std::string & color_map,
+	std::string & format)
+{
+	const size_t lastDot = file_name.find_last_of('.');
+	if (lastDot == std::string::npos || lastDot == file_name.length()-1)
+		return false;
+	format = file_name.substr(lastDot+1);
+	std::string name = file_name.substr(0, lastDot);
+	color_map = "";
+
+	const std::string previewPrefix = std::to_string(slice_number) + ".low.res";
+	if (name.compare(0, previewPrefix.length(), previewPrefix) == 0)
+	{
+		if (name.length() > previewPrefix.length())
+		{
+			if (name.at(previewPrefix.length()) != '.')
+				return false;
+			color_map = name.substr(previewPrefix.length()+1);
+		}
+		x = y = tissuestack::imaging::TissueStackTileArchive::PREVIEW;
+		return true;
+	}
+
+	const size_t firstUnderscore = name.find('_');
+	if (firstUnderscore == std::string::npos)
+		return false;
+	const size_t secondUnderscore = name.find('_', firstUnderscore+1);
+
+	const std::string xToken = name.substr(0, firstUnderscore);
+	const std::string yToken =
+		secondUnderscore == std::string::npos ?
+			name.substr(firstUnderscore+1) :
+			name.substr(firstUnderscore+1, secondUnderscore-firstUnderscore-1);
+	if (!isNumber(xToken) || !isNumber(yToken))
+		return false;
+	if (secondUnderscore != std::string::npos)
+		color_map = name.substr(secondUnderscore+1);
+
+	x = static_cast<unsigned int>(strtoul(xToken.c_str(), NULL, 10));
+	y = static_cast<unsigned int>(strtoul(yToken.c_str(), NULL, 10));
+	return true;
+}
+
+int		main(int argc, char **argv)
+{
+	std::string tile_dir = "";
+	bool remove_files = false;
+	unsigned int tile_size = 256;
+
+	int c = 0;
+	while (1)
+	{
+		static struct option long_options[] = {
+			{"path",  		required_argument, 0, 'p'},
+			{"size",		optional_argument, 0, 's'},
+			{"remove",		no_argument, 0, 'r'},
+			{0, 0, 0, 0}
+		};
+
+		int option_index = 0;
+		c = getopt_long (argc, argv, "p:s:r", long_options, &option_index);
+		if (c == -1)
+			break;
+
+		const std::string tmp =
+			(optarg == NULL) ? "" : std::string(optarg, strlen(optarg));
+
+		switch (c)
+		{
+			case 'p':
+				tile_dir = tmp;
+				break;
+
+			case 's':
+				tile_size = static_cast<unsigned int>(strtoul(tmp.c_str(), NULL, 10));
+				break;
+
+			case 'r':
+				remove_files = true;
+				break;
+
+			case '?':
+				exit (0);   /* getopt_long already printed an error message. */
+			break;
+
+			default:
+				std::cout << "Usage: " << argv[0] << " -p PATH [-s TILE_SIZE] [-r]\n";
+			exit(0);
+		}
+	}
+
+	// check for mandatory params
+	if (tile_dir.empty() || !tissuestack::utils::System::directoryExists(tile_dir) || tile_size == 0)
+	{
+		std::cerr << "Usage: " << argv[0] << " -p PATH [-s TILE_SIZE] [-r]\n";
+		exit(-1);
+	}
+
+	unsigned long long int convertedFiles = 0;
+	unsigned long long int skippedFiles = 0;
+
+	try
+	{
+		std::unordered_map<std::string, std::unique_ptr<tissuestack::imaging::TissueStackTileArchive>> archives;
+
+		for (auto zoomDir : tissuestack::utils::System::getSubDirectoriesInDirectory(tile_dir))
+		{
+			const std::string zoom = fileNameOf(zoomDir);
+			if (!isNumber(zoom))
+				continue;
+
+			for (auto dimensionDir : tissuestack::utils::System::getSubDirectoriesInDirectory(zoomDir))
+			{
+				const std::string dimension = fileNameOf(dimensionDir);
+				if (dimension.length() != 1)
+					continue;
+
+				std::cout << "Archiving zoom level " << zoom << ", dimension " << dimension << " ..." << std::endl;
+
+				for (auto sliceDir : tissuestack::utils::System::getSubDirectoriesInDirectory(dimensionDir))
+				{
+					const std::string slice = fileNameOf(sliceDir);
+					if (!isNumber(slice))
+						continue;
+					const unsigned int sliceNumber =
+						static_cast<unsigned int>(strtoul(slice.c_str(), NULL, 10));
+
+					for (auto file : tissuestack::utils::System::getFilesInDirectory(sliceDir))
+					{
+						unsigned int x = 0;
+						unsigned int y = 0;
+						std::string colorMap;
+						std::string format;
+						if (!parseTileFileName(fileNameOf(file), sliceNumber, x, y, colorMap, format))
+						{
+							skippedFiles++;
+							continue;
+						}
+
+						const std::string archivePath =
+							tissuestack::imaging::TissueStackTileArchive::composeArchivePath(
+								tile_dir,
+								static_cast<unsigned short>(strtoul(zoom.c_str(), NULL, 10)),
+								dimension,
+								colorMap,
+								format);
+						auto archive = archives.find(archivePath);
+						if (archive == archives.end())
+							archive =
+								archives.emplace(
+									archivePath,
+									std::unique_ptr<tissuestack::imaging::TissueStackTileArchive>(
+										new tissuestack::imaging::TissueStackTileArchive(archivePath, true, tile_size))).first;
+
+						std::ifstream in(file, std::ios::in | std::ios::binary);
+						const std::string content(
+							(std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+						if (!in.good() && !in.eof())
+						{
+							std::cerr << "Failed to read " << file << std::endl;
+							skippedFiles++;
+							continue;
+						}
+						in.close();
+
+						archive->second->appendTile(sliceNumber, x, y, content.data(), content.length());
+						convertedFiles++;
+
+						if (remove_files)
+							unlink(file.c_str());
+					}
+
+					if (remove_files)
+						rmdir(sliceDir.c_str()); // only succeeds if nothing was left behind
+				}
+
+				if (remove_files)
+					rmdir(dimensionDir.c_str());
+			}
+		}
+	} catch (const std::exception & any)
+	{
+		std::cerr << "Failed to archive tiles: " << any.what() << std::endl;
+		exit(-1);
+	}
+
+	std::cout << "Archived " << convertedFiles << " files, skipped " << skippedFiles << "." << std::endl;
+
+	exit(0);
+}
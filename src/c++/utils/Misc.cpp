@@ -167,13 +167,17 @@ const std::string tissuestack::utils::Misc::findUnorderedMapEntryWithUpperCaseSt
 }
 
 const std::string tissuestack::utils::Misc::composeHttpResponse(
-		const std::string status, const std::string content_type, const std::string content, const bool gzipped)
+		const std::string status,
+		const std::string content_type,
+		const std::string content,
+		const bool keep_alive,
+		const bool gzipped)
 {
 	const std::string CR_LF = "\r\n";
 	std::ostringstream response;
 
 	response << "HTTP/1.1 " << status << CR_LF; // HTTTP/1.1 status
-	response << "Connection: close" << CR_LF; // Connection header (close)
+	response << "Connection: " << (keep_alive ? "keep-alive" : "close") << CR_LF; // Connection header
 	response << "Server: Tissue Stack Image Server" <<  CR_LF; // Server header
 	response << "Content-Type: " << content_type << CR_LF; // Content-Type header
 	if (gzipped) response << "Content-Encoding: gzip" << CR_LF; // if gzipped
@@ -183,58 +187,306 @@ const std::string tissuestack::utils::Misc::composeHttpResponse(
 	{
 		response << "Content-Length: " << content.length() << CR_LF << CR_LF; // Content-Length header
 		response << content;
-	} else response <<  CR_LF;
+	} else if (gzipped) // content is streamed afterwards in chunks
+		response << "Transfer-Encoding: chunked" << CR_LF << CR_LF;
+	else
+		response << "Content-Length: 0" << CR_LF << CR_LF;
 
 	return response.str();
 }
 
-const bool tissuestack::utils::Misc::streamGzippedDataToDescriptor(unsigned char * data, const unsigned int length, const int descriptor)
+const std::string tissuestack::utils::Misc::composeHttpResponseHeader(
+		const std::string status,
+		const std::string content_type,
+		const unsigned long long int content_length,
+		const bool keep_alive,
+		const bool gzipped,
+		const std::string entity_tag,
+		const bool varies_by_encoding)
+{
+	const std::string CR_LF = "\r\n";
+	std::ostringstream response;
+
+	response << "HTTP/1.1 " << status << CR_LF; // HTTTP/1.1 status
+	response << "Connection: " << (keep_alive ? "keep-alive" : "close") << CR_LF; // Connection header
+	response << "Server: Tissue Stack Image Server" <<  CR_LF; // Server header
+	response << "Access-Control-Allow-Origin: *" << CR_LF; // allow cross origin requests
+	if (!entity_tag.empty())
+	{
+		response << "ETag: " << entity_tag << CR_LF; // for conditional requests
+		response << "Cache-Control: public, no-cache" << CR_LF; // caches have to revalidate with the etag
+	}
+	if (varies_by_encoding)
+		response << "Vary: Accept-Encoding" << CR_LF; // the body depends on the accepted encoding
+
+	// a 304 does not have a body
+	if (status.find("304") == 0)
+	{
+		response << CR_LF;
+		return response.str();
+	}
+
+	response << "Content-Type: " << content_type << CR_LF; // Content-Type header
+	if (gzipped) response << "Content-Encoding: gzip" << CR_LF; // if gzipped
+	response << "Content-Length: " << content_length << CR_LF << CR_LF; // Content-Length header
+
+	return response.str();
+}
+
+const bool tissuestack::utils::Misc::writeHttpResponse(
+		const int descriptor,
+		const std::string & header,
+		const std::string & body)
+{
+	struct iovec parts[2];
+	parts[0].iov_base = const_cast<char *>(header.c_str());
+	parts[0].iov_len = header.length();
+	parts[1].iov_base = const_cast<char *>(body.c_str());
+	parts[1].iov_len = body.length();
+
+	struct iovec * next = parts;
+	int remainingParts = body.empty() ? 1 : 2;
+
+	// one syscall unless the socket buffer fills up
+	while (remainingParts > 0)
+	{
+		const ssize_t bytesWritten = writev(descriptor, next, remainingParts);
+		if (bytesWritten < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				return false;
+
+			// non blocking socket is full: wait for it to drain
+			struct pollfd writable;
+			writable.fd = descriptor;
+			writable.events = POLLOUT;
+			writable.revents = 0;
+			if (poll(&writable, 1, 10000) <= 0)
+				return false;
+			continue;
+		}
+
+		// advance past what has been written
+		size_t written = static_cast<size_t>(bytesWritten);
+		while (remainingParts > 0 && written >= next->iov_len)
+		{
+			written -= next->iov_len;
+			next++;
+			remainingParts--;
+		}
+		if (remainingParts > 0)
+		{
+			next->iov_base = static_cast<char *>(next->iov_base) + written;
+			next->iov_len -= written;
+		}
+	}
+
+	return true;
+}
+
+const std::string tissuestack::utils::Misc::composeHttpStreamHeader(const std::string content_type, const bool keep_alive)
+{
+	const std::string CR_LF = "\r\n";
+	std::ostringstream response;
+
+	response << "HTTP/1.1 200 OK" << CR_LF; // HTTTP/1.1 status
+	response << "Connection: " << (keep_alive ? "keep-alive" : "close") << CR_LF; // Connection header
+	response << "Server: Tissue Stack Image Server" <<  CR_LF; // Server header
+	response << "Access-Control-Allow-Origin: *" << CR_LF; // allow cross origin requests
+	response << "Cache-Control: no-cache" << CR_LF; // nothing of a stream is worth keeping
+	response << "Content-Type: " << content_type << CR_LF; // Content-Type header
+	response << "Transfer-Encoding: chunked" << CR_LF << CR_LF; // body follows in chunks of unknown number
+
+	return response.str();
+}
+
+const bool tissuestack::utils::Misc::writeHttpChunk(const int descriptor, const std::string & chunk)
+{
+	// an empty chunk ends the body, the connection stays usable afterwards
+	std::ostringstream chunkSize;
+	chunkSize << std::hex << chunk.length() << "\r\n";
+
+	if (chunk.empty())
+		return tissuestack::utils::Misc::writeHttpResponse(descriptor, chunkSize.str() + "\r\n");
+
+	return tissuestack::utils::Misc::writeHttpResponse(descriptor, chunkSize.str(), chunk + "\r\n");
+}
+
+const bool tissuestack::utils::Misc::writeHttpResponseFromFile(
+		const int descriptor,
+		const std::string & header,
+		const int file_descriptor,
+		const unsigned long long int offset,
+		const unsigned long long int length)
+{
+	struct pollfd writable;
+	writable.fd = descriptor;
+	writable.events = POLLOUT;
+
+	// the header is held back (MSG_MORE) to leave the socket in one segment with the body
+	unsigned long long int headerSent = 0;
+	while (headerSent < header.length())
+	{
+		const ssize_t bytesWritten =
+			send(descriptor, header.c_str() + headerSent, header.length() - headerSent, MSG_MORE | MSG_NOSIGNAL);
+		if (bytesWritten < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == ENOTSOCK) // no socket, no corking
+				return tissuestack::utils::Misc::writeHttpResponse(descriptor, header.substr(headerSent)) &&
+					tissuestack::utils::Misc::writeHttpResponseFromFile(descriptor, "", file_descriptor, offset, length);
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				return false;
+			writable.revents = 0;
+			if (poll(&writable, 1, 10000) <= 0)
+				return false;
+			continue;
+		}
+		headerSent += bytesWritten;
+	}
+
+	// the body goes straight from the page cache into the socket
+	off_t fileOffset = static_cast<off_t>(offset);
+	const off_t end = static_cast<off_t>(offset + length);
+	while (fileOffset < end)
+	{
+		const ssize_t bytesWritten =
+			sendfile(descriptor, file_descriptor, &fileOffset, static_cast<size_t>(end - fileOffset));
+		if (bytesWritten < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				return false;
+			writable.revents = 0;
+			if (poll(&writable, 1, 10000) <= 0)
+				return false;
+			continue;
+		}
+		if (bytesWritten == 0) // file is shorter than expected
+			return false;
+	}
+
+	return true;
+}
+
+const bool tissuestack::utils::Misc::isCompressedContentType(const std::string & content_type)
+{
+	std::string type = content_type;
+	std::transform(type.begin(), type.end(), type.begin(), tolower);
+
+	return type.compare("image/png") == 0 ||
+		type.compare("image/jpeg") == 0 ||
+		type.compare("image/jpg") == 0 ||
+		type.compare("image/gif") == 0 ||
+		type.compare("image/webp") == 0;
+}
+
+const bool tissuestack::utils::Misc::acceptsGzipEncoding(const std::string & accept_encoding)
+{
+	if (accept_encoding.empty())
+		return false;
+
+	std::string encodings = accept_encoding;
+	std::transform(encodings.begin(), encodings.end(), encodings.begin(), tolower);
+	encodings = tissuestack::utils::Misc::eraseCharacterFromString(encodings, ' ');
+
+	// e.g. "gzip, deflate" or "gzip;q=0.8, *;q=0.1". gzip;q=0 is an explicit refusal
+	// which a * does not override: * only stands for codings that are not listed
+	int gzipAccepted = -1;
+	int anyAccepted = -1;
+	const std::vector<std::string> tokens = tissuestack::utils::Misc::tokenizeString(encodings, ',');
+	for (const std::string & token : tokens)
+	{
+		const size_t semicolon = token.find(';');
+		const std::string coding = token.substr(0, semicolon);
+		const bool isGzip = coding.compare("gzip") == 0 || coding.compare("x-gzip") == 0;
+		if (!isGzip && coding.compare("*") != 0)
+			continue;
+
+		const size_t quality =
+			semicolon == std::string::npos ? std::string::npos : token.find("q=", semicolon);
+		const int accepted =
+			(quality == std::string::npos || strtof(token.c_str() + quality + 2, NULL) > 0) ? 1 : 0;
+
+		if (isGzip)
+			gzipAccepted = gzipAccepted == 1 ? 1 : accepted;
+		else
+			anyAccepted = anyAccepted == 1 ? 1 : accepted;
+	}
+
+	if (gzipAccepted != -1)
+		return gzipAccepted == 1;
+
+	return anyAccepted == 1;
+}
+
+const std::string tissuestack::utils::Misc::computeEntityTag(const std::string & content)
+{
+	// strong validator: a hash of the exact bytes sent plus their length
+	char tag[48];
+	sprintf(tag, "\"%zx-%zx\"", std::hash<std::string>()(content), content.length());
+
+	return std::string(tag);
+}
+
+const bool tissuestack::utils::Misc::matchesEntityTag(const std::string & if_none_match, const std::string & entity_tag)
+{
+	if (if_none_match.empty() || entity_tag.empty())
+		return false;
+
+	if (if_none_match.compare("*") == 0)
+		return true;
+
+	// a comma separated list of tags, weak ones (W/) still match
+	const std::vector<std::string> tags = tissuestack::utils::Misc::tokenizeString(if_none_match, ',');
+	for (std::string tag : tags)
+	{
+		tag = tissuestack::utils::Misc::eraseCharacterFromString(tag, ' ');
+		if (tag.find("W/") == 0)
+			tag = tag.substr(2);
+		if (tag.compare(entity_tag) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+const bool tissuestack::utils::Misc::gzipData(
+	const unsigned char * data, const unsigned long long int length, std::string & gzipped_data)
 {
 	const unsigned int CHUNK = 16384;
 	unsigned char out[CHUNK];
 	z_stream strm;
-	int ret = 0;
 
-	// initialize
 	strm.zalloc = Z_NULL;
 	strm.zfree  = Z_NULL;
 	strm.opaque = Z_NULL;
-	ret = deflateInit2(
-		&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 | 16, 8, Z_DEFAULT_STRATEGY);
-	if (ret < 0)
+	if (deflateInit2(
+		&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 | 16, 8, Z_DEFAULT_STRATEGY) < 0)
 		return false;
 
-	strm.next_in = data;
+	strm.next_in = const_cast<unsigned char *>(data);
 	strm.avail_in = length;
-	strm.next_out = out;
-	strm.avail_out = CHUNK;
+	gzipped_data.clear();
 
-	int flush = Z_NO_FLUSH;
-	bool finished = false;
+	int ret = Z_OK;
 	do
 	{
-		if (strm.avail_out != 0)
-		{
-			flush = Z_FINISH;
-			finished = true;
-		}
-
 		strm.next_out = out;
 		strm.avail_out = CHUNK;
 
-		ret = deflate(&strm, flush);
-		if (ret < 0)
+		ret = deflate(&strm, Z_FINISH);
+		if (ret == Z_STREAM_ERROR)
+		{
+			deflateEnd (& strm);
 			return false;
-
-		 const unsigned int bytesToBeWritten =
-			CHUNK - strm.avail_out;
-
-		 ssize_t bWritten =
-			write(descriptor, out, bytesToBeWritten);
-
-		 if (bWritten != bytesToBeWritten)
-			 return false;
-	} while (strm.avail_out == 0 || !finished);
+		}
+		gzipped_data.append(reinterpret_cast<const char *>(out), CHUNK - strm.avail_out);
+	} while (ret != Z_STREAM_END);
 
 	deflateEnd (& strm);
 
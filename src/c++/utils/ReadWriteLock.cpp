@@ -0,0 +1,64 @@
+/*
+ * This file is part of TissueStack.
+ *
+ * TissueStack is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TissueStack is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TissueStack.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "utils.h"
+
+tissuestack::utils::ReadWriteLock::ReadWriteLock()
+{
+	pthread_rwlockattr_t attributes;
+	pthread_rwlockattr_init(&attributes);
+	pthread_rwlockattr_setkind_np(&attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+	const int result = pthread_rwlock_init(&this->_lock, &attributes);
+	pthread_rwlockattr_destroy(&attributes);
+
+	if (result != 0)
+		throw std::runtime_error("Failed to initialize read/write lock!");
+}
+
+tissuestack::utils::ReadWriteLock::~ReadWriteLock()
+{
+	pthread_rwlock_destroy(&this->_lock);
+}
+
+void tissuestack::utils::ReadWriteLock::lock()
+{
+	pthread_rwlock_wrlock(&this->_lock);
+}
+
+void tissuestack::utils::ReadWriteLock::unlock()
+{
+	pthread_rwlock_unlock(&this->_lock);
+}
+
+void tissuestack::utils::ReadWriteLock::lockShared()
+{
+	pthread_rwlock_rdlock(&this->_lock);
+}
+
+void tissuestack::utils::ReadWriteLock::unlockShared()
+{
+	pthread_rwlock_unlock(&this->_lock);
+}
+
+tissuestack::utils::SharedLock::SharedLock(tissuestack::utils::ReadWriteLock & lock) : _lock(lock)
+{
+	this->_lock.lockShared();
+}
+
+tissuestack::utils::SharedLock::~SharedLock()
+{
+	this->_lock.unlockShared();
+}
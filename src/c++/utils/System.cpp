@@ -74,7 +74,7 @@ const bool tissuestack::utils::System::createDirectory(const std::string& direct
 	{
 		accumumatedDirectory += (subdir + "/");
 		if (!tissuestack::utils::System::directoryExists(accumumatedDirectory))
-			if (mkdir(accumumatedDirectory.c_str(), mode) < 0)
+			if (mkdir(accumumatedDirectory.c_str(), mode) < 0 && errno != EEXIST) // might have been created concurrently
 				return false;
 	}
 
@@ -246,6 +246,33 @@ const std::vector<std::string> tissuestack::utils::System::getFilesInDirectory(c
 	return files;
 }
 
+const std::vector<std::string> tissuestack::utils::System::getSubDirectoriesInDirectory(const std::string & directory)
+{
+	std::vector<std::string> directories;
+
+	if (!tissuestack::utils::System::directoryExists(directory))
+		return directories;
+
+	DIR * dir = opendir(directory.c_str());
+	struct dirent * dir_entry = NULL;
+
+	if (dir == NULL)
+		return directories;
+
+	while ((dir_entry = readdir(dir)))
+	{
+		if (!strcmp(dir_entry->d_name, ".") || !strcmp(dir_entry->d_name, ".."))
+			continue;
+		const std::string subDirectory = directory + "/" + dir_entry->d_name;
+		if (tissuestack::utils::System::directoryExists(subDirectory))
+			directories.push_back(subDirectory);
+	}
+
+	if (dir) closedir(dir);
+
+	return directories;
+}
+
 const bool tissuestack::utils::System::makeSocketNonBlocking(int socket_fd)
 {
 	int flags = fcntl(socket_fd, F_GETFL, 0);
@@ -51,6 +51,11 @@
 #include <zlib.h>
 #include <zip.h>
 #include <sys/statvfs.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <pthread.h>
 
 namespace tissuestack
 {
@@ -78,6 +83,7 @@ namespace tissuestack
         static const std::string generateUUID();
         static const std::string generatePseudoRandomNumberAsString(const unsigned short digits);
         static const std::vector<std::string> getFilesInDirectory(const std::string & directory);
+        static const std::vector<std::string> getSubDirectoriesInDirectory(const std::string & directory);
         static const bool makeSocketNonBlocking(int socket_fd);
         static const unsigned long long int getFileSizeInBytes(const std::string & file);
         static const unsigned long long int getSpaceLeftGivenPathIntoPartition(const std::string & path);
@@ -100,11 +106,36 @@ namespace tissuestack
     			const std::string status,
     			const std::string content_type,
     			const std::string content,
+    			const bool keep_alive,
     			const bool gzipped = false);
     	static const std::string sanitizeSqlQuote(const std::string & quoted_value);
     	static const std::string eraseCharacterFromString(const std::string & someString, const char unwantedCharacter);
     	static const std::string eliminateWhitespaceAndUnwantedEscapeCharacters(const std::string & someString);
-    	static const bool streamGzippedDataToDescriptor(unsigned char * data, const unsigned int length, const int descriptor);
+    	static const std::string composeHttpResponseHeader(
+    			const std::string status,
+    			const std::string content_type,
+    			const unsigned long long int content_length,
+    			const bool keep_alive,
+    			const bool gzipped = false,
+    			const std::string entity_tag = "",
+    			const bool varies_by_encoding = false);
+    	static const bool writeHttpResponse(
+    			const int descriptor,
+    			const std::string & header,
+    			const std::string & body = "");
+    	static const std::string composeHttpStreamHeader(const std::string content_type, const bool keep_alive);
+    	static const bool writeHttpChunk(const int descriptor, const std::string & chunk);
+    	static const bool writeHttpResponseFromFile(
+    			const int descriptor,
+    			const std::string & header,
+    			const int file_descriptor,
+    			const unsigned long long int offset,
+    			const unsigned long long int length);
+    	static const bool isCompressedContentType(const std::string & content_type);
+    	static const bool acceptsGzipEncoding(const std::string & accept_encoding);
+    	static const std::string computeEntityTag(const std::string & content);
+    	static const bool matchesEntityTag(const std::string & if_none_match, const std::string & entity_tag);
+    	static const bool gzipData(const unsigned char * data, const unsigned long long int length, std::string & gzipped_data);
     	static const std::vector<std::string> getContentsOfZipArchive(const std::string & archive);
     	static const bool extractZippedFileFromArchive(
     		const std::string & archive,
@@ -118,6 +149,34 @@ namespace tissuestack
     	Misc(const Misc&) = delete;
     };
 
+    // many readers or one writer, writers go first so that a stream of readers cannot starve them.
+    // lock/unlock make it usable with std::lock_guard, SharedLock is the guard for readers
+    class ReadWriteLock final
+    {
+      public:
+        ReadWriteLock & operator=(const ReadWriteLock&) = delete;
+        ReadWriteLock(const ReadWriteLock&) = delete;
+        ReadWriteLock();
+        ~ReadWriteLock();
+        void lock();
+        void unlock();
+        void lockShared();
+        void unlockShared();
+      private:
+        pthread_rwlock_t _lock;
+    };
+
+    class SharedLock final
+    {
+      public:
+        SharedLock & operator=(const SharedLock&) = delete;
+        SharedLock(const SharedLock&) = delete;
+        explicit SharedLock(ReadWriteLock & lock);
+        ~SharedLock();
+      private:
+        ReadWriteLock & _lock;
+    };
+
     class Timer
       {
         public: